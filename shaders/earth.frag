@@ -6,8 +6,13 @@ out vec4 FragColor;
 
 uniform sampler2D uEarthTex;
 uniform bool uHasTex;
-uniform vec3 uSunDir;    
-uniform vec3 uCamPos;
+layout(std140) uniform FrameUniforms {
+    mat4  uView;
+    mat4  uProj;
+    vec3  uSunDir;
+    float uTime;
+    vec3  uCamPos;
+};
 
 void main(){
     vec3 N = normalize(vN);
@@ -1,9 +1,15 @@
 #version 330 core
 layout(location=0) in vec3 aPos;
 
-uniform mat4 uView;
-uniform mat4 uProj;
+uniform mat4 uModel;
+layout(std140) uniform FrameUniforms {
+    mat4  uView;
+    mat4  uProj;
+    vec3  uSunDir;
+    float uTime;
+    vec3  uCamPos;
+};
 
 void main(){
-    gl_Position = uProj * uView * vec4(aPos, 1.0);
+    gl_Position = uProj * uView * uModel * vec4(aPos, 1.0);
 }
@@ -0,0 +1,30 @@
+#version 330 core
+layout(location=0) in vec2 aCosSin;  // shared strip: cos E, sin E
+layout(location=1) in vec4 iU;       // xyz = a * P, w = raan rate (rad/s)
+layout(location=2) in vec4 iV;       // xyz = b * Q
+layout(location=3) in vec4 iC;       // xyz = ellipse centre
+layout(location=4) in vec4 iColor;
+
+layout(std140) uniform FrameUniforms {
+    mat4  uView;
+    mat4  uProj;
+    vec3  uSunDir;
+    float uTime;
+    vec3  uCamPos;
+};
+
+uniform float uDt;  // sim seconds since the batch was fit
+
+out vec4 vColor;
+
+void main(){
+    vec3 p = iC.xyz + aCosSin.x * iU.xyz + aCosSin.y * iV.xyz;
+
+    // secular nodal regression about the ECI pole (z)
+    float r = iU.w * uDt;
+    float c = cos(r), s = sin(r);
+    p = vec3(c * p.x - s * p.y, s * p.x + c * p.y, p.z);
+
+    vColor = iColor;
+    gl_Position = uProj * uView * vec4(p, 1.0);
+}
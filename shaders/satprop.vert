@@ -0,0 +1,61 @@
+#version 330 core
+// Secular-J2 Keplerian propagation (src/MeanElements.cpp is the CPU reference).
+// Captured by transform feedback straight into the sats.vert input layout.
+layout(location=0) in vec4 aEl0; // a (km), e, i, M0
+layout(location=1) in vec4 aEl1; // raan0, argp0, Mdot, raanDot
+layout(location=2) in vec4 aEl2; // argpDot, epoch, valid, -
+
+uniform float uTime;        // sim seconds since the element set base
+uniform float uScale;       // render units per km
+uniform vec3  uSunDir;
+uniform float uEarthRadius;
+
+out vec3  vPos;
+out float vBright;
+
+const float TWO_PI = 6.28318530718;
+
+float shadowBrightness(vec3 p){
+    float dp = dot(p, uSunDir);
+    if(dp > 0.0) return 1.0;
+
+    float d = sqrt(max(dot(p, p) - dp * dp, 0.0));
+    float shadowMin = 0.25;
+    if(d < uEarthRadius) return shadowMin;
+
+    float t = clamp((d - uEarthRadius) / (uEarthRadius * 0.10), 0.0, 1.0);
+    return shadowMin + (1.0 - shadowMin) * t;
+}
+
+void main(){
+    if(aEl2.z < 0.5){
+        vPos = vec3(0.0);
+        vBright = 1.0;
+        return;
+    }
+
+    float dt = uTime - aEl2.y;
+    float e = aEl0.y;
+
+    float M = mod(aEl0.w + aEl1.z * dt, TWO_PI);
+    if(M > 3.14159265) M -= TWO_PI;
+    float raan = aEl1.x + aEl1.w * dt;
+    float argp = aEl1.y + aEl2.x * dt;
+
+    float E = (e < 0.8) ? M : 3.14159265;
+    for(int i = 0; i < 8; i++)
+        E -= (E - e * sin(E) - M) / (1.0 - e * cos(E));
+
+    float xp = aEl0.x * (cos(E) - e);
+    float yp = aEl0.x * sqrt(1.0 - e * e) * sin(E);
+
+    float cO = cos(raan), sO = sin(raan);
+    float cw = cos(argp), sw = sin(argp);
+    float ci = cos(aEl0.z), si = sin(aEl0.z);
+
+    vec3 P = vec3(cO * cw - sO * sw * ci, sO * cw + cO * sw * ci, sw * si);
+    vec3 Q = vec3(-cO * sw - sO * cw * ci, -sO * sw + cO * cw * ci, cw * si);
+
+    vPos = (xp * P + yp * Q) * uScale;
+    vBright = shadowBrightness(vPos);
+}
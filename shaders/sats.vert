@@ -2,8 +2,13 @@
 layout(location=0) in vec3 aPos;
 layout(location=1) in float aBright;
 
-uniform mat4 uView;
-uniform mat4 uProj;
+layout(std140) uniform FrameUniforms {
+    mat4  uView;
+    mat4  uProj;
+    vec3  uSunDir;
+    float uTime;
+    vec3  uCamPos;
+};
 
 uniform int   uIsHighlight;
 uniform float uBaseSize;
@@ -3,8 +3,13 @@ in vec3 vWorldPos;
 in vec3 vWorldNrm;
 out vec4 FragColor;
 
-uniform vec3  uCamPos;
-uniform float uTime;
+layout(std140) uniform FrameUniforms {
+    mat4  uView;
+    mat4  uProj;
+    vec3  uSunDir;
+    float uTime;
+    vec3  uCamPos;
+};
 
 uniform vec3  uBaseColor;   // (1.0, 0.65, 0.20) etc
 uniform float uIntensity;   // 2.0 - 4.0 range usually
@@ -4,8 +4,13 @@ layout(location = 1) in vec3 aNrm;
 layout(location = 2) in vec2 aUV;
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProj;
+layout(std140) uniform FrameUniforms {
+    mat4  uView;
+    mat4  uProj;
+    vec3  uSunDir;
+    float uTime;
+    vec3  uCamPos;
+};
 
 out vec3 vWorldPos;
 out vec3 vWorldNrm;
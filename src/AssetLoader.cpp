@@ -0,0 +1,194 @@
+#include "AssetLoader.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <iostream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static constexpr uint32_t kCacheMagic = 0x41565345; // "ESVA"
+static constexpr uint32_t kCacheVersion = 1;
+
+namespace {
+
+struct SourceKey {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+bool sourceKey(const std::string& path, SourceKey& out) {
+    std::error_code ec;
+    out.size = (uint64_t)fs::file_size(path, ec);
+    if (ec) return false;
+    out.mtime = (int64_t)fs::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+template <class T>
+void put(std::FILE* f, const T& v) {
+    std::fwrite(&v, sizeof(T), 1, f);
+}
+
+template <class T>
+void putVec(std::FILE* f, const std::vector<T>& v) {
+    put(f, (uint64_t)v.size());
+    if (!v.empty()) std::fwrite(v.data(), sizeof(T), v.size(), f);
+}
+
+template <class T>
+bool get(std::FILE* f, T& v) {
+    return std::fread(&v, sizeof(T), 1, f) == 1;
+}
+
+template <class T>
+bool getVec(std::FILE* f, std::vector<T>& v, uint64_t maxCount) {
+    uint64_t n = 0;
+    if (!get(f, n) || n > maxCount) return false;
+    v.resize((size_t)n);
+    return n == 0 || std::fread(v.data(), sizeof(T), (size_t)n, f) == (size_t)n;
+}
+
+}
+
+bool readAssetCache(const std::string& cachePath, const std::string& sourcePath, bool srgb, GltfAsset& out) {
+    SourceKey key;
+    if (!sourceKey(sourcePath, key)) return false;
+
+    std::FILE* f = std::fopen(cachePath.c_str(), "rb");
+    if (!f) return false;
+
+    // sizes are bounded so a truncated or foreign file can't request huge allocations
+    const uint64_t kMax = 1ull << 28;
+    bool ok = true;
+    uint32_t magic = 0, version = 0;
+    SourceKey stored;
+    uint8_t storedSrgb = 0;
+    uint64_t imageCount = 0, primCount = 0;
+
+    ok = get(f, magic) && get(f, version) && magic == kCacheMagic && version == kCacheVersion &&
+         get(f, stored.size) && get(f, stored.mtime) && get(f, storedSrgb) &&
+         stored.size == key.size && stored.mtime == key.mtime && (storedSrgb != 0) == srgb;
+
+    out = GltfAsset{};
+    out.srgb = srgb;
+    ok = ok && get(f, out.boundsRadius) && get(f, imageCount) && imageCount < 4096;
+    if (ok) out.images.resize((size_t)imageCount);
+    for (size_t i = 0; ok && i < out.images.size(); i++) {
+        uint32_t levels = 0;
+        ok = get(f, levels) && levels <= 32;
+        if (ok) out.images[i].levels.resize(levels);
+        for (GltfAsset::MipLevel& m : out.images[i].levels) {
+            ok = ok && get(f, m.w) && get(f, m.h) && getVec(f, m.rgba, kMax) &&
+                 m.rgba.size() == (size_t)m.w * (size_t)m.h * 4;
+            if (!ok) break;
+        }
+    }
+
+    ok = ok && get(f, primCount) && primCount < 65536;
+    if (ok) out.prims.resize((size_t)primCount);
+    for (size_t i = 0; ok && i < out.prims.size(); i++) {
+        GltfAsset::Primitive& p = out.prims[i];
+        uint8_t hasIdx = 0;
+        ok = get(f, hasIdx) && get(f, p.baseColorTexIndex) && getVec(f, p.verts, kMax) && getVec(f, p.indices, kMax);
+        p.hasIndices = hasIdx != 0;
+    }
+
+    std::fclose(f);
+    if (!ok) out = GltfAsset{};
+    return ok && !out.prims.empty();
+}
+
+bool writeAssetCache(const std::string& cachePath, const std::string& sourcePath, const GltfAsset& asset) {
+    SourceKey key;
+    if (!sourceKey(sourcePath, key)) return false;
+
+    std::error_code ec;
+    fs::create_directories(fs::path(cachePath).parent_path(), ec);
+
+    // write beside and rename, so a crash never leaves a half file under the real name
+    const std::string tmp = cachePath + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+
+    put(f, kCacheMagic);
+    put(f, kCacheVersion);
+    put(f, key.size);
+    put(f, key.mtime);
+    put(f, (uint8_t)(asset.srgb ? 1 : 0));
+    put(f, asset.boundsRadius);
+
+    put(f, (uint64_t)asset.images.size());
+    for (const GltfAsset::Image& img : asset.images) {
+        put(f, (uint32_t)img.levels.size());
+        for (const GltfAsset::MipLevel& m : img.levels) {
+            put(f, m.w);
+            put(f, m.h);
+            putVec(f, m.rgba);
+        }
+    }
+
+    put(f, (uint64_t)asset.prims.size());
+    for (const GltfAsset::Primitive& p : asset.prims) {
+        put(f, (uint8_t)(p.hasIndices ? 1 : 0));
+        put(f, p.baseColorTexIndex);
+        putVec(f, p.verts);
+        putVec(f, p.indices);
+    }
+
+    const bool ok = !std::ferror(f);
+    if (std::fclose(f) != 0 || !ok) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    fs::rename(tmp, cachePath, ec);
+    return !ec;
+}
+
+std::string AssetLoader::cachePathFor(const std::string& path, bool srgb) const {
+    return (fs::path(m_cacheDir) / (fs::path(path).stem().string() + (srgb ? ".srgb" : ".linear") + ".asset")).string();
+}
+
+void AssetLoader::request(GltfModel& target, const std::string& path, bool srgb) {
+    const std::string cachePath = cachePathFor(path, srgb);
+
+    Job job;
+    job.target = &target;
+    job.path = path;
+    job.result = std::async(std::launch::async, [path, cachePath, srgb]()
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        Result r;
+        r.fromCache = readAssetCache(cachePath, path, srgb, r.asset);
+        r.ok = r.fromCache || decodeGltfAsset(path, srgb, r.asset);
+        if (r.ok && !r.fromCache && !writeAssetCache(cachePath, path, r.asset))
+            std::cerr << "Failed to write asset cache: " << cachePath << "\n";
+        r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        return r;
+    });
+    m_jobs.push_back(std::move(job));
+}
+
+std::vector<GltfModel*> AssetLoader::poll() {
+    std::vector<GltfModel*> swapped;
+
+    for (size_t i = 0; i < m_jobs.size();) {
+        Job& job = m_jobs[i];
+        if (job.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++i;
+            continue;
+        }
+
+        Result r = job.result.get();
+        if (r.ok && job.target->upload(r.asset)) {
+            std::cout << "Loaded " << job.path << (r.fromCache ? " (cache)" : "") << " in " << r.ms << " ms\n";
+            swapped.push_back(job.target);
+        } else {
+            std::cerr << "Failed to load GLB: " << job.path << "\n";
+        }
+
+        m_jobs.erase(m_jobs.begin() + (std::ptrdiff_t)i);
+    }
+    return swapped;
+}
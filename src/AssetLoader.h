@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <future>
+
+#include "GltfModel.h"
+
+// Ready-to-upload binary copy of a decoded GltfAsset: mip chains and
+// interleaved vertices as they go to GL. Keyed on the source file's size and
+// mtime, so editing the .glb invalidates it.
+bool readAssetCache(const std::string& cachePath, const std::string& sourcePath, bool srgb, GltfAsset& out);
+bool writeAssetCache(const std::string& cachePath, const std::string& sourcePath, const GltfAsset& asset);
+
+// Decodes models on worker threads (cache first, .glb on a miss) and hands
+// them to the main thread for the GL upload. Models keep drawing whatever
+// they hold, typically a placeholder from makeSphereAsset, until then.
+class AssetLoader {
+public:
+    explicit AssetLoader(std::string cacheDir) : m_cacheDir(std::move(cacheDir)) {}
+
+    void request(GltfModel& target, const std::string& path, bool srgb);
+
+    // Main thread, once per frame. Uploads finished assets and returns the
+    // models that were swapped.
+    std::vector<GltfModel*> poll();
+
+    size_t pending() const { return m_jobs.size(); }
+
+private:
+    struct Result {
+        bool ok = false;
+        bool fromCache = false;
+        double ms = 0.0;
+        GltfAsset asset;
+    };
+
+    struct Job {
+        GltfModel* target = nullptr;
+        std::string path;
+        std::future<Result> result;
+    };
+
+    std::string m_cacheDir;
+    std::vector<Job> m_jobs;
+
+    std::string cachePathFor(const std::string& path, bool srgb) const;
+};
@@ -0,0 +1,137 @@
+#include "Breakup.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+static constexpr double kDragCoefficient = 2.2;
+static constexpr double kMaxDeltaVKmS = 5.0; // tail of the log-normal, keeps fragments bound
+
+static double exponentFor(BreakupKind k) { return k == BreakupKind::Explosion ? 1.6 : 1.71; }
+
+// cumulative count of fragments larger than Lc
+static double cumulativeCount(const BreakupParams& p, double lc) {
+    if (p.kind == BreakupKind::Explosion) return 6.0 * p.explosionScale * std::pow(lc, -1.6);
+    return 0.1 * std::pow(std::max(p.collisionMassKg, 0.0), 0.75) * std::pow(lc, -1.71);
+}
+
+// piecewise-linear in lambda = log10(Lc), flat outside [x0, x1]
+static double ramp(double lambda, double x0, double y0, double x1, double y1) {
+    if (lambda <= x0) return y0;
+    if (lambda >= x1) return y1;
+    return y0 + (y1 - y0) * (lambda - x0) / (x1 - x0);
+}
+
+// log10(A/M) for objects above 11 cm: alpha N(mu1, s1) + (1 - alpha) N(mu2, s2)
+static double sampleLargeAreaToMass(double lambda, bool rocketBody, std::mt19937_64& rng) {
+    double alpha, mu1, s1, mu2, s2;
+    if (rocketBody) {
+        alpha = ramp(lambda, -1.4, 1.0, 0.0, 0.5);
+        mu1 = ramp(lambda, -0.5, -0.45, 0.0, -0.9);
+        s1 = 0.55;
+        mu2 = -0.9;
+        s2 = ramp(lambda, -1.0, 0.28, 0.1, 0.1);
+    } else {
+        alpha = ramp(lambda, -1.95, 0.0, 0.55, 1.0);
+        mu1 = ramp(lambda, -1.1, -0.6, 0.0, -0.95);
+        s1 = ramp(lambda, -1.3, 0.1, -0.3, 0.3);
+        mu2 = ramp(lambda, -0.7, -1.2, -0.1, -2.0);
+        s2 = ramp(lambda, -0.5, 0.5, -0.3, 0.3);
+    }
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    std::normal_distribution<double> n01(0.0, 1.0);
+    return u01(rng) < alpha ? mu1 + s1 * n01(rng) : mu2 + s2 * n01(rng);
+}
+
+// log10(A/M) for objects below 8 cm
+static double sampleSmallAreaToMass(double lambda, std::mt19937_64& rng) {
+    const double mu = ramp(lambda, -1.75, -0.3, -1.25, -1.0);
+    const double s = lambda <= -3.5 ? 0.2 : 0.2 + 0.1333 * (lambda + 3.5);
+    std::normal_distribution<double> n01(0.0, 1.0);
+    return mu + s * n01(rng);
+}
+
+double breakupFragmentCount(const BreakupParams& p) {
+    const double lmin = std::max(p.minSizeM, 1e-3);
+    const double lmax = std::max(p.maxSizeM, lmin);
+    return std::max(0.0, cumulativeCount(p, lmin) - cumulativeCount(p, lmax));
+}
+
+std::vector<Fragment> generateBreakup(const BreakupParams& p) {
+    const double lmin = std::max(p.minSizeM, 1e-3);
+    const double lmax = std::max(p.maxSizeM, lmin);
+    const double beta = exponentFor(p.kind);
+    const size_t n = std::min((size_t)std::llround(breakupFragmentCount(p)), p.maxFragments);
+
+    std::mt19937_64 rng(p.seed);
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    std::normal_distribution<double> n01(0.0, 1.0);
+
+    // inverse CDF of the power law truncated to [lmin, lmax]
+    const double a = std::pow(lmin, -beta), b = std::pow(lmax, -beta);
+
+    std::vector<Fragment> out(n);
+    for (Fragment& f : out) {
+        const double lc = std::pow(a - u01(rng) * (a - b), -1.0 / beta);
+        const double lambda = std::log10(lc);
+
+        // 8-11 cm bridges the two regimes
+        double chi;
+        if (lc >= 0.11) chi = sampleLargeAreaToMass(lambda, p.rocketBody, rng);
+        else if (lc <= 0.08) chi = sampleSmallAreaToMass(lambda, rng);
+        else chi = u01(rng) < (lc - 0.08) / 0.03 ? sampleLargeAreaToMass(lambda, p.rocketBody, rng) : sampleSmallAreaToMass(lambda, rng);
+
+        const double am = std::pow(10.0, chi);
+        const double area = lc < 0.00167 ? 0.540424 * lc * lc : 0.556945 * std::pow(lc, 2.0047077);
+
+        const double nu = (p.kind == BreakupKind::Explosion ? 0.2 * chi + 1.85 : 0.9 * chi + 2.9) + 0.4 * n01(rng);
+        const double dv = std::min(std::pow(10.0, nu) * 1e-3, kMaxDeltaVKmS);
+        const double cz = 2.0 * u01(rng) - 1.0;
+        const double phi = 2.0 * PI * u01(rng);
+        const double sz = std::sqrt(std::max(0.0, 1.0 - cz * cz));
+
+        f.sizeM = (float)lc;
+        f.areaToMassM2Kg = (float)am;
+        f.areaM2 = (float)area;
+        f.massKg = (float)(area / am);
+        f.dvKmS = dv * glm::dvec3(sz * std::cos(phi), sz * std::sin(phi), cz);
+    }
+    return out;
+}
+
+bool buildDebrisCloud(const Sgp4System& sys, size_t parent, double eventSec, double endSec,
+                      const BreakupParams& bp, const NumericalParams& np, DebrisCloud& out) {
+    const auto c0 = std::chrono::steady_clock::now();
+    out = DebrisCloud();
+
+    glm::dvec3 r, v;
+    if (parent >= sys.catalogCount() || !sys.sampleStateKm(parent, eventSec, r, v)) return false;
+
+    out.parent = parent;
+    out.firstIndex = sys.catalogCount();
+    out.eventSec = eventSec;
+    out.params = bp;
+    out.predictedCount = breakupFragmentCount(bp);
+    out.fragments = generateBreakup(bp);
+    if (out.fragments.empty()) return false;
+
+    std::string base = sys.name(parent);
+    while (!base.empty() && std::isspace((unsigned char)base.back())) base.pop_back();
+
+    out.prop = std::make_shared<NumericalPropagator>();
+    out.prop->reset(eventSec, np);
+    out.names.reserve(out.fragments.size());
+    for (size_t k = 0; k < out.fragments.size(); ++k) {
+        const Fragment& f = out.fragments[k];
+        out.prop->add((uint32_t)(out.firstIndex + k), r, v + f.dvKmS, kDragCoefficient * (double)f.areaToMassM2Kg);
+        out.names.push_back(base + " DEB " + std::to_string(k + 1));
+    }
+    out.generateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+
+    out.prop->propagateTo(endSec);
+    return true;
+}
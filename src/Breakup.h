@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "NumericalPropagator.h"
+
+class Sgp4System;
+
+enum class BreakupKind : uint8_t {
+    Explosion = 0,
+    Collision = 1
+};
+
+struct BreakupParams {
+    BreakupKind kind = BreakupKind::Explosion;
+    bool rocketBody = false;       // rocket-body area-to-mass distribution
+    double minSizeM = 0.05;        // smallest characteristic length generated
+    double maxSizeM = 1.0;
+    double explosionScale = 1.0;   // S in N = 6 S Lc^-1.6
+    double collisionMassKg = 1000.0; // M in N = 0.1 M^0.75 Lc^-1.71 (catastrophic)
+    size_t maxFragments = 20000;
+    uint64_t seed = 1;
+};
+
+struct Fragment {
+    float sizeM = 0.0f;
+    float areaToMassM2Kg = 0.0f;
+    float areaM2 = 0.0f;
+    float massKg = 0.0f;
+    glm::dvec3 dvKmS{0.0};
+};
+
+// Fragments with Lc in [minSizeM, maxSizeM] the model predicts, before the cap.
+double breakupFragmentCount(const BreakupParams& p);
+
+// NASA standard breakup model (Johnson et al. 2001): power-law sizes, a
+// size-dependent (bimodal above 11 cm) log-normal area-to-mass ratio, and a
+// log-normal delta-v conditioned on it, in a uniformly random direction.
+std::vector<Fragment> generateBreakup(const BreakupParams& p);
+
+// A breakup of one catalog object: the fragments start from its state at
+// eventSec and are integrated in one batch. Slot k of prop is object
+// firstIndex + k, ready for Sgp4System::setSynthetic.
+struct DebrisCloud {
+    size_t parent = 0;
+    size_t firstIndex = 0;
+    double eventSec = 0.0;
+    BreakupParams params;
+    double predictedCount = 0.0;
+    std::vector<Fragment> fragments;
+    std::vector<std::string> names;
+    std::shared_ptr<NumericalPropagator> prop;
+    double generateMs = 0.0;
+};
+
+bool buildDebrisCloud(const Sgp4System& sys, size_t parent, double eventSec, double endSec,
+                      const BreakupParams& bp, const NumericalParams& np, DebrisCloud& out);
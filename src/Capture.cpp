@@ -0,0 +1,220 @@
+#include "Capture.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+
+#include "stb_image_write.h"
+
+static void printUsage(const char* exe) {
+    std::cerr << "usage: " << exe << " [--headless] [--software] [--ui] [--frames N] [--dt SEC]\n"
+              << "       [--start SEC] [--size WxH] [--out DIR] [--format png|raw]\n";
+}
+
+bool parseCaptureArgs(int argc, char** argv, CaptureOptions& out) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto value = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : nullptr; };
+
+        if (a == "--headless") out.headless = true;
+        else if (a == "--software") { out.software = true; out.headless = true; }
+        else if (a == "--ui") out.withUi = true;
+        else if (a == "--frames" || a == "--dt" || a == "--start" || a == "--size" || a == "--out" || a == "--format") {
+            const char* v = value();
+            if (!v) { printUsage(argv[0]); return false; }
+
+            if (a == "--frames") out.frames = std::max(1, std::atoi(v));
+            else if (a == "--dt") out.dtSec = std::atof(v);
+            else if (a == "--start") out.startSec = std::atof(v);
+            else if (a == "--out") out.outDir = v;
+            else if (a == "--format") out.format = v;
+            else if (std::sscanf(v, "%dx%d", &out.width, &out.height) != 2 || out.width < 16 || out.height < 16) {
+                printUsage(argv[0]);
+                return false;
+            }
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (out.format != "png" && out.format != "raw") {
+        printUsage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+FrameCapture::~FrameCapture() {
+    destroy();
+}
+
+bool FrameCapture::init(const CaptureOptions& opt) {
+    m_opt = opt;
+
+    std::error_code ec;
+    std::filesystem::create_directories(opt.outDir, ec);
+
+    glGenFramebuffers(1, &m_fbo);
+    glGenRenderbuffers(1, &m_color);
+    glGenRenderbuffers(1, &m_depth);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, opt.width, opt.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, opt.width, opt.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "Capture FBO incomplete\n";
+        return false;
+    }
+
+    const GLsizeiptr bytes = (GLsizeiptr)opt.width * opt.height * 4;
+    for (Slot& s : m_ring) {
+        glGenBuffers(1, &s.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (opt.format == "raw") {
+        const std::string path = opt.outDir + "/frames_" + std::to_string(opt.width) + "x" +
+                                 std::to_string(opt.height) + "_rgba.raw";
+        m_raw = std::fopen(path.c_str(), "wb");
+        if (!m_raw) {
+            std::cerr << "Failed to open " << path << "\n";
+            return false;
+        }
+    }
+
+    m_stop = false;
+    m_writer = std::thread(&FrameCapture::writerLoop, this);
+    return true;
+}
+
+void FrameCapture::destroy() {
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(m_mu);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_writer.join();
+    }
+    if (m_raw) {
+        std::fclose(m_raw);
+        m_raw = nullptr;
+    }
+
+    for (Slot& s : m_ring) {
+        if (s.fence) glDeleteSync(s.fence);
+        if (s.pbo) glDeleteBuffers(1, &s.pbo);
+        s = Slot{};
+    }
+    if (m_depth) glDeleteRenderbuffers(1, &m_depth);
+    if (m_color) glDeleteRenderbuffers(1, &m_color);
+    if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+    m_depth = m_color = m_fbo = 0;
+}
+
+void FrameCapture::bindTarget() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_opt.width, m_opt.height);
+}
+
+void FrameCapture::retire(Slot& s) {
+    if (s.frame < 0) return;
+
+    glClientWaitSync(s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)5e9);
+    glDeleteSync(s.fence);
+    s.fence = nullptr;
+
+    const size_t bytes = (size_t)m_opt.width * (size_t)m_opt.height * 4;
+    Job job{s.frame, std::vector<uint8_t>(bytes)};
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    if (const void* p = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_READ_BIT)) {
+        std::memcpy(job.rgba.data(), p, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    s.frame = -1;
+
+    {
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_queue.push_back(std::move(job));
+    }
+    m_cv.notify_one();
+}
+
+void FrameCapture::capture() {
+    Slot& s = m_ring[m_next];
+    retire(s);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_opt.width, m_opt.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s.frame = m_frame++;
+    m_next = (m_next + 1) % kRing;
+}
+
+void FrameCapture::finish() {
+    for (int k = 0; k < kRing; ++k) retire(m_ring[(m_next + k) % kRing]);
+
+    std::unique_lock<std::mutex> lk(m_mu);
+    m_cv.wait(lk, [&] { return m_queue.empty(); });
+}
+
+int FrameCapture::framesWritten() const {
+    std::lock_guard<std::mutex> lk(m_mu);
+    return m_written;
+}
+
+void FrameCapture::writerLoop() {
+    const int w = m_opt.width, h = m_opt.height;
+    std::vector<uint8_t> flipped((size_t)w * (size_t)h * 4);
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lk(m_mu);
+            m_cv.wait(lk, [&] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return;
+            job = std::move(m_queue.front());
+        }
+
+        // GL rows are bottom-up
+        const size_t row = (size_t)w * 4;
+        for (int y = 0; y < h; ++y)
+            std::memcpy(flipped.data() + (size_t)y * row, job.rgba.data() + (size_t)(h - 1 - y) * row, row);
+
+        if (m_raw) {
+            std::fwrite(flipped.data(), 1, flipped.size(), m_raw);
+        } else {
+            char name[64];
+            std::snprintf(name, sizeof(name), "/frame_%06d.png", job.frame);
+            if (!stbi_write_png((m_opt.outDir + name).c_str(), w, h, 4, flipped.data(), (int)row))
+                std::cerr << "Failed to write frame " << job.frame << "\n";
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(m_mu);
+            m_queue.pop_front();
+            m_written++;
+        }
+        m_cv.notify_all();
+    }
+}
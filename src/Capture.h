@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <glad/glad.h>
+
+// Command line for batch capture, e.g.
+//   app --headless --frames 600 --dt 30 --size 1920x1080 --out frames --format png
+// --software selects GLFW's null platform with an OSMesa context so the
+// capture runs on machines without a GPU or display.
+struct CaptureOptions {
+    bool headless = false;
+    bool software = false;
+    bool withUi = false;
+    int width = 1920;
+    int height = 1080;
+    int frames = 300;
+    double dtSec = 10.0;     // sim seconds per captured frame
+    double startSec = 0.0;
+    std::string outDir = "capture";
+    std::string format = "png"; // png | raw
+};
+
+// Returns false (after printing usage) on a malformed command line.
+bool parseCaptureArgs(int argc, char** argv, CaptureOptions& out);
+
+// Renders into an sRGB FBO and reads frames back through a ring of PBOs,
+// so glReadPixels never stalls on the frame just submitted. Encoding runs
+// on a writer thread.
+class FrameCapture {
+public:
+    ~FrameCapture();
+
+    bool init(const CaptureOptions& opt);
+    void destroy();
+
+    void bindTarget() const;
+
+    // Queue readback of the frame just rendered; retires the oldest slot.
+    void capture();
+    // Drain outstanding PBOs and the writer queue.
+    void finish();
+
+    int framesWritten() const;
+
+private:
+    static constexpr int kRing = 3;
+
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int frame = -1;
+    };
+
+    CaptureOptions m_opt;
+    GLuint m_fbo = 0, m_color = 0, m_depth = 0;
+    Slot m_ring[kRing];
+    int m_next = 0;
+    int m_frame = 0;
+
+    std::FILE* m_raw = nullptr;
+
+    struct Job {
+        int frame;
+        std::vector<uint8_t> rgba;
+    };
+    std::deque<Job> m_queue;
+    mutable std::mutex m_mu;
+    std::condition_variable m_cv;
+    std::thread m_writer;
+    bool m_stop = false;
+    int m_written = 0;
+
+    void retire(Slot& s);
+    void writerLoop();
+};
@@ -0,0 +1,267 @@
+#include "CatalogQuery.h"
+#include "CollisionProbability.h"
+#include "Sgp4System.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+static std::string toUpper(std::string s) {
+    for (char& c : s) c = (char)std::toupper((unsigned char)c);
+    return s;
+}
+
+void CatalogTable::build(const Sgp4System& sys, const ElementIndex& index) {
+    const size_t n = sys.count();
+    for (auto& c : m_cols) c.assign(n, 0.0f);
+    m_upperNames.resize(n);
+
+    const bool shapes = index.count() == n;
+    for (size_t i = 0; i < n; i++) {
+        if (shapes) {
+            const OrbitShape& s = index.shape(i);
+            m_cols[Perigee][i] = s.perigeeKm;
+            m_cols[Apogee][i] = s.apogeeKm;
+            m_cols[Inclination][i] = s.inclinationDeg;
+            m_cols[Raan][i] = s.raanDeg;
+            m_cols[Eccentricity][i] = s.eccentricity;
+            m_cols[NodalRate][i] = s.nodalRateDegDay;
+        }
+        m_cols[PeriodMin][i] = (float)(sys.periodSeconds(i) / 60.0);
+        m_cols[Norad][i] = (float)sys.noradId(i);
+        m_cols[Index][i] = (float)i;
+        m_cols[Class][i] = (float)(int)classifyObject(sys.name(i));
+        m_upperNames[i] = toUpper(sys.name(i));
+    }
+}
+
+int CatalogTable::findColumn(const std::string& ident) {
+    static const struct {
+        const char* name;
+        Column col;
+    } kNames[] = {
+        {"alt_perigee", Perigee}, {"perigee", Perigee},
+        {"alt_apogee", Apogee},   {"apogee", Apogee},
+        {"inc", Inclination},     {"inclination", Inclination},
+        {"raan", Raan},
+        {"ecc", Eccentricity},    {"eccentricity", Eccentricity},
+        {"period", PeriodMin},
+        {"nodal_rate", NodalRate},
+        {"norad", Norad},
+        {"index", Index},
+        {"class", Class},
+    };
+    for (const auto& n : kNames)
+        if (ident == n.name) return n.col;
+    return -1;
+}
+
+struct CatalogQuery::Parser {
+    const std::string& s;
+    size_t pos = 0;
+    std::vector<Op>& out;
+    std::string error;
+
+    Parser(const std::string& text, std::vector<Op>& ops) : s(text), out(ops) {}
+
+    void skipSpace() {
+        while (pos < s.size() && std::isspace((unsigned char)s[pos])) pos++;
+    }
+
+    bool accept(const char* tok) {
+        skipSpace();
+        const size_t n = std::strlen(tok);
+        if (s.compare(pos, n, tok) != 0) return false;
+        pos += n;
+        return true;
+    }
+
+    void emit(OpKind kind) {
+        Op op;
+        op.kind = kind;
+        out.push_back(op);
+    }
+
+    bool fail(const std::string& what) {
+        if (error.empty()) error = what + " at column " + std::to_string(pos + 1);
+        return false;
+    }
+
+    bool orExpr() {
+        if (!andExpr()) return false;
+        while (accept("||")) {
+            if (!andExpr()) return false;
+            emit(OpKind::Or);
+        }
+        return true;
+    }
+
+    bool andExpr() {
+        if (!unary()) return false;
+        while (accept("&&")) {
+            if (!unary()) return false;
+            emit(OpKind::And);
+        }
+        return true;
+    }
+
+    bool unary() {
+        skipSpace();
+        if (pos < s.size() && s[pos] == '!' && s.compare(pos, 2, "!=") != 0) {
+            pos++;
+            if (!unary()) return false;
+            emit(OpKind::Not);
+            return true;
+        }
+        if (accept("(")) {
+            if (!orExpr()) return false;
+            return accept(")") || fail("expected ')'");
+        }
+        return comparison();
+    }
+
+    bool identifier(std::string& id) {
+        skipSpace();
+        const size_t b = pos;
+        while (pos < s.size() && (std::isalnum((unsigned char)s[pos]) || s[pos] == '_')) pos++;
+        id = s.substr(b, pos - b);
+        return !id.empty();
+    }
+
+    bool stringLiteral(std::string& v) {
+        skipSpace();
+        if (pos >= s.size() || s[pos] != '"') return fail("expected string");
+        const size_t end = s.find('"', pos + 1);
+        if (end == std::string::npos) return fail("unterminated string");
+        v = s.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+        return true;
+    }
+
+    bool comparison() {
+        std::string id;
+        if (!identifier(id)) return fail("expected a column name");
+
+        if (id == "name") {
+            Op op;
+            op.kind = OpKind::NameMatch;
+            if (!accept("~")) return fail("expected '~' after name");
+            if (!stringLiteral(op.needle)) return false;
+            op.needle = toUpper(op.needle);
+            out.push_back(op);
+            return true;
+        }
+
+        Op op;
+        op.column = CatalogTable::findColumn(id);
+        if (op.column < 0) return fail("unknown column '" + id + "'");
+
+        // two-character operators first
+        if (accept("<=")) op.kind = OpKind::LessEq;
+        else if (accept(">=")) op.kind = OpKind::GreaterEq;
+        else if (accept("==")) op.kind = OpKind::Equal;
+        else if (accept("!=")) op.kind = OpKind::NotEqual;
+        else if (accept("<")) op.kind = OpKind::Less;
+        else if (accept(">")) op.kind = OpKind::Greater;
+        else return fail("expected a comparison");
+
+        skipSpace();
+        if (op.column == CatalogTable::Class && pos < s.size() && s[pos] == '"') {
+            std::string cls;
+            if (!stringLiteral(cls)) return false;
+            int found = -1;
+            for (int c = 0; c <= (int)ObjectClass::Unknown; c++)
+                if (toUpper(objectClassName((ObjectClass)c)) == toUpper(cls)) found = c;
+            if (found < 0) return fail("unknown class \"" + cls + "\"");
+            op.value = (float)found;
+        } else {
+            const char* b = s.c_str() + pos;
+            char* e = nullptr;
+            const double v = std::strtod(b, &e);
+            if (e == b) return fail("expected a number");
+            pos += (size_t)(e - b);
+            op.value = (float)v;
+        }
+        out.push_back(op);
+        return true;
+    }
+};
+
+bool CatalogQuery::compile(const std::string& text, std::string& error) {
+    std::vector<Op> ops;
+    Parser p(text, ops);
+    p.skipSpace();
+    if (p.pos < text.size()) {
+        if (!p.orExpr()) {
+            error = p.error;
+            return false;
+        }
+        p.skipSpace();
+        if (p.pos < text.size()) {
+            p.fail("unexpected '" + text.substr(p.pos, 1) + "'");
+            error = p.error;
+            return false;
+        }
+    }
+    m_ops.swap(ops);
+    m_text = text;
+    error.clear();
+    return true;
+}
+
+// one column against a constant, 64 rows per output word
+template <class Pred>
+static void compareKernel(const std::vector<float>& col, Pred pred, IndexBitset& out) {
+    const size_t n = col.size();
+    for (size_t wi = 0; wi < out.wordCount(); wi++) {
+        const size_t base = wi * 64;
+        const size_t m = std::min<size_t>(64, n - base);
+        uint64_t w = 0;
+        for (size_t b = 0; b < m; b++) w |= (uint64_t)pred(col[base + b]) << b;
+        out.setWord(wi, w);
+    }
+}
+
+IndexBitset CatalogQuery::evaluate(const CatalogTable& table) const {
+    const size_t n = table.rows();
+    if (m_ops.empty()) return IndexBitset(n, true);
+
+    std::vector<IndexBitset> stack;
+    for (const Op& op : m_ops) {
+        if (op.kind == OpKind::And || op.kind == OpKind::Or) {
+            IndexBitset rhs = std::move(stack.back());
+            stack.pop_back();
+            if (op.kind == OpKind::And) stack.back() &= rhs;
+            else stack.back() |= rhs;
+            continue;
+        }
+        if (op.kind == OpKind::Not) {
+            stack.back().flip();
+            continue;
+        }
+
+        IndexBitset m(n);
+        const float v = op.value;
+        if (op.kind == OpKind::NameMatch) {
+            for (size_t i = 0; i < n; i++)
+                if (table.upperName(i).find(op.needle) != std::string::npos) m.set(i);
+        } else {
+            const std::vector<float>& col = table.column((CatalogTable::Column)op.column);
+            switch (op.kind) {
+                case OpKind::Less:      compareKernel(col, [v](float x) { return x < v; }, m); break;
+                case OpKind::LessEq:    compareKernel(col, [v](float x) { return x <= v; }, m); break;
+                case OpKind::Greater:   compareKernel(col, [v](float x) { return x > v; }, m); break;
+                case OpKind::GreaterEq: compareKernel(col, [v](float x) { return x >= v; }, m); break;
+                case OpKind::Equal:     compareKernel(col, [v](float x) { return x == v; }, m); break;
+                default:                compareKernel(col, [v](float x) { return x != v; }, m); break;
+            }
+        }
+        stack.push_back(std::move(m));
+    }
+    return stack.empty() ? IndexBitset(n, true) : std::move(stack.back());
+}
+
+void CatalogQuery::select(const CatalogTable& table, std::vector<uint32_t>& out) const {
+    evaluate(table).indices(out);
+}
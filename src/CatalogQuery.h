@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ElementIndex.h"
+
+class Sgp4System;
+
+// Column-major copy of what catalog queries filter on, one row per object.
+class CatalogTable {
+public:
+    enum Column {
+        Perigee,      // km
+        Apogee,       // km
+        Inclination,  // deg
+        Raan,         // deg
+        Eccentricity,
+        PeriodMin,
+        NodalRate,    // deg/day
+        Norad,
+        Index,        // catalog position
+        Class,        // ObjectClass
+        ColumnCount
+    };
+
+    void build(const Sgp4System& sys, const ElementIndex& index);
+
+    size_t rows() const { return m_upperNames.size(); }
+    const std::vector<float>& column(Column c) const { return m_cols[c]; }
+    const std::string& upperName(size_t row) const { return m_upperNames[row]; }
+
+    // Query identifier -> column, -1 if unknown.
+    static int findColumn(const std::string& ident);
+
+private:
+    std::vector<float> m_cols[ColumnCount];
+    std::vector<std::string> m_upperNames;
+};
+
+// A filter expression compiled to predicate kernels, e.g.
+//   alt_perigee < 600 && inc > 97 && name ~ "STARLINK"
+// Comparisons (< <= > >= == !=) take a column and a number; `name ~ "x"` is a
+// case-insensitive substring match and `class == "debris"` compares the object
+// class. Terms combine with && || ! and parentheses. Each kernel scans one
+// column and emits whole 64-bit mask words; the boolean ops then work word-wise.
+class CatalogQuery {
+public:
+    // Empty text compiles to "everything". On failure the previous program is
+    // kept and error says what and where.
+    bool compile(const std::string& text, std::string& error);
+
+    bool empty() const { return m_ops.empty(); }
+    const std::string& text() const { return m_text; }
+
+    IndexBitset evaluate(const CatalogTable& table) const;
+
+    // Dense ascending index list of matching rows.
+    void select(const CatalogTable& table, std::vector<uint32_t>& out) const;
+
+private:
+    enum class OpKind : uint8_t { Less, LessEq, Greater, GreaterEq, Equal, NotEqual, NameMatch, And, Or, Not };
+
+    // postfix program; comparisons push a mask, And/Or/Not combine masks
+    struct Op {
+        OpKind kind = OpKind::Less;
+        int column = 0;
+        float value = 0.0f;
+        std::string needle;
+    };
+
+    std::vector<Op> m_ops;
+    std::string m_text;
+
+    struct Parser;
+};
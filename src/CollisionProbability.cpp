@@ -0,0 +1,285 @@
+#include "CollisionProbability.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+
+static std::string upper(std::string s) {
+    for (char& c : s) c = (char)std::toupper((unsigned char)c);
+    return s;
+}
+
+static std::string trim(const std::string& s) {
+    const size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) return {};
+    const size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+ObjectClass classifyObject(const std::string& name) {
+    const std::string n = upper(trim(name));
+    if (n.empty()) return ObjectClass::Unknown;
+    if (n.find("R/B") != std::string::npos) return ObjectClass::RocketBody;
+    if (n.find(" DEB") != std::string::npos || n.rfind("DEB", 0) == 0) return ObjectClass::Debris;
+    return ObjectClass::Payload;
+}
+
+const char* objectClassName(ObjectClass c) {
+    switch (c) {
+        case ObjectClass::Payload: return "payload";
+        case ObjectClass::RocketBody: return "rocket body";
+        case ObjectClass::Debris: return "debris";
+        default: return "unknown";
+    }
+}
+
+// TLE-grade defaults: in-track dominates, debris is tracked worst
+CovarianceCatalog::CovarianceCatalog() {
+    m_defaults[(int)ObjectClass::Payload] = {glm::dvec3(0.2, 1.0, 0.2), 0.005};
+    m_defaults[(int)ObjectClass::RocketBody] = {glm::dvec3(0.3, 1.5, 0.3), 0.005};
+    m_defaults[(int)ObjectClass::Debris] = {glm::dvec3(0.5, 3.0, 0.5), 0.0005};
+    m_defaults[(int)ObjectClass::Unknown] = {glm::dvec3(0.5, 3.0, 0.5), 0.001};
+}
+
+int CovarianceCatalog::loadCsv(const std::string& path, const Sgp4System& sys) {
+    std::ifstream in(path);
+    if (!in) return -1;
+
+    std::unordered_map<std::string, size_t> byName;
+    byName.reserve(sys.count());
+    for (size_t i = 0; i < sys.count(); ++i) byName.emplace(trim(sys.name(i)), i);
+
+    int matched = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string cell;
+        while (std::getline(ss, cell, ',')) f.push_back(trim(cell));
+        if (f.size() < 4) continue;
+
+        char* end = nullptr;
+        const double sr = std::strtod(f[1].c_str(), &end);
+        if (end == f[1].c_str()) continue; // header or junk
+
+        auto it = byName.find(f[0]);
+        if (it == byName.end()) continue;
+
+        ObjectCovariance c = defaultFor(classifyObject(f[0]));
+        c.sigmaRtnKm = glm::dvec3(sr, std::atof(f[2].c_str()), std::atof(f[3].c_str()));
+        if (f.size() >= 5 && !f[4].empty()) c.hardBodyRadiusKm = std::atof(f[4].c_str()) * 1e-3;
+        m_supplied[it->second] = c;
+        matched++;
+    }
+    return matched;
+}
+
+ObjectCovariance CovarianceCatalog::forObject(const Sgp4System& sys, size_t idx) const {
+    auto it = m_supplied.find(idx);
+    if (it != m_supplied.end()) return it->second;
+    return defaultFor(classifyObject(idx < sys.count() ? sys.name(idx) : std::string()));
+}
+
+Cov3 rtnToEci(const glm::dvec3& rKm, const glm::dvec3& vKmS, const glm::dvec3& sigmaRtnKm) {
+    const glm::dvec3 R = glm::normalize(rKm);
+    const glm::dvec3 N = glm::normalize(glm::cross(rKm, vKmS));
+    const glm::dvec3 T = glm::cross(N, R);
+    const glm::dvec3 var = sigmaRtnKm * sigmaRtnKm;
+
+    // C = sum_k var_k * e_k e_k^T
+    Cov3 c;
+    const glm::dvec3 e[3] = {R, T, N};
+    for (int k = 0; k < 3; ++k) {
+        const double s = var[k];
+        c.xx += s * e[k].x * e[k].x;
+        c.xy += s * e[k].x * e[k].y;
+        c.xz += s * e[k].x * e[k].z;
+        c.yy += s * e[k].y * e[k].y;
+        c.yz += s * e[k].y * e[k].z;
+        c.zz += s * e[k].z * e[k].z;
+    }
+    return c;
+}
+
+static double quad(const Cov3& c, const glm::dvec3& a, const glm::dvec3& b) {
+    return a.x * (c.xx * b.x + c.xy * b.y + c.xz * b.z) +
+           a.y * (c.xy * b.x + c.yy * b.y + c.yz * b.z) +
+           a.z * (c.xz * b.x + c.yz * b.y + c.zz * b.z);
+}
+
+namespace {
+
+// Gauss-Legendre on theta in [-pi/2, pi/2]; x = R sin(theta) keeps the
+// square-root edge of the disk smooth
+struct DiskRule {
+    int n = 0;
+    std::vector<double> sinT, cosT, w;
+};
+
+const DiskRule& diskRule(int n) {
+    thread_local DiskRule rule;
+    if (rule.n == n) return rule;
+
+    rule.n = n;
+    rule.sinT.assign((size_t)n, 0.0);
+    rule.cosT.assign((size_t)n, 0.0);
+    rule.w.assign((size_t)n, 0.0);
+    for (int i = 0; i < (n + 1) / 2; ++i) {
+        double z = std::cos(PI * ((double)i + 0.75) / ((double)n + 0.5));
+        double dp = 1.0;
+        for (int it = 0; it < 100; ++it) {
+            double p1 = 1.0, p2 = 0.0;
+            for (int j = 1; j <= n; ++j) {
+                const double p3 = p2;
+                p2 = p1;
+                p1 = ((2.0 * j - 1.0) * z * p2 - (j - 1.0) * p3) / j;
+            }
+            dp = n * (z * p1 - p2) / (z * z - 1.0);
+            const double z1 = z;
+            z = z1 - p1 / dp;
+            if (std::fabs(z - z1) < 1e-15) break;
+        }
+        const double w = 2.0 / ((1.0 - z * z) * dp * dp);
+        const double lo = -0.5 * PI * z, hi = 0.5 * PI * z;
+        rule.sinT[(size_t)i] = std::sin(lo);
+        rule.cosT[(size_t)i] = std::cos(lo);
+        rule.sinT[(size_t)(n - 1 - i)] = std::sin(hi);
+        rule.cosT[(size_t)(n - 1 - i)] = std::cos(hi);
+        rule.w[(size_t)i] = rule.w[(size_t)(n - 1 - i)] = 0.5 * PI * w;
+    }
+    return rule;
+}
+
+}
+
+EncounterPc encounterPc(const glm::dvec3& r1, const glm::dvec3& v1, const Cov3& c1,
+                        const glm::dvec3& r2, const glm::dvec3& v2, const Cov3& c2,
+                        double hbrKm, const PcParams& p, uint64_t mcSeed) {
+    EncounterPc out;
+
+    const glm::dvec3 d = r2 - r1;
+    const glm::dvec3 u = v2 - v1;
+    const double speed = glm::length(u);
+    if (speed < 1e-6 || hbrKm <= 0.0) return out; // co-moving: short-encounter model doesn't apply
+
+    const glm::dvec3 uh = u / speed;
+    const glm::dvec3 dPerp = d - glm::dot(d, uh) * uh;
+    const double miss = glm::length(dPerp);
+
+    glm::dvec3 xh;
+    if (miss > 1e-12) {
+        xh = dPerp / miss;
+    } else {
+        const glm::dvec3 ref = (std::fabs(uh.x) < 0.9) ? glm::dvec3(1, 0, 0) : glm::dvec3(0, 1, 0);
+        xh = glm::normalize(glm::cross(uh, ref));
+    }
+    const glm::dvec3 yh = glm::cross(uh, xh);
+
+    Cov3 c;
+    c.xx = c1.xx + c2.xx; c.xy = c1.xy + c2.xy; c.xz = c1.xz + c2.xz;
+    c.yy = c1.yy + c2.yy; c.yz = c1.yz + c2.yz; c.zz = c1.zz + c2.zz;
+
+    // projected 2x2 covariance, then its principal axes
+    const double pxx = quad(c, xh, xh), pxy = quad(c, xh, yh), pyy = quad(c, yh, yh);
+    const double phi = 0.5 * std::atan2(2.0 * pxy, pxx - pyy);
+    const double cp = std::cos(phi), sp = std::sin(phi);
+    const double l1 = pxx * cp * cp + 2.0 * pxy * sp * cp + pyy * sp * sp;
+    const double l2 = pxx * sp * sp - 2.0 * pxy * sp * cp + pyy * cp * cp;
+    const double s1 = std::sqrt(std::max(l1, 1e-12));
+    const double s2 = std::sqrt(std::max(l2, 1e-12));
+
+    // miss vector is (miss, 0) in the (xh, yh) plane
+    const double xm = miss * cp;
+    const double ym = -miss * sp;
+
+    const DiskRule& rule = diskRule(std::clamp(p.quadratureNodes, 8, 256));
+    const double kx = 1.0 / (std::sqrt(2.0 * PI) * s1);
+    const double inv2s1 = 1.0 / (2.0 * s1 * s1);
+    const double invS2 = 1.0 / (std::sqrt(2.0) * s2);
+
+    double pc = 0.0;
+    for (int i = 0; i < rule.n; ++i) {
+        const double x = hbrKm * rule.sinT[(size_t)i];
+        const double h = hbrKm * rule.cosT[(size_t)i];
+        const double gx = kx * std::exp(-(xm + x) * (xm + x) * inv2s1);
+        const double strip = 0.5 * (std::erf((ym + h) * invS2) - std::erf((ym - h) * invS2));
+        pc += rule.w[(size_t)i] * gx * strip * h;
+    }
+
+    out.valid = true;
+    out.pc = std::clamp(pc, 0.0, 1.0);
+    out.missKm = miss;
+    out.sigmaMajorKm = std::max(s1, s2);
+    out.sigmaMinorKm = std::min(s1, s2);
+
+    if (p.monteCarlo && p.mcSamples > 0) {
+        // Cholesky of the combined 3-D covariance; the jitter keeps a zero sigma from breaking it
+        const double j = 1e-12;
+        const double l11 = std::sqrt(std::max(c.xx + j, j));
+        const double l21 = c.xy / l11;
+        const double l31 = c.xz / l11;
+        const double l22 = std::sqrt(std::max(c.yy + j - l21 * l21, j));
+        const double l32 = (c.yz - l31 * l21) / l22;
+        const double l33 = std::sqrt(std::max(c.zz + j - l31 * l31 - l32 * l32, j));
+
+        std::mt19937_64 rng(p.seed ^ (mcSeed * 0x9E3779B97F4A7C15ull));
+        std::normal_distribution<double> n01(0.0, 1.0);
+        const double r2max = hbrKm * hbrKm;
+
+        int64_t hits = 0;
+        for (int k = 0; k < p.mcSamples; ++k) {
+            const double z1 = n01(rng), z2 = n01(rng), z3 = n01(rng);
+            const glm::dvec3 e(l11 * z1, l21 * z1 + l22 * z2, l31 * z1 + l32 * z2 + l33 * z3);
+            const glm::dvec3 dd = d + e;
+            const glm::dvec3 perp = dd - glm::dot(dd, uh) * uh;
+            if (glm::dot(perp, perp) < r2max) hits++;
+        }
+
+        const double n = (double)p.mcSamples;
+        out.pcMonteCarlo = (double)hits / n;
+        out.pcMcStdErr = std::sqrt(std::max(out.pcMonteCarlo * (1.0 - out.pcMonteCarlo), 1.0 / n) / n);
+    }
+    return out;
+}
+
+void computeCollisionProbabilities(
+    const Sgp4System& sys,
+    size_t primaryIdx,
+    const CovarianceCatalog& cov,
+    const PcParams& p,
+    std::vector<ConjunctionHit>& hits)
+{
+    if (primaryIdx >= sys.count()) return;
+    const ObjectCovariance primCov = cov.forObject(sys, primaryIdx);
+
+    parallelFor(hits.size(), p.monteCarlo ? 1 : 16, [&](size_t begin, size_t end, unsigned) {
+        for (size_t k = begin; k < end; ++k) {
+            ConjunctionHit& h = hits[k];
+            h.pc = h.pcMonteCarlo = -1.0;
+            h.pcMcStdErr = 0.0;
+            if (h.otherIdx < 0 || (size_t)h.otherIdx >= sys.count()) continue;
+
+            glm::dvec3 r1, v1, r2, v2;
+            if (!sys.sampleStateKm(primaryIdx, h.tcaSec, r1, v1)) continue;
+            if (!sys.sampleStateKm((size_t)h.otherIdx, h.tcaSec, r2, v2)) continue;
+
+            const ObjectCovariance otherCov = cov.forObject(sys, (size_t)h.otherIdx);
+            const EncounterPc e = encounterPc(
+                r1, v1, rtnToEci(r1, v1, primCov.sigmaRtnKm),
+                r2, v2, rtnToEci(r2, v2, otherCov.sigmaRtnKm),
+                primCov.hardBodyRadiusKm + otherCov.hardBodyRadiusKm, p, (uint64_t)h.otherIdx);
+            if (!e.valid) continue;
+
+            h.pc = e.pc;
+            h.pcMonteCarlo = e.pcMonteCarlo;
+            h.pcMcStdErr = e.pcMcStdErr;
+        }
+    });
+}
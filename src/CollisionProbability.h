@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Conjunction.h"
+
+class Sgp4System;
+
+enum class ObjectClass : uint8_t {
+    Payload = 0,
+    RocketBody = 1,
+    Debris = 2,
+    Unknown = 3
+};
+
+// From the catalog name: "R/B" = rocket body, "DEB" = debris, else payload.
+ObjectClass classifyObject(const std::string& name);
+const char* objectClassName(ObjectClass c);
+
+// 1-sigma position uncertainty in the object's radial / in-track / cross-track
+// frame at TCA, plus its hard-body radius.
+struct ObjectCovariance {
+    glm::dvec3 sigmaRtnKm{0.2, 1.0, 0.2};
+    double hardBodyRadiusKm = 0.005;
+};
+
+// Supplied covariances where we have them, class defaults for the rest.
+class CovarianceCatalog {
+public:
+    CovarianceCatalog();
+
+    void setDefault(ObjectClass c, const ObjectCovariance& cov) { m_defaults[(int)c] = cov; }
+    const ObjectCovariance& defaultFor(ObjectClass c) const { return m_defaults[(int)c]; }
+
+    // name,sigma_r_km,sigma_t_km,sigma_n_km[,hbr_m] rows, names matched
+    // exactly against the catalog. Returns rows matched, -1 if unreadable.
+    int loadCsv(const std::string& path, const Sgp4System& sys);
+    void clearSupplied() { m_supplied.clear(); }
+    size_t suppliedCount() const { return m_supplied.size(); }
+
+    ObjectCovariance forObject(const Sgp4System& sys, size_t idx) const;
+
+private:
+    ObjectCovariance m_defaults[4];
+    std::unordered_map<size_t, ObjectCovariance> m_supplied;
+};
+
+struct PcParams {
+    int quadratureNodes = 48;   // Gauss-Legendre nodes across the hard-body disk
+    bool monteCarlo = false;    // cross-check against sampled 3-D position errors
+    int mcSamples = 200000;
+    uint64_t seed = 1;
+};
+
+// Symmetric 3x3 position covariance, km^2.
+struct Cov3 {
+    double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+};
+
+Cov3 rtnToEci(const glm::dvec3& rKm, const glm::dvec3& vKmS, const glm::dvec3& sigmaRtnKm);
+
+struct EncounterPc {
+    bool valid = false;
+    double pc = 0.0;
+    double pcMonteCarlo = -1.0;
+    double pcMcStdErr = 0.0;
+    double missKm = 0.0;         // in the encounter plane
+    double sigmaMajorKm = 0.0;   // combined, projected onto the encounter plane
+    double sigmaMinorKm = 0.0;
+};
+
+// Short-encounter (rectilinear) probability for one conjunction: the combined
+// covariance is projected onto the plane normal to the relative velocity and
+// the Gaussian integrated over the combined hard-body disk at the miss vector
+// (Foster; evaluated in the 1-D erf form of Alfano / Elrod).
+EncounterPc encounterPc(const glm::dvec3& r1, const glm::dvec3& v1, const Cov3& c1,
+                        const glm::dvec3& r2, const glm::dvec3& v2, const Cov3& c2,
+                        double hbrKm, const PcParams& p, uint64_t mcSeed = 0);
+
+// Fills ConjunctionHit::pc (and the Monte Carlo fields when enabled) for every
+// hit against primaryIdx, re-sampling both states at TCA. Hits run in parallel.
+void computeCollisionProbabilities(
+    const Sgp4System& sys,
+    size_t primaryIdx,
+    const CovarianceCatalog& cov,
+    const PcParams& p,
+    std::vector<ConjunctionHit>& hits
+);
@@ -1,6 +1,10 @@
 #include "Conjunction.h"
+#include "ElementIndex.h"
+#include "Parallel.h"
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <unordered_map>
 
 static double lengthKm(const glm::dvec3& v) {
     return std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
@@ -14,6 +18,69 @@ static double distKm(const glm::dvec3& a, const glm::dvec3& b) {
     return lengthKm(a - b);
 }
 
+void screeningCandidates(const Sgp4System& sys, const ConjunctionParams& p, size_t primary, size_t maxCheck,
+                         std::vector<size_t>& out, double padKm) {
+    out.clear();
+    std::vector<uint32_t> ids;
+    if (p.prefilter && p.prefilter->count() == sys.count()) {
+        p.prefilter->altitudeCandidates(primary, std::max(0.1, p.thresholdKm) + kBandMarginKm + padKm).indices(ids);
+    } else {
+        ids.resize(maxCheck);
+        for (size_t i = 0; i < maxCheck; ++i) ids[i] = (uint32_t)i;
+    }
+
+    if (p.secondaries) {
+        std::vector<uint32_t> both;
+        std::set_intersection(ids.begin(), ids.end(), p.secondaries->begin(), p.secondaries->end(), std::back_inserter(both));
+        ids.swap(both);
+    }
+
+    for (uint32_t id : ids) {
+        if (id >= maxCheck) break;
+        out.push_back(id);
+    }
+}
+
+// fine search within one coarse step either side of a coarse minimum
+static void refineTca(const Sgp4System& sys, size_t targetIdx, size_t otherIdx, double coarseT, double dt,
+                      double& tca, double& miss) {
+    const double halfWin = dt;      
+    const double fineDt  = std::max(0.5, dt / 10.0);
+
+    double bestFineD = miss;
+    double bestFineT = coarseT;
+
+    for (double t = coarseT - halfWin; t <= coarseT + halfWin; t += fineDt) {
+        glm::dvec3 po, pt;
+        if (!sampleKmAt(sys, otherIdx, t, po)) continue;
+        if (!sampleKmAt(sys, targetIdx, t, pt)) continue;
+
+        const double d = distKm(po, pt);
+        if (d < bestFineD) {
+            bestFineD = d;
+            bestFineT = t;
+        }
+    }
+
+    tca = bestFineT;
+    miss = bestFineD;
+}
+
+static double relativeSpeedKmS(const Sgp4System& sys, size_t targetIdx, size_t otherIdx, double tca) {
+    const double eps = 1.0;
+    glm::dvec3 pta0, pta1, pob0, pob1;
+    if (sampleKmAt(sys, targetIdx, tca - eps, pta0) &&
+        sampleKmAt(sys, targetIdx, tca + eps, pta1) &&
+        sampleKmAt(sys, otherIdx,  tca - eps, pob0) &&
+        sampleKmAt(sys, otherIdx,  tca + eps, pob1))
+    {
+        glm::dvec3 vT = (pta1 - pta0) / (2.0 * eps); 
+        glm::dvec3 vO = (pob1 - pob0) / (2.0 * eps);
+        return lengthKm(vO - vT);
+    }
+    return 0.0;
+}
+
 bool computeConjunctionsSelectedVsAll(
     const Sgp4System& sys,
     size_t targetIdx,
@@ -51,8 +118,10 @@ bool computeConjunctionsSelectedVsAll(
     const double thresh = std::max(0.1, p.thresholdKm);
     const double thresh2 = thresh * thresh;
 
-    for (int oi = 0; oi < maxCheck; ++oi) {
-        const size_t otherIdx = (size_t)oi;
+    std::vector<size_t> candidates;
+    screeningCandidates(sys, p, targetIdx, (size_t)maxCheck, candidates);
+
+    for (size_t otherIdx : candidates) {
         if (otherIdx == targetIdx) continue;
 
         double bestD2 = 1e300;
@@ -80,55 +149,343 @@ bool computeConjunctionsSelectedVsAll(
         double tca = bestT;
         double miss = std::sqrt(bestD2);
 
-        if (p.refine) {
-            const double halfWin = dt;      
-            const double fineDt  = std::max(0.5, dt / 10.0);
+        if (p.refine) refineTca(sys, targetIdx, otherIdx, bestT, dt, tca, miss);
 
-            double bestFineD = miss;
-            double bestFineT = bestT;
+        ConjunctionHit hit;
+        hit.otherIdx = (int)otherIdx;
+        hit.tcaSec = tca;
+        hit.missKm = miss;
+        hit.relSpeedKmS = relativeSpeedKmS(sys, targetIdx, otherIdx, tca);
+        outHits.push_back(hit);
+    }
 
-            for (double t = bestT - halfWin; t <= bestT + halfWin; t += fineDt) {
-                glm::dvec3 po, pt;
-                if (!sampleKmAt(sys, otherIdx, t, po)) continue;
-                if (!sampleKmAt(sys, targetIdx, t, pt)) continue;
+    std::sort(outHits.begin(), outHits.end(), [](const ConjunctionHit& a, const ConjunctionHit& b){
+        return a.missKm < b.missKm;
+    });
+
+    return true;
+}
 
-                const double d = distKm(po, pt);
-                if (d < bestFineD) {
-                    bestFineD = d;
-                    bestFineT = t;
+bool computeConjunctionsWatchList(
+    const Sgp4System& sys,
+    const std::vector<size_t>& primaries,
+    double startSimSec,
+    const ConjunctionParams& p,
+    std::vector<std::vector<ConjunctionHit>>& outHits)
+{
+    outHits.assign(primaries.size(), {});
+    const size_t N = sys.count();
+    const size_t P = primaries.size();
+    if (N == 0 || P == 0) return false;
+
+    const size_t maxCheck = std::min(N, (size_t)std::max(1, p.maxSatsToCheck));
+    const double t0 = startSimSec;
+    const double t1 = startSimSec + std::max(1.0, p.horizonSec);
+    const double dt = std::max(1.0, p.stepSec);
+
+    const int steps = (int)std::ceil((t1 - t0) / dt) + 1;
+    if (steps < 2) return false;
+
+    // primaries are few: sample them all up front, [k * steps + s]
+    std::vector<glm::dvec3> primPos(P * (size_t)steps);
+    std::vector<char> primOk(P, 0);
+    for (size_t k = 0; k < P; ++k) {
+        if (primaries[k] >= N) continue;
+        bool ok = true;
+        for (int s = 0; s < steps && ok; ++s)
+            ok = sampleKmAt(sys, primaries[k], t0 + (double)s * dt, primPos[k * (size_t)steps + (size_t)s]);
+        primOk[k] = ok ? 1 : 0;
+    }
+
+    const double thresh = std::max(0.1, p.thresholdKm);
+    const double thresh2 = thresh * thresh;
+
+    // each primary only looks at its own band; the pass covers their union
+    std::vector<std::vector<char>> inBand(P);
+    std::vector<char> anyBand(maxCheck, 0);
+    std::vector<size_t> ids;
+    for (size_t k = 0; k < P; ++k) {
+        if (!primOk[k]) continue;
+        inBand[k].assign(maxCheck, 0);
+        screeningCandidates(sys, p, primaries[k], maxCheck, ids);
+        for (size_t id : ids) inBand[k][id] = anyBand[id] = 1;
+    }
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < maxCheck; ++i)
+        if (anyBand[i]) candidates.push_back(i);
+
+    struct Found {
+        size_t slot;
+        ConjunctionHit hit;
+    };
+    std::vector<std::vector<Found>> found(workerCount());
+
+    parallelFor(candidates.size(), 64, [&](size_t begin, size_t end, unsigned w) {
+        std::vector<double> bestD2(P);
+        std::vector<int> bestS(P);
+
+        for (size_t ci = begin; ci < end; ++ci) {
+            const size_t otherIdx = candidates[ci];
+            std::fill(bestD2.begin(), bestD2.end(), 1e300);
+            std::fill(bestS.begin(), bestS.end(), 0);
+            bool anyValid = false;
+
+            for (int s = 0; s < steps; ++s) {
+                glm::dvec3 po;
+                if (!sampleKmAt(sys, otherIdx, t0 + (double)s * dt, po)) continue;
+                anyValid = true;
+
+                for (size_t k = 0; k < P; ++k) {
+                    if (!primOk[k] || !inBand[k][otherIdx] || primaries[k] == otherIdx) continue;
+                    const glm::dvec3 d = po - primPos[k * (size_t)steps + (size_t)s];
+                    const double d2 = d.x*d.x + d.y*d.y + d.z*d.z;
+                    if (d2 < bestD2[k]) {
+                        bestD2[k] = d2;
+                        bestS[k] = s;
+                    }
                 }
             }
+            if (!anyValid) continue;
 
-            tca = bestFineT;
-            miss = bestFineD;
-        }
+            for (size_t k = 0; k < P; ++k) {
+                if (bestD2[k] > thresh2) continue;
+
+                const double bestT = t0 + (double)bestS[k] * dt;
+                double tca = bestT;
+                double miss = std::sqrt(bestD2[k]);
+                if (p.refine) refineTca(sys, primaries[k], otherIdx, bestT, dt, tca, miss);
 
-        double relSpeed = 0.0;
-        {
-            const double eps = 1.0;
-            glm::dvec3 pta0, pta1, pob0, pob1;
-            if (sampleKmAt(sys, targetIdx, tca - eps, pta0) &&
-                sampleKmAt(sys, targetIdx, tca + eps, pta1) &&
-                sampleKmAt(sys, otherIdx,  tca - eps, pob0) &&
-                sampleKmAt(sys, otherIdx,  tca + eps, pob1))
-            {
-                glm::dvec3 vT = (pta1 - pta0) / (2.0 * eps); 
-                glm::dvec3 vO = (pob1 - pob0) / (2.0 * eps);
-                relSpeed = lengthKm(vO - vT);
+                Found f;
+                f.slot = k;
+                f.hit.otherIdx = (int)otherIdx;
+                f.hit.tcaSec = tca;
+                f.hit.missKm = miss;
+                f.hit.relSpeedKmS = relativeSpeedKmS(sys, primaries[k], otherIdx, tca);
+                found[w].push_back(f);
             }
         }
+    });
 
-        ConjunctionHit hit;
-        hit.otherIdx = (int)otherIdx;
-        hit.tcaSec = tca;
-        hit.missKm = miss;
-        hit.relSpeedKmS = relSpeed;
-        outHits.push_back(hit);
+    for (const auto& list : found)
+        for (const Found& f : list) outHits[f.slot].push_back(f.hit);
+
+    for (auto& hits : outHits) {
+        std::sort(hits.begin(), hits.end(), [](const ConjunctionHit& a, const ConjunctionHit& b){
+            return a.missKm < b.missKm;
+        });
     }
+    return true;
+}
 
-    std::sort(outHits.begin(), outHits.end(), [](const ConjunctionHit& a, const ConjunctionHit& b){
-        return a.missKm < b.missKm;
+void ConjunctionScreener::reset() {
+    m_primary = (size_t)-1;
+    m_primaryNorad = 0;
+    m_primaryKey = 0;
+    m_pairs.clear();
+    m_norad.clear();
+    m_keys.clear();
+    m_candidates.clear();
+    m_rescreen.clear();
+    m_hits.clear();
+}
+
+size_t ConjunctionScreener::checkCount(const Sgp4System& sys) const {
+    return std::min(sys.count(), (size_t)std::max(1, m_params.maxSatsToCheck));
+}
+
+bool ConjunctionScreener::update(const Sgp4System& sys, size_t primaryIdx, double nowSec, const ConjunctionParams& p, int maxSteps) {
+    m_lastSamples = 0;
+    if (primaryIdx >= sys.count()) {
+        const bool had = !m_hits.empty();
+        reset();
+        return had;
+    }
+
+    const double dt = std::max(1.0, p.stepSec);
+    const bool sameParams = active() && dt == m_dt && p.horizonSec == m_params.horizonSec &&
+                            p.thresholdKm == m_params.thresholdKm && p.maxSatsToCheck == m_params.maxSatsToCheck &&
+                            p.refine == m_params.refine && p.prefilter == m_params.prefilter &&
+                            p.secondaries == m_params.secondaries;
+    bool changed = false;
+
+    if (!sameParams || primaryIdx != m_primary || sys.elementsKey(primaryIdx) != m_primaryKey ||
+        nowSec < (double)m_firstStep * dt) {
+        changed = !m_hits.empty();
+        reset();
+
+        m_primary = primaryIdx;
+        m_primaryNorad = sys.noradId(primaryIdx);
+        m_primaryKey = sys.elementsKey(primaryIdx);
+        m_params = p;
+        m_dt = dt;
+        m_firstStep = m_nextStep = (int64_t)std::floor(nowSec / dt);
+
+        const size_t n = checkCount(sys);
+        m_pairs.assign(n, PairState{});
+        m_norad.resize(n);
+        m_keys.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            m_norad[i] = sys.noradId(i);
+            m_keys[i] = sys.elementsKey(i);
+        }
+        screeningCandidates(sys, p, primaryIdx, n, m_candidates);
+    } else if (nowSec > (double)m_nextStep * dt) {
+        // time ran past the screened span (big jump, or the budget fell behind):
+        // restart the scan at now, surviving events stay
+        m_nextStep = (int64_t)std::floor(nowSec / dt);
+        std::fill(m_pairs.begin(), m_pairs.end(), PairState{});
+    }
+
+    m_firstStep = std::max(m_firstStep, (int64_t)std::floor(nowSec / dt));
+    const auto expired = std::remove_if(m_hits.begin(), m_hits.end(), [&](const ConjunctionHit& h) { return h.tcaSec < nowSec; });
+    changed |= expired != m_hits.end();
+    m_hits.erase(expired, m_hits.end());
+
+    // a reload remapped or dropped events
+    changed |= m_remapped;
+    m_remapped = false;
+
+    if (!m_rescreen.empty()) {
+        changed |= screenSteps(sys, m_rescreen, m_firstStep, m_nextStep, true) > 0;
+        m_rescreen.clear();
+    }
+
+    m_windowEnd = nowSec + std::max(1.0, p.horizonSec);
+    const int64_t lastStep = (int64_t)std::ceil(m_windowEnd / dt);
+    const int64_t k1 = std::min(lastStep + 1, m_nextStep + (int64_t)std::max(1, maxSteps));
+    if (k1 > m_nextStep) {
+        changed |= screenSteps(sys, m_candidates, m_nextStep, k1, false) > 0;
+        m_nextStep = k1;
+    }
+
+    if (changed) {
+        std::sort(m_hits.begin(), m_hits.end(), [](const ConjunctionHit& a, const ConjunctionHit& b){
+            return a.missKm < b.missKm;
+        });
+    }
+    return changed;
+}
+
+// Returns the number of events added.
+size_t ConjunctionScreener::screenSteps(const Sgp4System& sys, const std::vector<size_t>& objects, int64_t k0, int64_t k1, bool freshState) {
+    if (k1 <= k0) return 0;
+
+    const size_t steps = (size_t)(k1 - k0);
+    std::vector<glm::dvec3> prim(steps);
+    std::vector<char> primOk(steps);
+    for (size_t s = 0; s < steps; ++s)
+        primOk[s] = sampleKmAt(sys, m_primary, (double)(k0 + (int64_t)s) * m_dt, prim[s]) ? 1 : 0;
+
+    const double thresh = std::max(0.1, m_params.thresholdKm);
+    const double thresh2 = thresh * thresh;
+    const size_t count = objects.size();
+
+    std::vector<std::vector<ConjunctionHit>> found(workerCount());
+    parallelFor(count, 64, [&](size_t begin, size_t end, unsigned w) {
+        for (size_t j = begin; j < end; ++j) {
+            const size_t o = objects[j];
+            if (o == m_primary || o >= m_pairs.size()) continue;
+
+            PairState& st = m_pairs[o];
+            if (freshState) st = PairState{};
+
+            for (size_t s = 0; s < steps; ++s) {
+                if (!primOk[s]) continue;
+                const double t = (double)(k0 + (int64_t)s) * m_dt;
+
+                glm::dvec3 po;
+                if (!sampleKmAt(sys, o, t, po)) continue;
+                const glm::dvec3 d = po - prim[s];
+                const double d2 = d.x*d.x + d.y*d.y + d.z*d.z;
+
+                // local minimum at the previous sample (a falling start counts too)
+                if (st.d2Prev >= 0.0 && st.d2Prev < d2 && st.d2Prev <= thresh2 &&
+                    (st.d2Prev2 < 0.0 || st.d2Prev <= st.d2Prev2)) {
+                    const double coarseT = t - m_dt;
+                    double tca = coarseT;
+                    double miss = std::sqrt(st.d2Prev);
+                    if (m_params.refine) refineTca(sys, m_primary, o, coarseT, m_dt, tca, miss);
+
+                    ConjunctionHit hit;
+                    hit.otherIdx = (int)o;
+                    hit.tcaSec = tca;
+                    hit.missKm = miss;
+                    hit.relSpeedKmS = relativeSpeedKmS(sys, m_primary, o, tca);
+                    found[w].push_back(hit);
+                }
+                st.d2Prev2 = st.d2Prev;
+                st.d2Prev = d2;
+            }
+        }
     });
 
-    return true;
+    size_t added = 0;
+    for (const auto& f : found) {
+        m_hits.insert(m_hits.end(), f.begin(), f.end());
+        added += f.size();
+    }
+    m_lastSamples += steps * (count + 1);
+    return added;
+}
+
+void ConjunctionScreener::onCatalogReload(const Sgp4System& sys) {
+    if (!active()) return;
+
+    size_t newPrimary = (size_t)-1;
+    for (size_t i = 0; i < sys.count(); ++i) {
+        if (sys.noradId(i) == m_primaryNorad) {
+            newPrimary = i;
+            break;
+        }
+    }
+    if (newPrimary == (size_t)-1 || sys.elementsKey(newPrimary) != m_primaryKey) {
+        // new primary elements invalidate every pair
+        reset();
+        m_remapped = true;
+        return;
+    }
+
+    std::unordered_map<unsigned, size_t> oldByNorad;
+    oldByNorad.reserve(m_norad.size());
+    for (size_t i = 0; i < m_norad.size(); ++i) oldByNorad.emplace(m_norad[i], i);
+
+    const size_t n = checkCount(sys);
+    std::vector<PairState> pairs(n);
+    std::vector<unsigned> norad(n);
+    std::vector<uint64_t> keys(n);
+    std::vector<size_t> remap(m_norad.size(), (size_t)-1);
+    m_rescreen.clear();
+
+    // the index was rebuilt for the new catalog
+    screeningCandidates(sys, m_params, newPrimary, n, m_candidates);
+    std::vector<char> isCandidate(n, 0);
+    for (size_t c : m_candidates) isCandidate[c] = 1;
+
+    for (size_t i = 0; i < n; ++i) {
+        norad[i] = sys.noradId(i);
+        keys[i] = sys.elementsKey(i);
+
+        auto it = oldByNorad.find(norad[i]);
+        if (it != oldByNorad.end() && m_keys[it->second] == keys[i]) {
+            pairs[i] = m_pairs[it->second];
+            remap[it->second] = i;
+        } else if (isCandidate[i]) {
+            m_rescreen.push_back(i);
+        }
+    }
+
+    std::vector<ConjunctionHit> kept;
+    for (ConjunctionHit h : m_hits) {
+        if (h.otherIdx < 0 || (size_t)h.otherIdx >= remap.size() || remap[(size_t)h.otherIdx] == (size_t)-1) continue;
+        h.otherIdx = (int)remap[(size_t)h.otherIdx];
+        kept.push_back(h);
+    }
+
+    // indices may have moved even when every event survived
+    m_remapped = true;
+    m_primary = newPrimary;
+    m_pairs.swap(pairs);
+    m_norad.swap(norad);
+    m_keys.swap(keys);
+    m_hits.swap(kept);
 }
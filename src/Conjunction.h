@@ -1,15 +1,24 @@
 #pragma once
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 
 #include <glm/glm.hpp>
 #include "Sgp4System.h"
 
+class ElementIndex;
+
 struct ConjunctionHit {
     int    otherIdx = -1;    
     double tcaSec   = 0.0;   
     double missKm   = 0.0;    
     double relSpeedKmS = 0.0; 
+
+    // filled by computeCollisionProbabilities; -1 = not evaluated
+    double pc = -1.0;
+    double pcMonteCarlo = -1.0;
+    double pcMcStdErr = 0.0;
 };
 
 struct ConjunctionParams {
@@ -18,8 +27,21 @@ struct ConjunctionParams {
     double thresholdKm  = 25.0;         
     int    maxSatsToCheck = 20000;      
     bool   refine = true;               
+
+    // perigee/apogee pre-filter: secondaries whose altitude band never comes
+    // near the primary's are skipped. Must be built from the same catalog.
+    const ElementIndex* prefilter = nullptr;
+
+    // sorted catalog indices the secondaries are drawn from; null = all
+    std::shared_ptr<const std::vector<uint32_t>> secondaries;
 };
 
+// Secondaries in [0, maxCheck) worth screening against primary, ascending:
+// the prefilter's altitude band (threshold plus padKm) intersected with
+// p.secondaries. May include the primary itself.
+void screeningCandidates(const Sgp4System& sys, const ConjunctionParams& p, size_t primary, size_t maxCheck,
+                         std::vector<size_t>& out, double padKm = 0.0);
+
 bool computeConjunctionsSelectedVsAll(
     const Sgp4System& sys,
     size_t targetIdx,
@@ -27,3 +49,70 @@ bool computeConjunctionsSelectedVsAll(
     const ConjunctionParams& p,
     std::vector<ConjunctionHit>& outHits
 );
+
+// Many primaries against the catalog in one pass: each secondary is propagated
+// once per step and compared with every primary, so the cost grows with the
+// catalog, not catalog x primaries. outHits[k] belongs to primaries[k]; a
+// primary that fails to propagate gets an empty list.
+bool computeConjunctionsWatchList(
+    const Sgp4System& sys,
+    const std::vector<size_t>& primaries,
+    double startSimSec,
+    const ConjunctionParams& p,
+    std::vector<std::vector<ConjunctionHit>>& outHits
+);
+
+// Continuous selected-vs-all screening over [now, now + horizon]. The coarse
+// grid sits on absolute multiples of stepSec and each pair keeps its last two
+// coarse samples, so advancing time only screens the newly exposed tail;
+// events whose TCA has passed are dropped. Changing the primary or the
+// parameters, or jumping outside the screened span, starts over.
+class ConjunctionScreener {
+public:
+    void reset();
+
+    // Screens at most maxSteps new grid steps per call. Returns true when the
+    // event list changed.
+    bool update(const Sgp4System& sys, size_t primaryIdx, double nowSec, const ConjunctionParams& p, int maxSteps = 32);
+
+    // Call after the catalog was reloaded into sys. Objects are matched by
+    // NORAD id; unchanged element sets keep their state and events, changed or
+    // new ones are re-screened over the covered span on the next update().
+    void onCatalogReload(const Sgp4System& sys);
+
+    const std::vector<ConjunctionHit>& hits() const { return m_hits; }
+
+    bool active() const { return m_primary != (size_t)-1; }
+    bool caughtUp() const { return active() && (double)m_nextStep * m_dt >= m_windowEnd; }
+    double coveredUntilSec() const { return (double)(m_nextStep - 1) * m_dt; }
+    size_t pendingRescreen() const { return m_rescreen.size(); }
+    size_t lastSamples() const { return m_lastSamples; }
+
+private:
+    // last two coarse d^2 samples; < 0 = none yet
+    struct PairState {
+        double d2Prev2 = -1.0;
+        double d2Prev = -1.0;
+    };
+
+    size_t m_primary = (size_t)-1;
+    unsigned m_primaryNorad = 0;
+    uint64_t m_primaryKey = 0;
+    ConjunctionParams m_params;
+    double m_dt = 0.0;
+    int64_t m_firstStep = 0;   // grid step at or before the window start
+    int64_t m_nextStep = 0;    // next grid step to sample
+    double m_windowEnd = 0.0;
+
+    std::vector<PairState> m_pairs;
+    std::vector<unsigned> m_norad;
+    std::vector<uint64_t> m_keys;
+    std::vector<size_t> m_candidates;
+    std::vector<size_t> m_rescreen;
+    std::vector<ConjunctionHit> m_hits;
+    size_t m_lastSamples = 0;
+    bool m_remapped = false;
+
+    size_t checkCount(const Sgp4System& sys) const;
+    size_t screenSteps(const Sgp4System& sys, const std::vector<size_t>& objects, int64_t k0, int64_t k1, bool freshState);
+};
@@ -0,0 +1,261 @@
+#include "Coverage.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "Ephemeris.h"
+#include "Parallel.h"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+
+static double deg2rad(double d) { return d * PI / 180.0; }
+
+namespace {
+
+struct Footprint {
+    float lat = 0.0f;     // rad
+    float lon = 0.0f;     // rad, Earth-fixed, [-pi, pi)
+    float lambda = 0.0f;  // Earth central half-angle of the visibility circle
+    bool valid = false;
+};
+
+struct CellStats {
+    uint32_t sum = 0;
+    uint32_t covered = 0;
+    int32_t lastCovered = -1;  // step index of the latest covered sample
+    uint32_t maxGapSteps = 0;
+    uint16_t maxCount = 0;
+};
+
+}
+
+bool computeCoverage(
+    const Sgp4System& sys,
+    const std::vector<size_t>& subset,
+    const std::chrono::system_clock::time_point& startUtcTP,
+    double t0Sec,
+    const CoverageParams& p,
+    CoverageGrid& out)
+{
+    out = CoverageGrid{};
+    if (subset.empty()) return false;
+    const auto clock0 = std::chrono::steady_clock::now();
+
+    const double latStep = std::clamp(p.latStepDeg, 0.1, 30.0);
+    const double lonStep = std::clamp(p.lonStepDeg, 0.1, 30.0);
+    const int nLat = std::max(1, (int)std::lround(180.0 / latStep));
+    const int nLon = std::max(1, (int)std::lround(360.0 / lonStep));
+    const double dLat = PI / (double)nLat;
+    const double dLon = 2.0 * PI / (double)nLon;
+
+    const double dt = std::max(1.0, p.stepSec);
+    const int steps = (int)std::floor(std::max(0.0, p.durationSec) / dt) + 1;
+    const double minEl = deg2rad(std::clamp(p.minElDeg, 0.0, 89.0));
+
+    const size_t M = subset.size();
+    const size_t cells = (size_t)nLat * (size_t)nLon;
+    std::vector<CellStats> stats(cells);
+
+    // time blocks bound memory: footprints are kept for one block only
+    const int block = 32;
+    std::vector<Footprint> fp((size_t)block * M);
+    std::vector<double> gmst((size_t)block);
+
+    // per step: sats bucketed by the latitude rows their footprint touches
+    std::vector<std::vector<uint32_t>> rowStart((size_t)block);
+    std::vector<std::vector<uint32_t>> rowSats((size_t)block);
+
+    for (int s0 = 0; s0 < steps; s0 += block) {
+        const int nb = std::min(block, steps - s0);
+
+        for (int b = 0; b < nb; ++b) {
+            const double t = t0Sec + dt * (double)(s0 + b);
+            gmst[(size_t)b] = gmstRadians_FromUTC(
+                startUtcTP + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                 std::chrono::duration<double>(t)));
+        }
+
+        parallelFor(M, 64, [&](size_t begin, size_t end, unsigned) {
+            for (size_t j = begin; j < end; ++j) {
+                for (int b = 0; b < nb; ++b) {
+                    Footprint& f = fp[(size_t)b * M + j];
+                    glm::dvec3 r;
+                    f.valid = sys.sampleKm(subset[j], t0Sec + dt * (double)(s0 + b), r);
+                    if (!f.valid) continue;
+
+                    const double rn = glm::length(r);
+                    if (rn <= EARTH_RADIUS_KM) { f.valid = false; continue; }
+
+                    double lon = std::atan2(r.y, r.x) - gmst[(size_t)b];
+                    lon = std::fmod(lon + PI, 2.0 * PI);
+                    if (lon < 0.0) lon += 2.0 * PI;
+
+                    f.lat = (float)std::asin(r.z / rn);
+                    f.lon = (float)(lon - PI);
+                    f.lambda = (float)(std::acos(EARTH_RADIUS_KM / rn * std::cos(minEl)) - minEl);
+                }
+            }
+        });
+
+        parallelFor((size_t)nb, 1, [&](size_t begin, size_t end, unsigned) {
+            for (size_t b = begin; b < end; ++b) {
+                auto& start = rowStart[b];
+                auto& list = rowSats[b];
+                start.assign((size_t)nLat + 1, 0);
+
+                auto rowRange = [&](const Footprint& f, int& r0, int& r1) {
+                    r0 = std::max(0, (int)std::floor((f.lat - f.lambda + PI * 0.5) / dLat));
+                    r1 = std::min(nLat - 1, (int)std::floor((f.lat + f.lambda + PI * 0.5) / dLat));
+                };
+
+                for (size_t j = 0; j < M; ++j) {
+                    const Footprint& f = fp[b * M + j];
+                    if (!f.valid) continue;
+                    int r0, r1;
+                    rowRange(f, r0, r1);
+                    for (int r = r0; r <= r1; ++r) start[(size_t)r + 1]++;
+                }
+                for (int r = 0; r < nLat; ++r) start[(size_t)r + 1] += start[(size_t)r];
+
+                list.resize(start[(size_t)nLat]);
+                std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+                for (size_t j = 0; j < M; ++j) {
+                    const Footprint& f = fp[b * M + j];
+                    if (!f.valid) continue;
+                    int r0, r1;
+                    rowRange(f, r0, r1);
+                    for (int r = r0; r <= r1; ++r) list[fill[(size_t)r]++] = (uint32_t)j;
+                }
+            }
+        });
+
+        parallelFor((size_t)nLat, 1, [&](size_t begin, size_t end, unsigned) {
+            std::vector<uint16_t> cnt((size_t)nLon);
+
+            for (size_t r = begin; r < end; ++r) {
+                const double lat = -0.5 * PI + ((double)r + 0.5) * dLat;
+                const double sLat = std::sin(lat), cLat = std::cos(lat);
+                CellStats* row = stats.data() + r * (size_t)nLon;
+
+                for (int b = 0; b < nb; ++b) {
+                    const int32_t step = s0 + b;
+                    std::fill(cnt.begin(), cnt.end(), 0);
+
+                    const auto& start = rowStart[(size_t)b];
+                    const auto& list = rowSats[(size_t)b];
+                    for (uint32_t k = start[r]; k < start[r + 1]; ++k) {
+                        const Footprint& f = fp[(size_t)b * M + list[k]];
+
+                        // half-width in longitude of the visibility circle on this row
+                        const double den = cLat * std::cos((double)f.lat);
+                        const double num = std::cos((double)f.lambda) - sLat * std::sin((double)f.lat);
+                        int c0 = 0, c1 = nLon - 1;
+                        if (den > 1e-9) {
+                            const double cosDl = num / den;
+                            if (cosDl >= 1.0) continue;
+                            if (cosDl > -1.0) {
+                                const double dl = std::acos(cosDl);
+                                c0 = (int)std::ceil(((double)f.lon - dl + PI) / dLon - 0.5);
+                                c1 = (int)std::floor(((double)f.lon + dl + PI) / dLon - 0.5);
+                                if (c1 - c0 + 1 >= nLon) { c0 = 0; c1 = nLon - 1; }
+                            }
+                        } else if (num < 0.0) {
+                            continue;
+                        }
+
+                        for (int c = c0; c <= c1; ++c) {
+                            int cc = c % nLon;
+                            if (cc < 0) cc += nLon;
+                            if (cnt[(size_t)cc] < 0xFFFF) cnt[(size_t)cc]++;
+                        }
+                    }
+
+                    for (int c = 0; c < nLon; ++c) {
+                        CellStats& cs = row[c];
+                        const uint16_t n = cnt[(size_t)c];
+                        cs.sum += n;
+                        cs.maxCount = std::max(cs.maxCount, n);
+                        if (n > 0) {
+                            // k missed samples between two covered ones span (k+1) steps;
+                            // a gap open at the window start is measured from t0
+                            const int32_t gap = cs.lastCovered < 0 ? step : step - cs.lastCovered;
+                            if (gap > 1 || (cs.lastCovered < 0 && gap > 0))
+                                cs.maxGapSteps = std::max(cs.maxGapSteps, (uint32_t)gap);
+                            cs.covered++;
+                            cs.lastCovered = step;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    out.nLat = nLat;
+    out.nLon = nLon;
+    out.latStepDeg = 180.0 / (double)nLat;
+    out.lonStepDeg = 360.0 / (double)nLon;
+    out.t0Sec = t0Sec;
+    out.durationSec = dt * (double)(steps - 1);
+    out.satCount = (int)M;
+
+    out.meanCount.resize(cells);
+    out.maxCount.resize(cells);
+    out.pctCovered.resize(cells);
+    out.maxGapSec.resize(cells);
+    for (size_t i = 0; i < cells; ++i) {
+        const CellStats& cs = stats[i];
+        // a gap still open at the window end is measured up to the last sample
+        uint32_t gapSteps = cs.maxGapSteps;
+        if (cs.lastCovered < steps - 1)
+            gapSteps = std::max(gapSteps, (uint32_t)(steps - 1 - std::max(cs.lastCovered, 0)));
+        out.meanCount[i] = (float)cs.sum / (float)steps;
+        out.maxCount[i] = cs.maxCount;
+        out.pctCovered[i] = 100.0f * (float)cs.covered / (float)steps;
+        out.maxGapSec[i] = (float)((double)gapSteps * dt);
+    }
+    out.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - clock0).count();
+    return true;
+}
+
+bool CoverageGrid::exportCsv(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f.is_open()) return false;
+
+    f << "lat_deg,lon_deg,mean_count,max_count,pct_covered,max_gap_sec\n";
+    for (int r = 0; r < nLat; ++r) {
+        for (int c = 0; c < nLon; ++c) {
+            const size_t i = (size_t)r * (size_t)nLon + (size_t)c;
+            f << cellLatDeg(r) << "," << cellLonDeg(c) << ","
+              << meanCount[i] << "," << maxCount[i] << ","
+              << pctCovered[i] << "," << maxGapSec[i] << "\n";
+        }
+    }
+    return (bool)f;
+}
+
+bool CoverageGrid::exportRaster(const std::string& path) const {
+    std::ofstream f(path, std::ios::binary);
+    if (!f.is_open()) return false;
+
+    const char magic[4] = {'C', 'O', 'V', 'G'};
+    const uint32_t version = 1;
+    const int32_t nl = nLat, nc = nLon;
+    const float ls = (float)latStepDeg, cs = (float)lonStepDeg;
+
+    f.write(magic, 4);
+    f.write((const char*)&version, sizeof(version));
+    f.write((const char*)&nl, sizeof(nl));
+    f.write((const char*)&nc, sizeof(nc));
+    f.write((const char*)&ls, sizeof(ls));
+    f.write((const char*)&cs, sizeof(cs));
+    f.write((const char*)&t0Sec, sizeof(t0Sec));
+    f.write((const char*)&durationSec, sizeof(durationSec));
+
+    const std::streamsize bytes = (std::streamsize)(meanCount.size() * sizeof(float));
+    std::vector<float> maxF(maxCount.begin(), maxCount.end());
+    f.write((const char*)meanCount.data(), bytes);
+    f.write((const char*)maxF.data(), bytes);
+    f.write((const char*)pctCovered.data(), bytes);
+    f.write((const char*)maxGapSec.data(), bytes);
+    return (bool)f;
+}
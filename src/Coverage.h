@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+class Sgp4System;
+
+struct CoverageParams {
+    double latStepDeg = 2.0;
+    double lonStepDeg = 2.0;
+    double durationSec = 86400.0;
+    double stepSec = 60.0;
+    double minElDeg = 10.0;
+};
+
+// Cell (r, c) is centred on lat = -90 + (r + 0.5) * latStep,
+// lon = -180 + (c + 0.5) * lonStep; planes are row-major, south first.
+struct CoverageGrid {
+    int nLat = 0;
+    int nLon = 0;
+    double latStepDeg = 0.0;
+    double lonStepDeg = 0.0;
+    double t0Sec = 0.0;
+    double durationSec = 0.0;
+    int satCount = 0;
+    double ms = 0.0;
+
+    std::vector<float> meanCount;   // time-averaged sats in view
+    std::vector<uint16_t> maxCount; // peak sats in view
+    std::vector<float> pctCovered;  // % of samples with >= 1 sat in view
+    std::vector<float> maxGapSec;   // longest time between covered samples (clipped to the window)
+
+    double cellLatDeg(int r) const { return -90.0 + ((double)r + 0.5) * latStepDeg; }
+    double cellLonDeg(int c) const { return -180.0 + ((double)c + 0.5) * lonStepDeg; }
+
+    bool exportCsv(const std::string& path) const;
+
+    // "COVG", u32 version, i32 nLat, i32 nLon, f32 latStep, f32 lonStep,
+    // f64 t0, f64 duration, then f32 planes: mean, max, pct, maxGap.
+    bool exportRaster(const std::string& path) const;
+};
+
+bool computeCoverage(
+    const Sgp4System& sys,
+    const std::vector<size_t>& subset,
+    const std::chrono::system_clock::time_point& startUtcTP,
+    double t0Sec,
+    const CoverageParams& p,
+    CoverageGrid& out
+);
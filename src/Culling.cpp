@@ -0,0 +1,68 @@
+#include "Culling.h"
+
+#include <cmath>
+
+Frustum Frustum::fromMatrix(const glm::mat4& VP) {
+    // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&](int i) { return glm::vec4(VP[0][i], VP[1][i], VP[2][i], VP[3][i]); };
+    const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+    Frustum f;
+    f.planes[0] = r3 + r0; // left
+    f.planes[1] = r3 - r0; // right
+    f.planes[2] = r3 + r1; // bottom
+    f.planes[3] = r3 - r1; // top
+    f.planes[4] = r3 + r2; // near
+    f.planes[5] = r3 - r2; // far
+
+    for (glm::vec4& p : f.planes) {
+        const float len = glm::length(glm::vec3(p));
+        if (len > 1e-12f) p /= len;
+    }
+    return f;
+}
+
+bool Frustum::containsPoint(const glm::vec3& p, float margin) const {
+    for (const glm::vec4& pl : planes)
+        if (glm::dot(glm::vec3(pl), p) + pl.w < -margin) return false;
+    return true;
+}
+
+bool sphereOccludes(const glm::vec3& eye, const glm::vec3& p, float radius) {
+    const glm::vec3 d = p - eye;
+    const float a = glm::dot(d, d);
+    if (a < 1e-12f) return false;
+
+    const float b = glm::dot(eye, d);
+    const float c = glm::dot(eye, eye) - radius * radius;
+    const float disc = b * b - a * c;
+    if (disc <= 0.0f) return false;
+
+    const float t = (-b - std::sqrt(disc)) / a;
+    return t > 0.0f && t < 1.0f;
+}
+
+PointCuller::PointCuller(const glm::mat4& VP, const glm::vec3& eyePos, float earthRadius, float marginWorld)
+    : frustum(Frustum::fromMatrix(VP)), eye(eyePos), occluderRadius(earthRadius), margin(marginWorld) {}
+
+CullResult PointCuller::test(const glm::vec3& p) const {
+    if (!frustum.containsPoint(p, margin)) return CullResult::OutsideFrustum;
+    if (sphereOccludes(eye, p, occluderRadius)) return CullResult::Occluded;
+    return CullResult::Visible;
+}
+
+void CullStats::add(CullResult r) {
+    tested++;
+    switch (r) {
+        case CullResult::Visible: visible++; break;
+        case CullResult::OutsideFrustum: outsideFrustum++; break;
+        case CullResult::Occluded: occluded++; break;
+    }
+}
+
+void CullStats::merge(const CullStats& o) {
+    tested += o.tested;
+    visible += o.visible;
+    outsideFrustum += o.outsideFrustum;
+    occluded += o.occluded;
+}
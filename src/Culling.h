@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// View-frustum planes pulled from a view-projection matrix
+// (Gribb/Hartmann). Normals point inward and are unit length.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4& VP);
+
+    // margin grows the frustum so points whose sprite straddles an edge survive
+    bool containsPoint(const glm::vec3& p, float margin = 0.0f) const;
+};
+
+// True if the segment eye -> p enters the sphere (centred at origin) before p.
+bool sphereOccludes(const glm::vec3& eye, const glm::vec3& p, float radius);
+
+enum class CullResult : uint8_t { Visible, OutsideFrustum, Occluded };
+
+struct PointCuller {
+    Frustum frustum{};
+    glm::vec3 eye{0.0f};
+    float occluderRadius = 1.0f;
+    float margin = 0.0f;
+
+    PointCuller() = default;
+    PointCuller(const glm::mat4& VP, const glm::vec3& eyePos, float earthRadius, float marginWorld = 0.0f);
+
+    CullResult test(const glm::vec3& p) const;
+};
+
+struct CullStats {
+    size_t tested = 0;
+    size_t visible = 0;
+    size_t outsideFrustum = 0;
+    size_t occluded = 0;
+
+    void add(CullResult r);
+    void merge(const CullStats& o);
+};
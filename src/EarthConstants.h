@@ -0,0 +1,18 @@
+#pragma once
+
+// Constants shared by everything that models the Earth or an orbit
+// physically: WGS-84 size, gravity and rotation, EGM96 zonal terms.
+// MeanElements keeps the WGS-72 set SGP4 mean elements are defined in.
+
+inline constexpr double PI = 3.14159265358979323846;
+
+inline constexpr double MU_KM3_S2 = 398600.4418;
+inline constexpr double EARTH_RADIUS_KM = 6378.137;
+inline constexpr double EARTH_ROT_RAD_S = 7.2921158553e-5;
+
+// unnormalized zonal coefficients (EGM96), index = degree
+inline constexpr double ZONAL_J[7] = {0.0, 0.0, 1.08262668e-3, -2.53265649e-6, -1.61962159e-6, -2.27296083e-7, 5.40681239e-7};
+inline constexpr double J2 = ZONAL_J[2];
+
+// SGP4's reference density for B*, kg / m^2 / earth radius
+inline constexpr double BSTAR_RHO0 = 0.15696615;
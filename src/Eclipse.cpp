@@ -0,0 +1,207 @@
+#include "Eclipse.h"
+#include "EarthConstants.h"
+#include "Ephemeris.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+
+ShadowGeometry shadowGeometry(const glm::dvec3& satKm, const glm::dvec3& sunKm) {
+    ShadowGeometry g;
+
+    const glm::dvec3 toSun = sunKm - satKm;
+    const double rSat = glm::length(satKm);
+    const double rSun = glm::length(toSun);
+    if (rSat < 1e-9 || rSun < 1e-9) {
+        g.c = PI;
+        return g;
+    }
+
+    g.a = std::asin(std::min(1.0, SUN_RADIUS_KM / rSun));
+    g.b = std::asin(std::min(1.0, EARTH_RADIUS_KM / rSat));
+
+    const double cosC = -glm::dot(satKm, toSun) / (rSat * rSun);
+    g.c = std::acos(std::clamp(cosC, -1.0, 1.0));
+    return g;
+}
+
+ShadowState shadowState(const ShadowGeometry& g) {
+    if (penumbraFunction(g) >= 0.0) return ShadowState::Sunlit;
+    if (umbraFunction(g) < 0.0) return ShadowState::Umbra;
+    return ShadowState::Penumbra;
+}
+
+double illuminatedFraction(const ShadowGeometry& g) {
+    const double a = g.a, b = g.b, c = g.c;
+
+    if (c >= a + b) return 1.0;
+    if (c < b - a) return 0.0;
+    if (a < 1e-12) return 0.0;
+
+    // Earth disc entirely inside the solar disc (annular)
+    if (c < a - b) return 1.0 - (b * b) / (a * a);
+
+    const double x = (c * c + a * a - b * b) / (2.0 * c);
+    const double y = std::sqrt(std::max(0.0, a * a - x * x));
+    const double A =
+        a * a * std::acos(std::clamp(x / a, -1.0, 1.0)) +
+        b * b * std::acos(std::clamp((c - x) / b, -1.0, 1.0)) -
+        c * y;
+
+    return std::clamp(1.0 - A / (PI * a * a), 0.0, 1.0);
+}
+
+double refineShadowBoundarySec(
+    const Sgp4System& sys,
+    size_t satIdx,
+    const Ephemeris& eph,
+    double a,
+    double b,
+    bool umbra
+) {
+    auto f = [&](double t, double& out) -> bool {
+        glm::dvec3 p;
+        if (!sys.sampleKm(satIdx, t, p)) return false;
+        const ShadowGeometry g = shadowGeometry(p, eph.sunPosKm(t));
+        out = umbra ? umbraFunction(g) : penumbraFunction(g);
+        return true;
+    };
+
+    double fa = 0.0, fb = 0.0;
+    if (!f(a, fa) || !f(b, fb)) return 0.5 * (a + b);
+    if (fa * fb > 0.0) return 0.5 * (a + b);
+
+    while (b - a > 0.05) {
+        double m = 0.5 * (a + b);
+        double fm = 0.0;
+        if (!f(m, fm)) break;
+
+        if (fa * fm <= 0.0) { b = m; fb = fm; }
+        else { a = m; fa = fm; }
+    }
+    return 0.5 * (a + b);
+}
+
+void EclipseTable::clear() {
+    m_t0Sec = m_t1Sec = 0.0;
+    m_initial.clear();
+    m_offsets.clear();
+    m_events.clear();
+}
+
+void EclipseTable::build(const Sgp4System& sys, const Ephemeris& eph, double t0Sec, const EclipseParams& p) {
+    clear();
+    m_params = p;
+    const size_t N = sys.count();
+    if (N == 0) return;
+
+    const double dt = std::max(1.0, p.stepSec);
+    const int steps = (int)std::ceil(std::max(dt, p.horizonSec) / dt) + 1;
+
+    m_t0Sec = t0Sec;
+    m_t1Sec = t0Sec + dt * (double)(steps - 1);
+
+    std::vector<glm::dvec3> sun((size_t)steps);
+    for (int k = 0; k < steps; ++k)
+        sun[(size_t)k] = eph.sunPosKm(t0Sec + dt * (double)k);
+
+    m_initial.assign(N, ShadowState::Sunlit);
+    std::vector<std::vector<EclipseEvent>> perSat(N);
+
+    parallelFor(N, 64, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            auto& ev = perSat[i];
+
+            double tPrev = t0Sec;
+            double penPrev = 0.0, umbPrev = 0.0;
+            bool have = false;
+
+            for (int k = 0; k < steps; ++k) {
+                const double t = t0Sec + dt * (double)k;
+                glm::dvec3 pos;
+                if (!sys.sampleKm(i, t, pos)) break;
+
+                const ShadowGeometry g = shadowGeometry(pos, sun[(size_t)k]);
+                const double pen = penumbraFunction(g);
+                const double umb = umbraFunction(g);
+
+                if (!have) {
+                    m_initial[i] = shadowState(g);
+                    have = true;
+                } else {
+                    // both boundaries can be crossed inside one coarse step
+                    double tPen = -1.0, tUmb = -1.0;
+                    if ((pen < 0.0) != (penPrev < 0.0)) tPen = refineShadowBoundarySec(sys, i, eph, tPrev, t, false);
+                    if ((umb < 0.0) != (umbPrev < 0.0)) tUmb = refineShadowBoundarySec(sys, i, eph, tPrev, t, true);
+
+                    auto push = [&](double tc, ShadowState s) {
+                        ev.push_back(EclipseEvent{(float)(tc - t0Sec), s});
+                    };
+                    auto penState = [](bool inPen, bool inUmb) {
+                        return inUmb ? ShadowState::Umbra : (inPen ? ShadowState::Penumbra : ShadowState::Sunlit);
+                    };
+
+                    if (tPen >= 0.0 && tUmb >= 0.0) {
+                        if (tPen <= tUmb) {
+                            push(tPen, penState(pen < 0.0, umbPrev < 0.0));
+                            push(tUmb, penState(pen < 0.0, umb < 0.0));
+                        } else {
+                            push(tUmb, penState(penPrev < 0.0, umb < 0.0));
+                            push(tPen, penState(pen < 0.0, umb < 0.0));
+                        }
+                    } else if (tPen >= 0.0) {
+                        push(tPen, penState(pen < 0.0, umb < 0.0));
+                    } else if (tUmb >= 0.0) {
+                        push(tUmb, penState(pen < 0.0, umb < 0.0));
+                    }
+                }
+
+                tPrev = t;
+                penPrev = pen;
+                umbPrev = umb;
+            }
+        }
+    });
+
+    m_offsets.resize(N + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < N; ++i) {
+        m_offsets[i] = (uint32_t)total;
+        total += perSat[i].size();
+    }
+    m_offsets[N] = (uint32_t)total;
+
+    m_events.reserve(total);
+    for (auto& v : perSat)
+        m_events.insert(m_events.end(), v.begin(), v.end());
+}
+
+ShadowState EclipseTable::stateAt(size_t idx, double tSec) const {
+    if (idx >= m_initial.size()) return ShadowState::Sunlit;
+
+    const float dt = (float)(tSec - m_t0Sec);
+    const EclipseEvent* b = eventsBegin(idx);
+    const EclipseEvent* e = eventsEnd(idx);
+    const EclipseEvent* it = std::upper_bound(b, e, dt, [](float v, const EclipseEvent& ev) {
+        return v < ev.dtSec;
+    });
+    return (it == b) ? m_initial[idx] : (it - 1)->state;
+}
+
+bool EclipseTable::exportCsv(const std::string& path, const Sgp4System& sys) const {
+    std::ofstream f(path);
+    if (!f.is_open()) return false;
+
+    static const char* kStateNames[] = {"sunlit", "penumbra", "umbra"};
+
+    f << "name,t_sec,state\n";
+    const size_t N = std::min(objectCount(), sys.count());
+    for (size_t i = 0; i < N; ++i) {
+        f << sys.name(i) << "," << m_t0Sec << "," << kStateNames[(int)m_initial[i]] << "\n";
+        for (const EclipseEvent* e = eventsBegin(i); e != eventsEnd(i); ++e)
+            f << sys.name(i) << "," << (m_t0Sec + (double)e->dtSec) << "," << kStateNames[(int)e->state] << "\n";
+    }
+    return (bool)f;
+}
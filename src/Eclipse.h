@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+
+class Sgp4System;
+class Ephemeris;
+
+enum class ShadowState : uint8_t {
+    Sunlit = 0,
+    Penumbra = 1,
+    Umbra = 2
+};
+
+// Conical shadow: apparent Sun radius a, Earth radius b and their angular
+// separation c as seen from the satellite (Montenbruck & Gill 3.4).
+struct ShadowGeometry {
+    double a = 0.0;
+    double b = 0.0;
+    double c = 0.0;
+};
+
+ShadowGeometry shadowGeometry(const glm::dvec3& satKm, const glm::dvec3& sunKm);
+
+// > 0 outside the penumbra cone, < 0 inside it.
+inline double penumbraFunction(const ShadowGeometry& g) { return g.c - (g.a + g.b); }
+// > 0 outside the umbra cone, < 0 inside it.
+inline double umbraFunction(const ShadowGeometry& g) { return g.c - (g.b - g.a); }
+
+ShadowState shadowState(const ShadowGeometry& g);
+double illuminatedFraction(const ShadowGeometry& g);
+
+// Bisects the penumbra (umbra = false) or umbra boundary between a and b.
+// Returns the midpoint when there is no sign change or the sat cannot be sampled.
+double refineShadowBoundarySec(
+    const Sgp4System& sys,
+    size_t satIdx,
+    const Ephemeris& eph,
+    double a,
+    double b,
+    bool umbra
+);
+
+struct EclipseEvent {
+    float dtSec = 0.0f;                     // offset from EclipseTable::t0Sec()
+    ShadowState state = ShadowState::Sunlit; // state entered at dtSec
+};
+
+struct EclipseParams {
+    double horizonSec = 6.0 * 3600.0;
+    double stepSec = 60.0;
+};
+
+// Umbra/penumbra transitions for every object over [t0, t0 + horizon],
+// stored CSR-style: events of object i are m_events[m_offsets[i] .. m_offsets[i+1]).
+class EclipseTable {
+public:
+    void build(const Sgp4System& sys, const Ephemeris& eph, double t0Sec, const EclipseParams& p);
+    void clear();
+
+    size_t objectCount() const { return m_initial.size(); }
+    size_t eventCount() const { return m_events.size(); }
+
+    double t0Sec() const { return m_t0Sec; }
+    double t1Sec() const { return m_t1Sec; }
+    // parameters of the last build; a table from other settings is stale
+    bool builtWith(const EclipseParams& p) const {
+        return m_params.horizonSec == p.horizonSec && m_params.stepSec == p.stepSec;
+    }
+    bool covers(double tSec) const { return !m_initial.empty() && tSec >= m_t0Sec && tSec <= m_t1Sec; }
+
+    ShadowState stateAt(size_t idx, double tSec) const;
+
+    // name,t_sec,state rows; t_sec in absolute sim seconds
+    bool exportCsv(const std::string& path, const Sgp4System& sys) const;
+
+    const EclipseEvent* eventsBegin(size_t idx) const { return m_events.data() + m_offsets[idx]; }
+    const EclipseEvent* eventsEnd(size_t idx) const { return m_events.data() + m_offsets[idx + 1]; }
+
+private:
+    double m_t0Sec = 0.0;
+    double m_t1Sec = 0.0;
+    EclipseParams m_params;
+    std::vector<ShadowState> m_initial;
+    std::vector<uint32_t> m_offsets;
+    std::vector<EclipseEvent> m_events;
+};
@@ -0,0 +1,194 @@
+#include "ElementIndex.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+static constexpr double SUN_MEAN_MOTION_DEG_DAY = 360.0 / 365.2421897;
+
+IndexBitset::IndexBitset(size_t n, bool value)
+    : m_n(n), m_words((n + 63) / 64, value ? ~0ull : 0ull) {
+    // keep the bits past n clear so count() and indices() stay exact
+    if (value && (n & 63)) m_words.back() = (1ull << (n & 63)) - 1;
+}
+
+size_t IndexBitset::count() const {
+    size_t c = 0;
+    for (uint64_t w : m_words) {
+        while (w) {
+            w &= w - 1;
+            c++;
+        }
+    }
+    return c;
+}
+
+IndexBitset& IndexBitset::operator&=(const IndexBitset& o) {
+    for (size_t i = 0; i < m_words.size(); i++)
+        m_words[i] &= (i < o.m_words.size()) ? o.m_words[i] : 0ull;
+    return *this;
+}
+
+IndexBitset& IndexBitset::operator|=(const IndexBitset& o) {
+    for (size_t i = 0; i < m_words.size() && i < o.m_words.size(); i++)
+        m_words[i] |= o.m_words[i];
+    return *this;
+}
+
+IndexBitset& IndexBitset::flip() {
+    for (uint64_t& w : m_words) w = ~w;
+    if (m_n & 63) m_words.back() &= (1ull << (m_n & 63)) - 1;
+    return *this;
+}
+
+void IndexBitset::indices(std::vector<uint32_t>& out, size_t maxCount) const {
+    out.clear();
+    for (size_t wi = 0; wi < m_words.size() && out.size() < maxCount; wi++) {
+        uint64_t w = m_words[wi];
+        while (w && out.size() < maxCount) {
+            unsigned bit = 0;
+            while (!((w >> bit) & 1ull)) bit++;
+            out.push_back((uint32_t)(wi * 64 + bit));
+            w &= w - 1;
+        }
+    }
+}
+
+void ElementIndex::build(const Sgp4System& sys) {
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t n = sys.count();
+    m_shapes.assign(n, OrbitShape{});
+
+    for (size_t i = 0; i < n; i++) {
+        const Sgp4System::CatalogElements el = sys.catalogElements(i);
+        OrbitShape& s = m_shapes[i];
+        s.inclinationDeg = (float)el.inclinationDeg;
+        s.raanDeg = (float)el.raanDeg;
+        s.eccentricity = (float)el.eccentricity;
+
+        const double nRadS = el.meanMotionRevDay * 2.0 * PI / 86400.0;
+        if (nRadS <= 1e-12) continue;
+
+        const double a = std::cbrt(MU_KM3_S2 / (nRadS * nRadS));
+        const double e = std::clamp(el.eccentricity, 0.0, 0.999);
+        s.perigeeKm = (float)(a * (1.0 - e) - EARTH_RADIUS_KM);
+        s.apogeeKm = (float)(a * (1.0 + e) - EARTH_RADIUS_KM);
+
+        const double p = a * (1.0 - e * e);
+        const double rate = -1.5 * nRadS * J2 * (EARTH_RADIUS_KM / p) * (EARTH_RADIUS_KM / p) * std::cos(el.inclinationDeg * PI / 180.0);
+        s.nodalRateDegDay = (float)(rate * 86400.0 * 180.0 / PI);
+    }
+
+    m_ivIdx.resize(n);
+    std::iota(m_ivIdx.begin(), m_ivIdx.end(), 0u);
+    std::sort(m_ivIdx.begin(), m_ivIdx.end(), [&](uint32_t a, uint32_t b) {
+        return m_shapes[a].perigeeKm < m_shapes[b].perigeeKm;
+    });
+    m_lo.resize(n);
+    m_hi.resize(n);
+    m_maxHi.assign(n, 0.0f);
+    for (size_t k = 0; k < n; k++) {
+        m_lo[k] = m_shapes[m_ivIdx[k]].perigeeKm;
+        m_hi[k] = m_shapes[m_ivIdx[k]].apogeeKm;
+    }
+    buildMaxHi(0, n);
+
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; i++) v[i] = m_shapes[i].inclinationDeg;
+    buildSorted(m_inc, v);
+    for (size_t i = 0; i < n; i++) v[i] = m_shapes[i].raanDeg;
+    buildSorted(m_raan, v);
+    for (size_t i = 0; i < n; i++) v[i] = m_shapes[i].eccentricity;
+    buildSorted(m_ecc, v);
+    for (size_t i = 0; i < n; i++) v[i] = m_shapes[i].nodalRateDegDay;
+    buildSorted(m_rate, v);
+
+    m_buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+float ElementIndex::buildMaxHi(size_t b, size_t e) {
+    if (b >= e) return -1e30f;
+    const size_t mid = b + (e - b) / 2;
+    m_maxHi[mid] = std::max({m_hi[mid], buildMaxHi(b, mid), buildMaxHi(mid + 1, e)});
+    return m_maxHi[mid];
+}
+
+void ElementIndex::overlapQuery(size_t b, size_t e, float lo, float hi, IndexBitset& out) const {
+    if (b >= e) return;
+    const size_t mid = b + (e - b) / 2;
+    // nothing below reaches up to lo
+    if (m_maxHi[mid] < lo) return;
+
+    overlapQuery(b, mid, lo, hi, out);
+    if (m_lo[mid] > hi) return; // everything to the right starts even higher
+    if (m_hi[mid] >= lo) out.set(m_ivIdx[mid]);
+    overlapQuery(mid + 1, e, lo, hi, out);
+}
+
+void ElementIndex::buildSorted(SortedKey& s, const std::vector<float>& values) {
+    s.idx.resize(values.size());
+    std::iota(s.idx.begin(), s.idx.end(), 0u);
+    std::sort(s.idx.begin(), s.idx.end(), [&](uint32_t a, uint32_t b) { return values[a] < values[b]; });
+    s.key.resize(values.size());
+    for (size_t k = 0; k < values.size(); k++) s.key[k] = values[s.idx[k]];
+}
+
+void ElementIndex::rangeQuery(const SortedKey& s, double lo, double hi, IndexBitset& out) {
+    const auto b = std::lower_bound(s.key.begin(), s.key.end(), (float)lo);
+    const auto e = std::upper_bound(b, s.key.end(), (float)hi);
+    for (auto it = b; it != e; ++it) out.set(s.idx[(size_t)(it - s.key.begin())]);
+}
+
+IndexBitset ElementIndex::altitudeOverlap(double loKm, double hiKm) const {
+    IndexBitset out(count());
+    overlapQuery(0, m_lo.size(), (float)loKm, (float)hiKm, out);
+    return out;
+}
+
+IndexBitset ElementIndex::inclination(double loDeg, double hiDeg) const {
+    IndexBitset out(count());
+    rangeQuery(m_inc, loDeg, hiDeg, out);
+    return out;
+}
+
+IndexBitset ElementIndex::raan(double loDeg, double hiDeg) const {
+    IndexBitset out(count());
+    if (loDeg <= hiDeg) {
+        rangeQuery(m_raan, loDeg, hiDeg, out);
+    } else {
+        rangeQuery(m_raan, loDeg, 360.0, out);
+        rangeQuery(m_raan, 0.0, hiDeg, out);
+    }
+    return out;
+}
+
+IndexBitset ElementIndex::eccentricity(double lo, double hi) const {
+    IndexBitset out(count());
+    rangeQuery(m_ecc, lo, hi, out);
+    return out;
+}
+
+IndexBitset ElementIndex::sunSynchronous(double tolDegDay) const {
+    IndexBitset out(count());
+    rangeQuery(m_rate, SUN_MEAN_MOTION_DEG_DAY - tolDegDay, SUN_MEAN_MOTION_DEG_DAY + tolDegDay, out);
+    return out;
+}
+
+IndexBitset ElementIndex::query(const ElementFilter& f) const {
+    IndexBitset out = all();
+    if (f.useAltitude) out &= altitudeOverlap(f.altLoKm, f.altHiKm);
+    if (f.useInclination) out &= inclination(f.incLoDeg, f.incHiDeg);
+    if (f.useRaan) out &= raan(f.raanLoDeg, f.raanHiDeg);
+    if (f.useEccentricity) out &= eccentricity(f.eccLo, f.eccHi);
+    if (f.sunSynchronous) out &= sunSynchronous();
+    return out;
+}
+
+IndexBitset ElementIndex::altitudeCandidates(size_t primary, double padKm) const {
+    if (primary >= count()) return IndexBitset(count());
+    const OrbitShape& s = m_shapes[primary];
+    return altitudeOverlap(s.perigeeKm - padKm, s.apogeeKm + padKm);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class Sgp4System;
+
+// Band tests compare mean-element perigee/apogee with osculating SGP4
+// positions; short-period J2 terms move the real altitude by up to ~10-20 km.
+inline constexpr double kBandMarginKm = 30.0;
+
+// One bit per catalog index.
+class IndexBitset {
+public:
+    IndexBitset() = default;
+    explicit IndexBitset(size_t n, bool value = false);
+
+    size_t size() const { return m_n; }
+    void set(size_t i) { m_words[i >> 6] |= 1ull << (i & 63); }
+    bool test(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1ull; }
+    size_t count() const;
+
+    IndexBitset& operator&=(const IndexBitset& o);
+    IndexBitset& operator|=(const IndexBitset& o);
+    IndexBitset& flip();
+
+    // raw 64-bit words, for kernels that build whole words at a time
+    size_t wordCount() const { return m_words.size(); }
+    uint64_t word(size_t wi) const { return m_words[wi]; }
+    void setWord(size_t wi, uint64_t w) { m_words[wi] = w; }
+
+    // Set bits in ascending order, at most maxCount of them.
+    void indices(std::vector<uint32_t>& out, size_t maxCount = (size_t)-1) const;
+
+private:
+    size_t m_n = 0;
+    std::vector<uint64_t> m_words;
+};
+
+// Orbit shape from the TLE mean elements. Altitudes are above the equatorial
+// radius, so they are mean values, not osculating ones.
+struct OrbitShape {
+    float perigeeKm = 0.0f;
+    float apogeeKm = 0.0f;
+    float inclinationDeg = 0.0f;
+    float raanDeg = 0.0f;
+    float eccentricity = 0.0f;
+    float nodalRateDegDay = 0.0f; // secular J2 RAAN drift
+};
+
+// Disabled terms match everything; enabled ones are ANDed.
+struct ElementFilter {
+    bool useAltitude = false;
+    float altLoKm = 540.0f;
+    float altHiKm = 560.0f;
+
+    bool useInclination = false;
+    float incLoDeg = 0.0f;
+    float incHiDeg = 180.0f;
+
+    bool useRaan = false;
+    float raanLoDeg = 0.0f;
+    float raanHiDeg = 360.0f;
+
+    bool useEccentricity = false;
+    float eccLo = 0.0f;
+    float eccHi = 0.01f;
+
+    bool sunSynchronous = false;
+
+    bool any() const { return useAltitude || useInclination || useRaan || useEccentricity || sunSynchronous; }
+};
+
+// Built once per catalog load. Perigee..apogee bands sit in a static interval
+// tree, the scalar elements in sorted arrays, so a range query is a tree walk
+// or two binary searches and never propagates anything.
+class ElementIndex {
+public:
+    void build(const Sgp4System& sys);
+
+    size_t count() const { return m_shapes.size(); }
+    const OrbitShape& shape(size_t i) const { return m_shapes[i]; }
+    double lastBuildMs() const { return m_buildMs; }
+
+    IndexBitset all() const { return IndexBitset(count(), true); }
+
+    // Objects whose perigee..apogee band overlaps [loKm, hiKm].
+    IndexBitset altitudeOverlap(double loKm, double hiKm) const;
+    IndexBitset inclination(double loDeg, double hiDeg) const;
+    // lo > hi wraps through 0/360.
+    IndexBitset raan(double loDeg, double hiDeg) const;
+    IndexBitset eccentricity(double lo, double hi) const;
+    // RAAN drift within tolDegDay of the Sun's mean motion.
+    IndexBitset sunSynchronous(double tolDegDay = 0.1) const;
+
+    IndexBitset query(const ElementFilter& f) const;
+
+    // Secondaries whose band comes within padKm of the primary's: the classic
+    // perigee/apogee pre-filter for conjunction screening.
+    IndexBitset altitudeCandidates(size_t primary, double padKm) const;
+
+private:
+    struct SortedKey {
+        std::vector<float> key;
+        std::vector<uint32_t> idx;
+    };
+
+    std::vector<OrbitShape> m_shapes;
+
+    // intervals sorted by low end; the implicit tree over [b, e) has its root
+    // at the midpoint and m_maxHi[mid] holds the largest high end below it
+    std::vector<float> m_lo, m_hi, m_maxHi;
+    std::vector<uint32_t> m_ivIdx;
+
+    SortedKey m_inc, m_raan, m_ecc, m_rate;
+    double m_buildMs = 0.0;
+
+    static void buildSorted(SortedKey& s, const std::vector<float>& values);
+    static void rangeQuery(const SortedKey& s, double lo, double hi, IndexBitset& out);
+    float buildMaxHi(size_t b, size_t e);
+    void overlapQuery(size_t b, size_t e, float lo, float hi, IndexBitset& out) const;
+};
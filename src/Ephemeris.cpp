@@ -0,0 +1,238 @@
+#include "Ephemeris.h"
+#include "EarthConstants.h"
+
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+
+static double deg2rad(double d) { return d * PI / 180.0; }
+
+static double wrapDeg(double x) {
+    x = std::fmod(x, 360.0);
+    if (x < 0) x += 360.0;
+    return x;
+}
+
+static double julianDayUTC(const std::tm& utc, double fracSeconds) {
+    int Y = utc.tm_year + 1900;
+    int M = utc.tm_mon + 1;
+    int D = utc.tm_mday;
+
+    double hour = (double)utc.tm_hour + (double)utc.tm_min / 60.0 + ((double)utc.tm_sec + fracSeconds) / 3600.0;
+
+    if (M <= 2) { Y -= 1; M += 12; }
+    int A = Y / 100;
+    int B = 2 - A + (A / 4);
+
+    double JD = std::floor(365.25 * (Y + 4716)) + std::floor(30.6001 * (M + 1)) + (double)D + (double)B - 1524.5 + hour / 24.0;
+    return JD;
+}
+
+double julianDay_FromTimePointUTC(const std::chrono::system_clock::time_point& tpUtc) {
+    using namespace std::chrono;
+    const auto tt = system_clock::to_time_t(tpUtc);
+
+    std::tm utc{};
+#if defined(_WIN32)
+    gmtime_s(&utc, &tt);
+#else
+    gmtime_r(&tt, &utc);
+#endif
+
+    const auto base = system_clock::from_time_t(tt);
+    const double frac = duration<double>(tpUtc - base).count();
+    return julianDayUTC(utc, frac);
+}
+
+double gmstRadians_FromUTC(const std::chrono::system_clock::time_point& tpUtc) {
+    const double JD = julianDay_FromTimePointUTC(tpUtc);
+    const double T = (JD - 2451545.0) / 36525.0;
+
+    double gmstDeg =
+        280.46061837 +
+        360.98564736629 * (JD - 2451545.0) +
+        0.000387933 * T * T -
+        (T * T * T) / 38710000.0;
+
+    gmstDeg = std::fmod(gmstDeg, 360.0);
+    if (gmstDeg < 0) gmstDeg += 360.0;
+
+    return deg2rad(gmstDeg);
+}
+
+glm::dvec3 sunPosECI_Km_FromUTC(const std::chrono::system_clock::time_point& tpUtc) {
+    const double JD = julianDay_FromTimePointUTC(tpUtc);
+    const double T = (JD - 2451545.0) / 36525.0;
+
+    double L0 = std::fmod(280.46646 + T * (36000.76983 + 0.0003032 * T), 360.0);
+    if (L0 < 0) L0 += 360.0;
+
+    double M = std::fmod(357.52911 + T * (35999.05029 - 0.0001537 * T), 360.0);
+    if (M < 0) M += 360.0;
+
+    const double Mr = deg2rad(M);
+
+    const double C =
+        (1.914602 - T * (0.004817 + 0.000014 * T)) * std::sin(Mr) +
+        (0.019993 - 0.000101 * T) * std::sin(2.0 * Mr) +
+        0.000289 * std::sin(3.0 * Mr);
+
+    const double trueLong = L0 + C;
+
+    const double omega = 125.04 - 1934.136 * T;
+    const double lambda = trueLong - 0.00569 - 0.00478 * std::sin(deg2rad(omega));
+
+    const double eps0 =
+        23.0 + (26.0 + (21.448 - T * (46.815 + T * (0.00059 - T * 0.001813))) / 60.0) / 60.0;
+    const double eps = eps0 + 0.00256 * std::cos(deg2rad(omega));
+
+    const double lam = deg2rad(lambda);
+    const double epr = deg2rad(eps);
+
+    const double alpha = std::atan2(std::cos(epr) * std::sin(lam), std::cos(lam));
+    const double delta = std::asin(std::sin(epr) * std::sin(lam));
+
+    const double e = 0.016708634 - T * (0.000042037 + 0.0000001267 * T);
+    const double nu = Mr + deg2rad(C);
+    const double rAU = 1.000001018 * (1.0 - e * e) / (1.0 + e * std::cos(nu));
+    const double r = rAU * AU_KM;
+
+    return glm::dvec3(
+        r * std::cos(delta) * std::cos(alpha),
+        r * std::cos(delta) * std::sin(alpha),
+        r * std::sin(delta));
+}
+
+glm::vec3 sunDirECI_FromUTC(const std::chrono::system_clock::time_point& tpUtc) {
+    const glm::dvec3 s = sunPosECI_Km_FromUTC(tpUtc);
+    glm::vec3 w((float)s.x, (float)s.z, (float)s.y);
+    return glm::normalize(w);
+}
+
+glm::dvec3 moonPosECI_Km_FromUTC(const std::chrono::system_clock::time_point& tpUtc) {
+    const double JD = julianDay_FromTimePointUTC(tpUtc);
+    const double d = JD - 2451545.0;
+    const double T = d / 36525.0;
+
+    double L0 = wrapDeg(218.3164477 + 13.17639648 * d);
+    double Mm = wrapDeg(134.9633964 + 13.06499295 * d);
+    double Ms = wrapDeg(357.5291092 + 0.98560028 * d);
+    double D = wrapDeg(297.8501921 + 12.19074912 * d);
+    double F = wrapDeg(93.2720950 + 13.22935024 * d);
+
+    double Mmr = deg2rad(Mm);
+    double Msr = deg2rad(Ms);
+    double Dr = deg2rad(D);
+    double Fr = deg2rad(F);
+
+    double lon =
+        L0 +
+        6.289 * std::sin(Mmr) +
+        1.274 * std::sin(2.0 * Dr - Mmr) +
+        0.658 * std::sin(2.0 * Dr) +
+        0.214 * std::sin(2.0 * Mmr) +
+        0.110 * std::sin(Dr);
+
+    double lat =
+        5.128 * std::sin(Fr) +
+        0.280 * std::sin(Mmr + Fr) +
+        0.277 * std::sin(Mmr - Fr) +
+        0.173 * std::sin(2.0 * Dr - Fr) +
+        0.055 * std::sin(2.0 * Dr + Fr - Mmr) +
+        0.046 * std::sin(2.0 * Dr - Fr - Mmr) +
+        0.033 * std::sin(2.0 * Dr + Fr) +
+        0.017 * std::sin(2.0 * Mmr + Fr);
+
+    double distKm =
+        385001.0 - 20905.0 * std::cos(Mmr) - 3699.0 * std::cos(2.0 * Dr - Mmr) - 2956.0 * std::cos(2.0 * Dr) - 570.0 * std::cos(2.0 * Mmr) + 246.0 * std::cos(2.0 * Mmr - 2.0 * Dr) - 205.0 * std::cos(Msr - 2.0 * Dr) - 171.0 * std::cos(Mmr + 2.0 * Dr) - 152.0 * std::cos(Mmr + Msr) - 129.0 * std::cos(Mmr - Msr) + 108.0 * std::cos(Dr);
+
+    double lonr = deg2rad(wrapDeg(lon));
+    double latr = deg2rad(lat);
+
+    double eps =
+        23.0 + (26.0 + (21.448 - T * (46.815 + T * (0.00059 - T * 0.001813))) / 60.0) / 60.0;
+    double epsr = deg2rad(eps);
+
+    double cl = std::cos(latr);
+    double x_ecl = distKm * cl * std::cos(lonr);
+    double y_ecl = distKm * cl * std::sin(lonr);
+    double z_ecl = distKm * std::sin(latr);
+
+    double x_eq = x_ecl;
+    double y_eq = y_ecl * std::cos(epsr) - z_ecl * std::sin(epsr);
+    double z_eq = y_ecl * std::sin(epsr) + z_ecl * std::cos(epsr);
+
+    return glm::dvec3(x_eq, y_eq, z_eq);
+}
+
+Ephemeris::Ephemeris(const std::chrono::system_clock::time_point& startUtcTP, double stepSec)
+    : m_startUtc(startUtcTP), m_stepSec(std::max(1.0, stepSec)) {}
+
+std::chrono::system_clock::time_point Ephemeris::utcAt(double simTimeSec) const {
+    return m_startUtc +
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::duration<double>(simTimeSec));
+}
+
+bool Ephemeris::covers(double t0Sec, double t1Sec) const {
+    if (m_sunKm.size() < 2) return false;
+    const double tEnd = m_t0Sec + m_stepSec * (double)(m_sunKm.size() - 1);
+    return t0Sec >= m_t0Sec && t1Sec <= tEnd;
+}
+
+void Ephemeris::ensureCovers(double t0Sec, double t1Sec) {
+    if (t1Sec < t0Sec) std::swap(t0Sec, t1Sec);
+    if (covers(t0Sec, t1Sec)) return;
+
+    // pad so a running clock at high time scale does not rebuild every frame
+    const double pad = 2.0 * 86400.0;
+    const double a = std::floor((t0Sec - 0.25 * pad) / m_stepSec) * m_stepSec;
+    const double b = t1Sec + pad;
+    const size_t n = (size_t)std::ceil((b - a) / m_stepSec) + 1;
+
+    m_t0Sec = a;
+    m_sunKm.resize(n);
+    m_moonKm.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto tp = utcAt(a + m_stepSec * (double)i);
+        m_sunKm[i] = sunPosECI_Km_FromUTC(tp);
+        m_moonKm[i] = moonPosECI_Km_FromUTC(tp);
+    }
+}
+
+bool Ephemeris::lookup(double simTimeSec, size_t& i, double& f) const {
+    if (m_sunKm.size() < 2) return false;
+
+    const double u = (simTimeSec - m_t0Sec) / m_stepSec;
+    if (u < 0.0 || u > (double)(m_sunKm.size() - 1)) return false;
+
+    i = std::min((size_t)u, m_sunKm.size() - 2);
+    f = u - (double)i;
+    return true;
+}
+
+glm::dvec3 Ephemeris::sunPosKm(double simTimeSec) const {
+    size_t i = 0;
+    double f = 0.0;
+    if (!lookup(simTimeSec, i, f)) return sunPosECI_Km_FromUTC(utcAt(simTimeSec));
+    return m_sunKm[i] + (m_sunKm[i + 1] - m_sunKm[i]) * f;
+}
+
+glm::dvec3 Ephemeris::moonPosKm(double simTimeSec) const {
+    size_t i = 0;
+    double f = 0.0;
+    if (!lookup(simTimeSec, i, f)) return moonPosECI_Km_FromUTC(utcAt(simTimeSec));
+    return m_moonKm[i] + (m_moonKm[i + 1] - m_moonKm[i]) * f;
+}
+
+glm::vec3 Ephemeris::sunDirRender(double simTimeSec) const {
+    const glm::dvec3 s = sunPosKm(simTimeSec);
+    glm::vec3 w((float)s.x, (float)s.z, (float)s.y);
+    return glm::normalize(w);
+}
+
+glm::vec3 Ephemeris::moonPosRender(double simTimeSec, float earthRadiusRender, float earthRadiusKm) const {
+    const glm::dvec3 m = moonPosKm(simTimeSec);
+    const double scale = (double)earthRadiusRender / (double)earthRadiusKm;
+    return glm::vec3((float)(m.x * scale), (float)(m.z * scale), (float)(m.y * scale));
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <glm/glm.hpp>
+
+static constexpr double SUN_RADIUS_KM = 696000.0;
+static constexpr double AU_KM = 149597870.7;
+
+double julianDay_FromTimePointUTC(const std::chrono::system_clock::time_point& tpUtc);
+double gmstRadians_FromUTC(const std::chrono::system_clock::time_point& tpUtc);
+
+// Low-precision solar series (Meeus ch. 25). ECI km, z = north.
+glm::dvec3 sunPosECI_Km_FromUTC(const std::chrono::system_clock::time_point& tpUtc);
+
+// Unit vector towards the Sun in render space (y = north).
+glm::vec3 sunDirECI_FromUTC(const std::chrono::system_clock::time_point& tpUtc);
+
+// Truncated lunar series (Meeus ch. 47 main terms). ECI km, z = north.
+glm::dvec3 moonPosECI_Km_FromUTC(const std::chrono::system_clock::time_point& tpUtc);
+
+// Sun and Moon tabulated over a sim-time window and linearly interpolated
+// (Moon chord error at the default 10 min spacing is ~0.1 km). One instance
+// is shared by the renderer, eclipse tables and pass prediction; it is
+// rebuilt on the render thread, so workers should be handed a copy.
+class Ephemeris {
+public:
+    explicit Ephemeris(const std::chrono::system_clock::time_point& startUtcTP, double stepSec = 600.0);
+
+    void ensureCovers(double t0Sec, double t1Sec);
+    bool covers(double t0Sec, double t1Sec) const;
+
+    glm::dvec3 sunPosKm(double simTimeSec) const;
+    glm::dvec3 moonPosKm(double simTimeSec) const;
+
+    glm::vec3 sunDirRender(double simTimeSec) const;
+    glm::vec3 moonPosRender(double simTimeSec, float earthRadiusRender, float earthRadiusKm) const;
+
+    const std::chrono::system_clock::time_point& startUtc() const { return m_startUtc; }
+
+    double t0Sec() const { return m_t0Sec; }
+    double stepSec() const { return m_stepSec; }
+    size_t sampleCount() const { return m_sunKm.size(); }
+
+private:
+    std::chrono::system_clock::time_point m_startUtc;
+    double m_stepSec = 600.0;
+    double m_t0Sec = 0.0;
+    std::vector<glm::dvec3> m_sunKm;
+    std::vector<glm::dvec3> m_moonKm;
+
+    std::chrono::system_clock::time_point utcAt(double simTimeSec) const;
+    bool lookup(double simTimeSec, size_t& i, double& f) const;
+};
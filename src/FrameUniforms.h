@@ -0,0 +1,21 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Per-frame values shared by every program through one std140 uniform block:
+//
+//   layout(std140) uniform FrameUniforms {
+//       mat4 uView; mat4 uProj; vec3 uSunDir; float uTime; vec3 uCamPos;
+//   };
+//
+// Shader binds the block to kFrameUniformsBinding at link time.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec3 sunDir;
+    float time;
+    glm::vec3 camPos;
+    float pad;
+};
+static_assert(sizeof(FrameUniforms) == 160, "FrameUniforms must match the std140 block");
+
+constexpr unsigned kFrameUniformsBinding = 0;
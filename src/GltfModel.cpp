@@ -1,4 +1,5 @@
 #include "GltfModel.h"
+#include "EarthConstants.h"
 #include "Shader.h"
 
 #include <iostream>
@@ -9,11 +10,7 @@
 
 #include "stb_image.h"
 
-struct Vtx {
-    glm::vec3 p;
-    glm::vec3 n;
-    glm::vec2 uv;
-};
+using Vtx = GltfAsset::Vtx;
 
 static cgltf_accessor* findAttr(cgltf_primitive* prim, cgltf_attribute_type type, int index = 0) {
     for (cgltf_size i = 0; i < prim->attributes_count; i++) {
@@ -23,28 +20,52 @@ static cgltf_accessor* findAttr(cgltf_primitive* prim, cgltf_attribute_type type
     return nullptr;
 }
 
-GLuint GltfModel::createTextureFromMemoryRGBA(const unsigned char* rgba, int w, int h, bool srgb) {
-    GLuint tex = 0;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-
-    GLint internalFmt = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
-
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFmt, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+static float srgbToLinear(float c) {
+    return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+static unsigned char linearToSrgb8(float c) {
+    c = std::clamp(c, 0.0f, 1.0f);
+    const float s = (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    return (unsigned char)(s * 255.0f + 0.5f);
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    return tex;
+// 2x2 box filter down to 1x1; colour channels are averaged in linear light for
+// sRGB images, which is what glGenerateMipmap does on an sRGB texture.
+static void buildMipChain(GltfAsset::Image& img, bool srgb) {
+    float toLinear[256];
+    for (int i = 0; i < 256; i++) toLinear[i] = srgb ? srgbToLinear((float)i / 255.0f) : (float)i / 255.0f;
+
+    while (img.levels.back().w > 1 || img.levels.back().h > 1) {
+        const GltfAsset::MipLevel& src = img.levels.back();
+        GltfAsset::MipLevel dst;
+        dst.w = std::max(1, src.w / 2);
+        dst.h = std::max(1, src.h / 2);
+        dst.rgba.resize((size_t)dst.w * (size_t)dst.h * 4);
+
+        for (int y = 0; y < dst.h; y++) {
+            const int y0 = std::min(2 * y, src.h - 1), y1 = std::min(2 * y + 1, src.h - 1);
+            for (int x = 0; x < dst.w; x++) {
+                const int x0 = std::min(2 * x, src.w - 1), x1 = std::min(2 * x + 1, src.w - 1);
+                const unsigned char* s[4] = {
+                    &src.rgba[((size_t)y0 * src.w + x0) * 4], &src.rgba[((size_t)y0 * src.w + x1) * 4],
+                    &src.rgba[((size_t)y1 * src.w + x0) * 4], &src.rgba[((size_t)y1 * src.w + x1) * 4]};
+                unsigned char* d = &dst.rgba[((size_t)y * dst.w + x) * 4];
+
+                for (int c = 0; c < 3; c++) {
+                    const float v = 0.25f * (toLinear[s[0][c]] + toLinear[s[1][c]] + toLinear[s[2][c]] + toLinear[s[3][c]]);
+                    d[c] = srgb ? linearToSrgb8(v) : (unsigned char)(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+                d[3] = (unsigned char)((s[0][3] + s[1][3] + s[2][3] + s[3][3] + 2) / 4);
+            }
+        }
+        img.levels.push_back(std::move(dst));
+    }
 }
 
-bool GltfModel::loadFromFile(const std::string& path, bool srgbBaseColor) {
-    destroy();
+bool decodeGltfAsset(const std::string& path, bool srgbBaseColor, GltfAsset& out) {
+    out = GltfAsset{};
+    out.srgb = srgbBaseColor;
 
     cgltf_options options{};
     cgltf_data* data = nullptr;
@@ -62,7 +83,7 @@ bool GltfModel::loadFromFile(const std::string& path, bool srgbBaseColor) {
         return false;
     }
 
-    m_textures.resize(data->images_count);
+    out.images.resize(data->images_count);
     for (cgltf_size i = 0; i < data->images_count; i++) {
         cgltf_image* img = &data->images[i];
 
@@ -98,11 +119,14 @@ bool GltfModel::loadFromFile(const std::string& path, bool srgbBaseColor) {
             continue;
         }
 
-        GLuint tex = createTextureFromMemoryRGBA(rgba, w, h, srgbBaseColor);
+        GltfAsset::MipLevel base;
+        base.w = w;
+        base.h = h;
+        base.rgba.assign(rgba, rgba + (size_t)w * (size_t)h * 4);
         stbi_image_free(rgba);
 
-        m_textures[i].id = tex;
-        m_textures[i].valid = true;
+        out.images[i].levels.push_back(std::move(base));
+        buildMipChain(out.images[i], srgbBaseColor);
     }
 
     float maxR = 0.0f;
@@ -119,8 +143,9 @@ bool GltfModel::loadFromFile(const std::string& path, bool srgbBaseColor) {
             cgltf_accessor* nrmAcc = findAttr(prim, cgltf_attribute_type_normal, 0);
             cgltf_accessor* uvAcc  = findAttr(prim, cgltf_attribute_type_texcoord, 0);
 
+            GltfAsset::Primitive outPrim;
             const cgltf_size vcount = posAcc->count;
-            std::vector<Vtx> verts;
+            std::vector<Vtx>& verts = outPrim.verts;
             verts.resize((size_t)vcount);
 
             for (cgltf_size v = 0; v < vcount; v++) {
@@ -139,78 +164,179 @@ bool GltfModel::loadFromFile(const std::string& path, bool srgbBaseColor) {
                 maxR = std::max(maxR, glm::length(verts[(size_t)v].p));
             }
 
-            std::vector<uint32_t> indices;
-            bool hasIdx = (prim->indices != nullptr);
-
-            if (hasIdx) {
+            outPrim.hasIndices = (prim->indices != nullptr);
+            if (outPrim.hasIndices) {
                 cgltf_accessor* idxAcc = prim->indices;
-                indices.resize((size_t)idxAcc->count);
+                outPrim.indices.resize((size_t)idxAcc->count);
                 for (cgltf_size k = 0; k < idxAcc->count; k++) {
-                    indices[(size_t)k] = (uint32_t)cgltf_accessor_read_index(idxAcc, k);
+                    outPrim.indices[(size_t)k] = (uint32_t)cgltf_accessor_read_index(idxAcc, k);
                 }
             }
 
-            Primitive out{};
-            out.mode = (prim->type == cgltf_primitive_type_triangles) ? GL_TRIANGLES : GL_TRIANGLES;
-            out.hasIndices = hasIdx;
-            out.indexCount = hasIdx ? (GLsizei)indices.size() : (GLsizei)verts.size();
-
-            out.baseColorTexIndex = -1;
             if (prim->material) {
                 auto& pbr = prim->material->pbr_metallic_roughness;
                 if (pbr.base_color_texture.texture && pbr.base_color_texture.texture->image) {
 
                     cgltf_image* img = pbr.base_color_texture.texture->image;
                     ptrdiff_t idx = img - data->images;
-                    if (idx >= 0 && idx < (ptrdiff_t)m_textures.size() && m_textures[(size_t)idx].valid) {
-                        out.baseColorTexIndex = (int)idx;
+                    if (idx >= 0 && idx < (ptrdiff_t)out.images.size() && !out.images[(size_t)idx].levels.empty()) {
+                        outPrim.baseColorTexIndex = (int)idx;
                     }
                 }
             }
 
-            glGenVertexArrays(1, &out.vao);
-            glGenBuffers(1, &out.vbo);
-            glGenBuffers(1, &out.ebo);
+            out.prims.push_back(std::move(outPrim));
+        }
+    }
 
-            glBindVertexArray(out.vao);
+    out.boundsRadius = (maxR > 1e-6f) ? maxR : 1.0f;
 
-            glBindBuffer(GL_ARRAY_BUFFER, out.vbo);
-            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(verts.size() * sizeof(Vtx)), verts.data(), GL_STATIC_DRAW);
+    cgltf_free(data);
+    return !out.prims.empty();
+}
 
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vtx), (void*)offsetof(Vtx, p));
+GltfAsset makeSphereAsset(int slices, int stacks, const glm::vec3& color) {
+    GltfAsset a;
+    slices = std::max(3, slices);
+    stacks = std::max(2, stacks);
+
+    GltfAsset::MipLevel texel;
+    texel.w = texel.h = 1;
+    texel.rgba = {linearToSrgb8(color.x), linearToSrgb8(color.y), linearToSrgb8(color.z), 255};
+    a.images.resize(1);
+    a.images[0].levels.push_back(std::move(texel));
+
+    GltfAsset::Primitive prim;
+    prim.hasIndices = true;
+    prim.baseColorTexIndex = 0;
+    prim.verts.reserve((size_t)(slices + 1) * (size_t)(stacks + 1));
+
+    for (int y = 0; y <= stacks; y++) {
+        const float phi = (float)y / (float)stacks * (float)PI;
+        for (int x = 0; x <= slices; x++) {
+            const float theta = (float)x / (float)slices * 2.0f * (float)PI;
+            const glm::vec3 n(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            prim.verts.push_back({n, n, glm::vec2((float)x / (float)slices, 1.0f - (float)y / (float)stacks)});
+        }
+    }
 
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vtx), (void*)offsetof(Vtx, n));
+    const uint32_t row = (uint32_t)slices + 1;
+    for (int y = 0; y < stacks; y++) {
+        for (int x = 0; x < slices; x++) {
+            const uint32_t i0 = (uint32_t)y * row + (uint32_t)x;
+            const uint32_t i1 = i0 + 1, i2 = i0 + row, i3 = i2 + 1;
+            prim.indices.insert(prim.indices.end(), {i0, i2, i1, i1, i2, i3});
+        }
+    }
 
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vtx), (void*)offsetof(Vtx, uv));
+    a.prims.push_back(std::move(prim));
+    a.boundsRadius = 1.0f;
+    return a;
+}
 
-            if (hasIdx) {
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, out.ebo);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(uint32_t)), indices.data(), GL_STATIC_DRAW);
-            }
+GLuint GltfModel::createTexture(const GltfAsset::Image& img, bool srgb) {
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+
+    GLint internalFmt = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
 
-            glBindVertexArray(0);
+    // mip chain comes precomputed; no glGenerateMipmap on the render thread
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t l = 0; l < img.levels.size(); l++) {
+        const GltfAsset::MipLevel& m = img.levels[l];
+        glTexImage2D(GL_TEXTURE_2D, (GLint)l, internalFmt, m.w, m.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, m.rgba.data());
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)img.levels.size() - 1);
 
-            m_prims.push_back(out);
-        }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+bool GltfModel::loadFromFile(const std::string& path, bool srgbBaseColor) {
+    GltfAsset asset;
+    if (!decodeGltfAsset(path, srgbBaseColor, asset)) {
+        destroy();
+        return false;
     }
+    return upload(asset);
+}
 
-    m_boundsRadius = (maxR > 1e-6f) ? maxR : 1.0f;
+bool GltfModel::upload(const GltfAsset& asset) {
+    destroy();
 
-    cgltf_free(data);
+    m_textures.resize(asset.images.size());
+    for (size_t i = 0; i < asset.images.size(); i++) {
+        if (asset.images[i].levels.empty()) continue;
+        m_textures[i].id = createTexture(asset.images[i], asset.srgb);
+        m_textures[i].valid = true;
+    }
+
+    for (const GltfAsset::Primitive& prim : asset.prims) {
+        Primitive out{};
+        out.mode = GL_TRIANGLES;
+        out.hasIndices = prim.hasIndices;
+        out.indexCount = prim.hasIndices ? (GLsizei)prim.indices.size() : (GLsizei)prim.verts.size();
+
+        out.baseColorTexIndex = -1;
+        const int idx = prim.baseColorTexIndex;
+        if (idx >= 0 && idx < (int)m_textures.size() && m_textures[(size_t)idx].valid) {
+            out.baseColorTexIndex = idx;
+        }
+
+        glGenVertexArrays(1, &out.vao);
+        glGenBuffers(1, &out.vbo);
+        glGenBuffers(1, &out.ebo);
+
+        glBindVertexArray(out.vao);
+
+        glBindBuffer(GL_ARRAY_BUFFER, out.vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(prim.verts.size() * sizeof(Vtx)), prim.verts.data(), GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vtx), (void*)offsetof(Vtx, p));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vtx), (void*)offsetof(Vtx, n));
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vtx), (void*)offsetof(Vtx, uv));
+
+        if (prim.hasIndices) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, out.ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(prim.indices.size() * sizeof(uint32_t)), prim.indices.data(), GL_STATIC_DRAW);
+        }
+
+        glBindVertexArray(0);
+
+        m_prims.push_back(out);
+    }
+
+    m_boundsRadius = asset.boundsRadius;
     return !m_prims.empty();
 }
 
 void GltfModel::drawEarthStyle(Shader& earthShader, int textureUnit) const {
+    const GLint hasTexLoc = earthShader.location("uHasTex");
+    glUniform1i(earthShader.location("uEarthTex"), textureUnit);
+
+    int lastHasTex = -1;
     for (const auto& p : m_prims) {
         bool hasTex = (p.baseColorTexIndex >= 0 &&
                        (size_t)p.baseColorTexIndex < m_textures.size() &&
                        m_textures[(size_t)p.baseColorTexIndex].valid);
 
-        earthShader.setBool("uHasTex", hasTex);
-        earthShader.setInt("uEarthTex", textureUnit);
+        if ((int)hasTex != lastHasTex) {
+            glUniform1i(hasTexLoc, hasTex ? 1 : 0);
+            lastHasTex = (int)hasTex;
+        }
 
         if (hasTex) {
             glActiveTexture(GL_TEXTURE0 + textureUnit);
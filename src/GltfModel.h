@@ -1,14 +1,53 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 
 class Shader;
 
+// CPU side of a model: decoded, mipmapped and interleaved so upload is
+// nothing but glTexImage2D / glBufferData. Built without a GL context.
+struct GltfAsset {
+    struct Vtx {
+        glm::vec3 p;
+        glm::vec3 n;
+        glm::vec2 uv;
+    };
+
+    struct MipLevel {
+        int w = 0, h = 0;
+        std::vector<unsigned char> rgba;
+    };
+
+    // no levels = image failed to decode
+    struct Image {
+        std::vector<MipLevel> levels;
+    };
+
+    struct Primitive {
+        std::vector<Vtx> verts;
+        std::vector<uint32_t> indices;
+        bool hasIndices = false;
+        int baseColorTexIndex = -1;
+    };
+
+    std::vector<Image> images;
+    std::vector<Primitive> prims;
+    float boundsRadius = 1.0f;
+    bool srgb = true;
+};
+
+bool decodeGltfAsset(const std::string& path, bool srgbBaseColor, GltfAsset& out);
+
+// Unit UV sphere with a 1x1 texture, drawn until the real asset arrives.
+GltfAsset makeSphereAsset(int slices, int stacks, const glm::vec3& color);
+
 class GltfModel {
 public:
     bool loadFromFile(const std::string& path, bool srgbBaseColor = true);
+    bool upload(const GltfAsset& asset);
     void destroy();
 
     void drawEarthStyle(Shader& earthShader, int textureUnit = 0) const;
@@ -23,7 +62,7 @@ private:
         GLsizei indexCount = 0;
         bool hasIndices = false;
         GLenum mode = GL_TRIANGLES;
-        int baseColorTexIndex = -1; 
+        int baseColorTexIndex = -1;
     };
 
     struct Texture {
@@ -36,5 +75,5 @@ private:
     float m_boundsRadius = 1.0f;
 
 private:
-    GLuint createTextureFromMemoryRGBA(const unsigned char* rgba, int w, int h, bool srgb);
+    GLuint createTexture(const GltfAsset::Image& img, bool srgb);
 };
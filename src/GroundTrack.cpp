@@ -0,0 +1,176 @@
+#include "GroundTrack.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "Ephemeris.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) --q;
+    return q;
+}
+
+void GroundTrackCache::configure(
+    const std::chrono::system_clock::time_point& startUtcTP,
+    bool rotateEarth,
+    float earthLonOffsetDeg,
+    double stepSec
+) {
+    stepSec = std::max(1.0, stepSec);
+    if (startUtcTP == m_startUtc && rotateEarth == m_rotate &&
+        earthLonOffsetDeg == m_lonOffsetDeg && stepSec == m_stepSec && m_version > 0)
+        return;
+
+    m_startUtc = startUtcTP;
+    m_rotate = rotateEarth;
+    m_lonOffsetDeg = earthLonOffsetDeg;
+    m_stepSec = stepSec;
+    m_gmst0 = gmstRadians_FromUTC(startUtcTP);
+
+    for (auto& kv : m_tracks) kv.second.chunks.clear();
+    m_version++;
+}
+
+double GroundTrackCache::thetaAt(double tSec) const {
+    if (!m_rotate) return 0.0;
+    // GMST advances linearly at sidereal rate; one evaluation per configure()
+    return m_gmst0 + EARTH_ROT_RAD_S * tSec + (double)m_lonOffsetDeg * PI / 180.0;
+}
+
+void GroundTrackCache::setTracked(const std::vector<int>& sats) {
+    if (sats == m_order) return;
+
+    std::map<int, Track> keep;
+    for (int s : sats) {
+        auto it = m_tracks.find(s);
+        if (it != m_tracks.end()) keep[s] = std::move(it->second);
+        else keep[s] = Track{};
+    }
+    m_tracks = std::move(keep);
+    m_order = sats;
+    m_cursor = 0;
+    m_version++;
+}
+
+size_t GroundTrackCache::cachedSamples() const {
+    size_t n = 0;
+    for (const auto& kv : m_tracks)
+        for (const auto& c : kv.second.chunks) n += (size_t)c.second.filled;
+    return n;
+}
+
+void GroundTrackCache::windowSamples(double tNowSec, double durationSec, int64_t& k0, int64_t& k1) const {
+    const double t0 = std::max(0.0, tNowSec - durationSec);
+    k0 = (int64_t)std::ceil(t0 / m_stepSec);
+    k1 = (int64_t)std::floor(std::max(0.0, tNowSec) / m_stepSec);
+}
+
+int GroundTrackCache::update(const Sgp4System& sys, double tNowSec, double durationSec, int sampleBudget) {
+    if (m_order.empty()) return 0;
+
+    int64_t k0, k1;
+    windowSamples(tNowSec, durationSec, k0, k1);
+    const int64_t b0 = floorDiv(k0, kChunkSamples);
+    const int64_t b1 = floorDiv(k1, kChunkSamples);
+
+    int done = 0;
+    bool changed = false;
+
+    // evict buckets outside the window (also handles sim time jumping back)
+    for (auto& kv : m_tracks) {
+        auto& chunks = kv.second.chunks;
+        for (auto it = chunks.begin(); it != chunks.end();) {
+            if (it->first < b0 || it->first > b1) { it = chunks.erase(it); changed = true; }
+            else ++it;
+        }
+    }
+
+    auto serve = [&](size_t ti) {
+        const int sat = m_order[ti];
+        if (sat < 0 || (size_t)sat >= sys.count()) return;
+        Track& tr = m_tracks[sat];
+
+        for (int64_t b = b1; b >= b0 && done < sampleBudget; --b) {
+            Chunk& c = tr.chunks[b];
+            if (c.latLon.empty()) c.latLon.resize(kChunkSamples);
+
+            const int want = (int)std::min<int64_t>(kChunkSamples, k1 - b * kChunkSamples + 1);
+            while (c.filled < want && done < sampleBudget) {
+                const int64_t k = b * kChunkSamples + c.filled;
+                const double t = (double)k * m_stepSec;
+
+                glm::dvec3 p;
+                glm::vec2 ll(std::numeric_limits<float>::quiet_NaN(), 0.0f);
+                if (sys.sampleKm((size_t)sat, t, p)) {
+                    // same axes as the renderer: raw ECI x/y/z with y treated as up
+                    const double r = glm::length(p);
+                    if (r > 1e-6) {
+                        double lon = std::remainder(std::atan2(p.z, p.x) + thetaAt(t), 2.0 * PI);
+                        ll = glm::vec2((float)std::asin(std::clamp(p.y / r, -1.0, 1.0)), (float)lon);
+                    }
+                }
+                c.latLon[(size_t)c.filled++] = ll;
+                done++;
+                changed = true;
+            }
+        }
+    };
+
+    // index 0 is the selected sat and always goes first; the rest share
+    // what is left of the budget round-robin
+    serve(0);
+    const size_t others = m_order.size() - 1;
+    if (others > 0) {
+        size_t v = 0;
+        for (; v < others && done < sampleBudget; ++v) serve(1 + (m_cursor + v) % others);
+        if (done >= sampleBudget && v > 0) --v;
+        m_cursor = (m_cursor + v) % others;
+    }
+
+    if (changed) m_version++;
+    return done;
+}
+
+void GroundTrackCache::buildSegments(double tNowSec, double durationSec, float radius, std::vector<glm::vec3>& out) const {
+    out.clear();
+
+    int64_t k0, k1;
+    windowSamples(tNowSec, durationSec, k0, k1);
+
+    auto toPoint = [radius](const glm::vec2& ll) {
+        const float cl = std::cos(ll.x);
+        return glm::vec3(radius * cl * std::cos(ll.y), radius * std::sin(ll.x), radius * cl * std::sin(ll.y));
+    };
+
+    for (int sat : m_order) {
+        auto it = m_tracks.find(sat);
+        if (it == m_tracks.end()) continue;
+
+        bool havePrev = false;
+        glm::vec3 prev(0.0f);
+        int64_t prevK = 0;
+
+        for (const auto& kv : it->second.chunks) {
+            const Chunk& c = kv.second;
+            for (int i = 0; i < c.filled; ++i) {
+                const int64_t k = kv.first * kChunkSamples + i;
+                if (k < k0 || k > k1) continue;
+
+                const glm::vec2& ll = c.latLon[(size_t)i];
+                if (std::isnan(ll.x)) { havePrev = false; continue; }
+
+                const glm::vec3 p = toPoint(ll);
+                if (havePrev && k == prevK + 1) {
+                    out.push_back(prev);
+                    out.push_back(p);
+                }
+                prev = p;
+                prevK = k;
+                havePrev = true;
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Sgp4System;
+
+// Earth-fixed lat/lon samples per satellite, kept in fixed-size time buckets
+// (sample k is at t = k * stepSec). Buckets are extended as sim time advances
+// and evicted once they fall out of the history window, so a running track
+// costs only its newly exposed samples.
+class GroundTrackCache {
+public:
+    static constexpr int kChunkSamples = 64;
+
+    // Invalidates everything when the time/Earth-rotation mapping changes.
+    void configure(
+        const std::chrono::system_clock::time_point& startUtcTP,
+        bool rotateEarth,
+        float earthLonOffsetDeg,
+        double stepSec
+    );
+
+    // sats[0] is served first every update (normally the selected sat).
+    void setTracked(const std::vector<int>& sats);
+    size_t trackedCount() const { return m_order.size(); }
+    size_t cachedSamples() const;
+
+    // Propagates at most sampleBudget new samples across all tracked sats,
+    // newest first, round-robin. Returns the number propagated.
+    int update(const Sgp4System& sys, double tNowSec, double durationSec, int sampleBudget);
+
+    // GL_LINES pairs in Earth-fixed render space (y = north); draw with the
+    // Earth rotation as model matrix.
+    void buildSegments(double tNowSec, double durationSec, float radius, std::vector<glm::vec3>& out) const;
+
+    // Bumped whenever cached samples change.
+    uint64_t version() const { return m_version; }
+    double stepSec() const { return m_stepSec; }
+
+private:
+    struct Chunk {
+        std::vector<glm::vec2> latLon; // rad; NaN lat marks a failed sample
+        int filled = 0;
+    };
+    struct Track {
+        std::map<int64_t, Chunk> chunks;
+    };
+
+    std::map<int, Track> m_tracks;
+    std::vector<int> m_order;
+    size_t m_cursor = 0;
+
+    std::chrono::system_clock::time_point m_startUtc{};
+    bool m_rotate = true;
+    float m_lonOffsetDeg = 0.0f;
+    double m_stepSec = 10.0;
+    double m_gmst0 = 0.0;
+    uint64_t m_version = 0;
+
+    double thetaAt(double tSec) const;
+    void windowSamples(double tNowSec, double durationSec, int64_t& k0, int64_t& k1) const;
+};
@@ -0,0 +1,326 @@
+#include "LinkGraph.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+static constexpr float kInf = std::numeric_limits<float>::infinity();
+
+static bool sameParams(const LinkParams& a, const LinkParams& b) {
+    return a.maxRangeKm == b.maxRangeKm && a.grazingAltKm == b.grazingAltKm && a.maxLinksPerSat == b.maxLinksPerSat &&
+           a.groundMaskDeg == b.groundMaskDeg && a.skinKm == b.skinKm;
+}
+
+void LinkGraph::setMembers(std::vector<uint32_t> members) {
+    if (members == m_members) return;
+    m_members = std::move(members);
+    m_updated = false;
+    m_listValid = false;
+    m_links.clear();
+    m_ground.clear();
+}
+
+int LinkGraph::slotOf(uint32_t catalogIdx) const {
+    for (size_t k = 0; k < m_members.size(); ++k)
+        if (m_members[k] == catalogIdx) return (int)k;
+    return -1;
+}
+
+bool LinkGraph::positionKm(size_t slot, glm::vec3& out) const {
+    if (slot >= m_pos.size() || !m_ok[slot]) return false;
+    out = m_pos[slot];
+    return true;
+}
+
+void LinkGraph::update(const Sgp4System& sys, double tSec, const LinkParams& p, const GroundStation& st, double gmst) {
+    const auto c0 = std::chrono::steady_clock::now();
+    if (!sameParams(p, m_params)) m_listValid = false;
+    m_params = p;
+    m_params.skinKm = std::max(0.0f, p.skinKm);
+    m_t = tSec;
+
+    const size_t n = m_members.size();
+    m_pos.resize(n);
+    m_ok.resize(n);
+    parallelFor(n, 256, [&](size_t b, size_t e, unsigned) {
+        for (size_t k = b; k < e; ++k) {
+            glm::dvec3 r;
+            m_ok[k] = sys.sampleKm(m_members[k], tSec, r) ? 1 : 0;
+            m_pos[k] = glm::vec3(r);
+        }
+    });
+
+    // Verlet criterion: two members closing by at most 2 * maxMove can't cross the skin
+    if (m_listValid) {
+        float maxMove2 = 0.0f;
+        for (size_t k = 0; k < n && m_listValid; ++k) {
+            if (m_ok[k] != m_refOk[k]) m_listValid = false;
+            else if (m_ok[k]) {
+                const glm::vec3 d = m_pos[k] - m_refPos[k];
+                maxMove2 = std::max(maxMove2, glm::dot(d, d));
+            }
+        }
+        if (std::sqrt(maxMove2) * 2.0f > m_params.skinKm) m_listValid = false;
+    }
+    if (!m_listValid) buildNeighbours();
+
+    const std::vector<SatLink> prev = std::move(m_links);
+    testCandidates();
+
+    // both lists are sorted by (a, b)
+    size_t i = 0, j = 0, same = 0;
+    while (i < prev.size() && j < m_links.size()) {
+        const uint64_t ka = ((uint64_t)prev[i].a << 32) | prev[i].b;
+        const uint64_t kb = ((uint64_t)m_links[j].a << 32) | m_links[j].b;
+        if (ka == kb) {
+            same++;
+            i++;
+            j++;
+        } else if (ka < kb) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    m_added = m_updated ? m_links.size() - same : m_links.size();
+    m_removed = m_updated ? prev.size() - same : 0;
+
+    buildRoutes(st, gmst);
+    m_updated = true;
+    m_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+}
+
+void LinkGraph::buildNeighbours() {
+    const size_t n = m_members.size();
+    m_refPos = m_pos;
+    m_refOk = m_ok;
+    m_pairA.clear();
+    m_pairB.clear();
+    m_listValid = true;
+    m_rebuilds++;
+
+    // uniform grid with cells one search radius wide: neighbours are in the 27 around
+    const float cell = m_params.maxRangeKm + m_params.skinKm;
+    const float reach2 = cell * cell;
+    auto cellOf = [cell](const glm::vec3& p) {
+        return glm::ivec3((int)std::floor(p.x / cell), (int)std::floor(p.y / cell), (int)std::floor(p.z / cell));
+    };
+    auto key = [](const glm::ivec3& c) {
+        return ((uint64_t)(uint32_t)(c.x + 1024) << 42) | ((uint64_t)(uint32_t)(c.y + 1024) << 21) | (uint64_t)(uint32_t)(c.z + 1024);
+    };
+
+    std::vector<std::pair<uint64_t, uint32_t>> sorted;
+    sorted.reserve(n);
+    for (size_t k = 0; k < n; ++k)
+        if (m_ok[k]) sorted.emplace_back(key(cellOf(m_pos[k])), (uint32_t)k);
+    std::sort(sorted.begin(), sorted.end());
+
+    const unsigned workers = workerCount();
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> perWorker(workers);
+    parallelFor(sorted.size(), 64, [&](size_t b, size_t e, unsigned w) {
+        std::vector<std::pair<uint32_t, uint32_t>>& out = perWorker[w];
+        for (size_t s = b; s < e; ++s) {
+            const uint32_t a = sorted[s].second;
+            const glm::ivec3 c = cellOf(m_pos[a]);
+            for (int dx = -1; dx <= 1; ++dx)
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dz = -1; dz <= 1; ++dz) {
+                        const uint64_t k = key(c + glm::ivec3(dx, dy, dz));
+                        auto lo = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(k, 0u));
+                        for (auto it = lo; it != sorted.end() && it->first == k; ++it) {
+                            const uint32_t o = it->second;
+                            if (o <= a) continue;
+                            const glm::vec3 d = m_pos[o] - m_pos[a];
+                            if (glm::dot(d, d) <= reach2) out.emplace_back(a, o);
+                        }
+                    }
+        }
+    });
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (auto& v : perWorker) pairs.insert(pairs.end(), v.begin(), v.end());
+    std::sort(pairs.begin(), pairs.end());
+    m_pairA.resize(pairs.size());
+    m_pairB.resize(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        m_pairA[i] = pairs[i].first;
+        m_pairB[i] = pairs[i].second;
+    }
+}
+
+void LinkGraph::testCandidates() {
+    const size_t m = m_pairA.size();
+    const float range2 = m_params.maxRangeKm * m_params.maxRangeKm;
+    const float block = (float)EARTH_RADIUS_KM + m_params.grazingAltKm;
+    const float block2 = block * block;
+
+    std::vector<float> d2(m);
+    std::vector<char> keep(m);
+    parallelFor(m, 4096, [&](size_t b, size_t e, unsigned) {
+        // gather into SoA so the test itself is one branch-free loop
+        const size_t c = e - b;
+        std::vector<float> s(6 * c);
+        float* ax = &s[0]; float* ay = &s[c]; float* az = &s[2 * c];
+        float* bx = &s[3 * c]; float* by = &s[4 * c]; float* bz = &s[5 * c];
+        for (size_t i = 0; i < c; ++i) {
+            const glm::vec3& pa = m_pos[m_pairA[b + i]];
+            const glm::vec3& pb = m_pos[m_pairB[b + i]];
+            ax[i] = pa.x; ay[i] = pa.y; az[i] = pa.z;
+            bx[i] = pb.x; by[i] = pb.y; bz[i] = pb.z;
+        }
+
+        // closest point of segment a-b to the Earth's centre must stay outside the blocking sphere
+        for (size_t i = 0; i < c; ++i) {
+            const float dx = bx[i] - ax[i], dy = by[i] - ay[i], dz = bz[i] - az[i];
+            const float dd = dx * dx + dy * dy + dz * dz;
+            const float ad = ax[i] * dx + ay[i] * dy + az[i] * dz;
+            const float t = std::min(1.0f, std::max(0.0f, -ad / std::max(dd, 1e-6f)));
+            const float cx = ax[i] + t * dx, cy = ay[i] + t * dy, cz = az[i] + t * dz;
+            d2[b + i] = dd;
+            keep[b + i] = (char)((dd <= range2) & (cx * cx + cy * cy + cz * cz >= block2));
+        }
+    });
+
+    m_links.clear();
+    for (size_t i = 0; i < m; ++i) {
+        if (!keep[i] || !m_ok[m_pairA[i]] || !m_ok[m_pairB[i]]) continue;
+        m_links.push_back({m_pairA[i], m_pairB[i], std::sqrt(d2[i])});
+    }
+
+    // limited terminals: a link survives when it is among the nearest of both ends
+    if (m_params.maxLinksPerSat > 0) {
+        const size_t n = m_members.size();
+        const size_t cap = (size_t)m_params.maxLinksPerSat;
+        std::vector<std::vector<float>> ranges(n);
+        for (const SatLink& l : m_links) {
+            ranges[l.a].push_back(l.rangeKm);
+            ranges[l.b].push_back(l.rangeKm);
+        }
+        std::vector<float> limit(n, kInf);
+        for (size_t k = 0; k < n; ++k) {
+            std::vector<float>& r = ranges[k];
+            if (r.size() <= cap) continue;
+            std::nth_element(r.begin(), r.begin() + (std::ptrdiff_t)(cap - 1), r.end());
+            limit[k] = r[cap - 1];
+        }
+        m_links.erase(std::remove_if(m_links.begin(), m_links.end(), [&](const SatLink& l) {
+                          return l.rangeKm > limit[l.a] || l.rangeKm > limit[l.b];
+                      }),
+                      m_links.end());
+    }
+}
+
+void LinkGraph::buildRoutes(const GroundStation& st, double gmst) {
+    const size_t n = m_members.size();
+
+    // links and routes live in TEME km; the mask is tested Earth-fixed, as in SensorAccess
+    m_stationKm = glm::vec3(PassPredictor::ecefToTeme(PassPredictor::stationEcefKm(st, EARTH_RADIUS_KM), gmst));
+
+    m_ground.clear();
+    m_groundKm.assign(n, kInf);
+    m_next.assign(n, -1);
+    const double mask = (double)m_params.groundMaskDeg * PI / 180.0;
+
+    using Item = std::pair<float, uint32_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+    for (size_t k = 0; k < n; ++k) {
+        if (!m_ok[k]) continue;
+        double rangeKm = 0.0;
+        const glm::dvec3 ecef = PassPredictor::temeToEcef(glm::dvec3(m_pos[k]), gmst);
+        if (PassPredictor::elevationEcefRad(ecef, st, EARTH_RADIUS_KM, &rangeKm) < mask) continue;
+        m_ground.push_back((uint32_t)k);
+        m_groundKm[k] = (float)rangeKm;
+        open.emplace((float)rangeKm, (uint32_t)k);
+    }
+
+    // adjacency (CSR) over the links
+    std::vector<uint32_t> start(n + 1, 0), adj(m_links.size() * 2);
+    std::vector<float> w(m_links.size() * 2);
+    for (const SatLink& l : m_links) {
+        start[l.a + 1]++;
+        start[l.b + 1]++;
+    }
+    std::partial_sum(start.begin(), start.end(), start.begin());
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    for (const SatLink& l : m_links) {
+        adj[fill[l.a]] = l.b;
+        w[fill[l.a]++] = l.rangeKm;
+        adj[fill[l.b]] = l.a;
+        w[fill[l.b]++] = l.rangeKm;
+    }
+
+    // Dijkstra outward from the station
+    while (!open.empty()) {
+        const auto [d, u] = open.top();
+        open.pop();
+        if (d > m_groundKm[u]) continue;
+        for (uint32_t i = start[u]; i < start[u + 1]; ++i) {
+            const uint32_t v = adj[i];
+            const float nd = d + w[i];
+            if (nd < m_groundKm[v]) {
+                m_groundKm[v] = nd;
+                m_next[v] = (int32_t)u;
+                open.emplace(nd, v);
+            }
+        }
+    }
+
+    // components by union-find
+    std::vector<uint32_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0u);
+    auto find = [&](uint32_t x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    for (const SatLink& l : m_links) parent[find(l.a)] = find(l.b);
+    std::vector<uint32_t> size(n, 0);
+    m_components = m_largest = m_reachable = 0;
+    for (size_t k = 0; k < n; ++k) {
+        if (!m_ok[k]) continue;
+        if (++size[find((uint32_t)k)] == 1) m_components++;
+        if (m_groundKm[k] < kInf) m_reachable++;
+    }
+    for (uint32_t v : size) m_largest = std::max<size_t>(m_largest, v);
+}
+
+bool LinkGraph::pathToGround(size_t slot, std::vector<uint32_t>& outSlots, float* outKm) const {
+    outSlots.clear();
+    if (slot >= m_groundKm.size() || !(m_groundKm[slot] < kInf)) return false;
+    for (int32_t k = (int32_t)slot; k >= 0 && outSlots.size() <= m_members.size(); k = m_next[(size_t)k])
+        outSlots.push_back((uint32_t)k);
+    if (outKm) *outKm = m_groundKm[slot];
+    return true;
+}
+
+void LinkGraph::buildSegments(float kmToRender, std::vector<glm::vec3>& out) const {
+    out.resize(m_links.size() * 2);
+    for (size_t i = 0; i < m_links.size(); ++i) {
+        out[2 * i] = m_pos[m_links[i].a] * kmToRender;
+        out[2 * i + 1] = m_pos[m_links[i].b] * kmToRender;
+    }
+}
+
+bool LinkGraph::exportCsv(const std::string& path, const Sgp4System& sys, const std::string& stationName, bool append) const {
+    bool fresh = !append;
+    if (append) {
+        std::ifstream probe(path);
+        fresh = !probe.is_open() || probe.peek() == std::ifstream::traits_type::eof();
+    }
+    std::ofstream f(path, append ? std::ios::app : std::ios::trunc);
+    if (!f.is_open()) return false;
+
+    if (fresh) f << "t_sec,from,to,range_km\n";
+    for (const SatLink& l : m_links)
+        f << m_t << "," << sys.name(m_members[l.a]) << "," << sys.name(m_members[l.b]) << "," << l.rangeKm << "\n";
+    for (uint32_t k : m_ground)
+        f << m_t << "," << sys.name(m_members[k]) << "," << stationName << "," << glm::length(m_pos[k] - m_stationKm) << "\n";
+    return (bool)f;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "PassPredictor.h"
+
+class Sgp4System;
+
+struct LinkParams {
+    float maxRangeKm = 5000.0f;
+    float grazingAltKm = 80.0f;  // a link must clear the Earth by this much
+    int maxLinksPerSat = 0;      // terminals per satellite, nearest first; 0 = unlimited
+    float groundMaskDeg = 25.0f; // min elevation for a ground link
+    float skinKm = 600.0f;       // neighbour-list margin, see LinkGraph
+};
+
+// member slots, a < b
+struct SatLink {
+    uint32_t a = 0;
+    uint32_t b = 0;
+    float rangeKm = 0.0f;
+};
+
+// Line-of-sight links inside a set of satellites, plus links down to one
+// ground station and the shortest (by path length) route from every member
+// to it.
+//
+// Pairs within range + skin come from a uniform grid and are kept as a
+// neighbour list; later updates only re-test those pairs (range and Earth
+// occlusion, in flat loops over the candidates) until some member has moved
+// half the skin since the list was built, which is when a pair outside it
+// could have come into range.
+class LinkGraph {
+public:
+    // Catalog indices; a different set or different params start over.
+    void setMembers(std::vector<uint32_t> members);
+    const std::vector<uint32_t>& members() const { return m_members; }
+
+    // gmst rotates the station from Earth-fixed into the TEME frame the sats are in.
+    void update(const Sgp4System& sys, double tSec, const LinkParams& p, const GroundStation& st, double gmst);
+
+    bool valid() const { return m_updated; }
+    double timeSec() const { return m_t; }
+    const std::vector<SatLink>& links() const { return m_links; }
+    const std::vector<uint32_t>& groundLinks() const { return m_ground; } // member slots that see the station
+
+    // change against the previous update
+    size_t linksAdded() const { return m_added; }
+    size_t linksRemoved() const { return m_removed; }
+
+    size_t candidatePairs() const { return m_pairA.size(); }
+    size_t neighbourRebuilds() const { return m_rebuilds; }
+    size_t componentCount() const { return m_components; }
+    size_t largestComponent() const { return m_largest; }
+    size_t reachableCount() const { return m_reachable; }
+    double lastUpdateMs() const { return m_ms; }
+
+    // slot of a catalog index, -1 if not a member
+    int slotOf(uint32_t catalogIdx) const;
+    bool positionKm(size_t slot, glm::vec3& out) const;
+    const glm::vec3& stationKm() const { return m_stationKm; }
+
+    // route to the station: slots from the member down, empty if unreachable
+    bool pathToGround(size_t slot, std::vector<uint32_t>& outSlots, float* outKm = nullptr) const;
+
+    // two vertices per link, scaled by kmToRender
+    void buildSegments(float kmToRender, std::vector<glm::vec3>& out) const;
+
+    // t_sec,from,to,range_km for every link of this step; ground links name the
+    // station. Appends when asked, writing the header only to a new file.
+    bool exportCsv(const std::string& path, const Sgp4System& sys, const std::string& stationName, bool append) const;
+
+private:
+    std::vector<uint32_t> m_members;
+    LinkParams m_params;
+    bool m_updated = false;
+    double m_t = 0.0;
+    double m_ms = 0.0;
+
+    std::vector<glm::vec3> m_pos; // km, per slot
+    std::vector<char> m_ok;
+
+    // neighbour list: candidate pairs within range + skin when built
+    bool m_listValid = false;
+    std::vector<glm::vec3> m_refPos;
+    std::vector<char> m_refOk;
+    std::vector<uint32_t> m_pairA, m_pairB; // sorted by (a, b)
+    size_t m_rebuilds = 0;
+
+    std::vector<SatLink> m_links; // sorted by (a, b)
+    size_t m_added = 0, m_removed = 0;
+
+    std::vector<uint32_t> m_ground;
+    glm::vec3 m_stationKm{0.0f};
+    std::vector<float> m_groundKm;  // shortest path length, inf if none
+    std::vector<int32_t> m_next;    // next slot toward the station, -1 = straight down
+    size_t m_components = 0, m_largest = 0, m_reachable = 0;
+
+    void buildNeighbours();
+    void testCandidates();
+    void buildRoutes(const GroundStation& st, double gmst);
+};
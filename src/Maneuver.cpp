@@ -0,0 +1,190 @@
+#include "Maneuver.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+bool ManeuveredTrajectory::build(const Sgp4System& sys, size_t idx, const Burn& burn, double tEndSec, double stepSec) {
+    m_sys = nullptr;
+
+    glm::dvec3 r, v;
+    if (idx >= sys.count() || !sys.sampleStateKm(idx, burn.tSec, r, v)) return false;
+
+    const glm::dvec3 R = glm::normalize(r);
+    const glm::dvec3 N = glm::normalize(glm::cross(r, v));
+    const glm::dvec3 T = glm::cross(N, R);
+    const glm::dvec3 dv = (burn.dvRtnMS.x * R + burn.dvRtnMS.y * T + burn.dvRtnMS.z * N) * 1e-3;
+
+    // two objects, so every step is kept
+    NumericalParams np;
+    np.stepSec = std::max(1.0, stepSec);
+    np.outputSec = np.stepSec;
+    const double bc = NumericalPropagator::ballisticFromBstar(sys.catalogElements(idx).bstar);
+    m_pair.reset(burn.tSec, np);
+    m_pair.add((uint32_t)idx, r, v, bc);
+    m_pair.add((uint32_t)idx, r, v + dv, bc);
+    m_pair.propagateTo(std::max(burn.tSec, tEndSec));
+
+    m_idx = idx;
+    m_t0 = burn.tSec;
+    m_sys = &sys;
+    return true;
+}
+
+bool ManeuveredTrajectory::stateKm(double tSec, glm::dvec3& posKm, glm::dvec3& velKmS) const {
+    if (!m_sys || !m_sys->sampleStateKm(m_idx, tSec, posKm, velKmS)) return false;
+    if (tSec < m_t0) return true;
+
+    glm::dvec3 ra, va, rb, vb;
+    if (!m_pair.sampleStateKm(0, tSec, ra, va) || !m_pair.sampleStateKm(1, tSec, rb, vb)) return false;
+    posKm += rb - ra;
+    velKmS += vb - va;
+    return true;
+}
+
+bool SecondaryEphemeris::build(const Sgp4System& sys, size_t primary, double t0Sec, const ConjunctionParams& p, double padKm) {
+    const auto c0 = std::chrono::steady_clock::now();
+    m_steps = 0;
+    m_ids.clear();
+    if (primary >= sys.count()) return false;
+
+    m_primary = primary;
+    m_params = p;
+    m_t0 = t0Sec;
+    m_dt = std::max(1.0, p.stepSec);
+    const size_t steps = (size_t)std::ceil(std::max(1.0, p.horizonSec) / m_dt) + 1;
+
+    const size_t maxCheck = std::min(sys.count(), (size_t)std::max(1, p.maxSatsToCheck));
+    std::vector<size_t> ids;
+    screeningCandidates(sys, p, primary, maxCheck, ids, padKm);
+    for (size_t id : ids)
+        if (id != primary) m_ids.push_back((uint32_t)id);
+
+    m_pos.assign(m_ids.size() * steps, glm::vec3(0.0f));
+    m_ok.assign(m_ids.size() * steps, 0);
+    parallelFor(m_ids.size(), 16, [&](size_t begin, size_t end, unsigned) {
+        for (size_t k = begin; k < end; ++k) {
+            for (size_t s = 0; s < steps; ++s) {
+                glm::dvec3 pos;
+                const size_t i = k * steps + s;
+                m_ok[i] = sys.sampleKm(m_ids[k], m_t0 + (double)s * m_dt, pos) ? 1 : 0;
+                m_pos[i] = glm::vec3(pos);
+            }
+        }
+    });
+
+    m_steps = steps;
+    m_buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+    return true;
+}
+
+ManeuverResult evaluateManeuver(
+    const Sgp4System& sys,
+    const SecondaryEphemeris& eph,
+    const Burn& burn,
+    const CovarianceCatalog& cov,
+    const PcParams& pc,
+    const std::vector<ConjunctionHit>* baseline)
+{
+    const auto c0 = std::chrono::steady_clock::now();
+    ManeuverResult out;
+    if (!eph.valid()) return out;
+
+    const size_t primary = eph.primary();
+    const double dt = eph.stepSec();
+    const size_t steps = eph.steps();
+    const ConjunctionParams& p = eph.params();
+
+    ManeuveredTrajectory traj;
+    if (!traj.build(sys, primary, burn, eph.t1Sec() + dt)) return out;
+
+    // the only object propagated per candidate burn
+    std::vector<glm::dvec3> prim(steps);
+    std::vector<char> primOk(steps);
+    for (size_t s = 0; s < steps; ++s) {
+        glm::dvec3 v;
+        primOk[s] = traj.stateKm(eph.t0Sec() + (double)s * dt, prim[s], v) ? 1 : 0;
+    }
+
+    const double thresh = std::max(0.1, p.thresholdKm);
+    const double thresh2 = thresh * thresh;
+    const ObjectCovariance primCov = cov.forObject(sys, primary);
+    PcParams quad = pc;
+    quad.monteCarlo = false;
+
+    // secondaries of the baseline encounters are reported whatever the burn does to them
+    std::vector<char> followed(eph.objectCount(), 0);
+    if (baseline) {
+        for (const ConjunctionHit& b : *baseline) {
+            for (size_t k = 0; k < eph.objectCount(); ++k)
+                if ((int)eph.objectIndex(k) == b.otherIdx) followed[k] = 1;
+        }
+    }
+
+    std::vector<std::vector<ConjunctionHit>> found(workerCount()), cleared(workerCount());
+    parallelFor(eph.objectCount(), 64, [&](size_t begin, size_t end, unsigned w) {
+        for (size_t k = begin; k < end; ++k) {
+            double bestD2 = 1e300;
+            size_t bestS = 0;
+            for (size_t s = 0; s < steps; ++s) {
+                glm::dvec3 po;
+                if (!primOk[s] || !eph.sample(k, s, po)) continue;
+                const glm::dvec3 d = po - prim[s];
+                const double d2 = glm::dot(d, d);
+                if (d2 < bestD2) {
+                    bestD2 = d2;
+                    bestS = s;
+                }
+            }
+            if (bestD2 > thresh2 && !followed[k]) continue;
+
+            const size_t other = eph.objectIndex(k);
+            const double coarseT = eph.t0Sec() + (double)bestS * dt;
+            double tca = coarseT;
+            double miss = std::sqrt(bestD2);
+            if (p.refine) {
+                const double fineDt = std::max(0.5, dt / 10.0);
+                for (double t = coarseT - dt; t <= coarseT + dt; t += fineDt) {
+                    glm::dvec3 rp, vp, ro;
+                    if (!traj.stateKm(t, rp, vp) || !sys.sampleKm(other, t, ro)) continue;
+                    const double d = glm::length(ro - rp);
+                    if (d < miss) {
+                        miss = d;
+                        tca = t;
+                    }
+                }
+            }
+
+            ConjunctionHit hit;
+            hit.otherIdx = (int)other;
+            hit.tcaSec = tca;
+            hit.missKm = miss;
+
+            glm::dvec3 r1, v1, r2, v2;
+            if (traj.stateKm(tca, r1, v1) && sys.sampleStateKm(other, tca, r2, v2)) {
+                hit.relSpeedKmS = glm::length(v2 - v1);
+                const ObjectCovariance otherCov = cov.forObject(sys, other);
+                const EncounterPc e = encounterPc(
+                    r1, v1, rtnToEci(r1, v1, primCov.sigmaRtnKm),
+                    r2, v2, rtnToEci(r2, v2, otherCov.sigmaRtnKm),
+                    primCov.hardBodyRadiusKm + otherCov.hardBodyRadiusKm, quad);
+                if (e.valid) hit.pc = e.pc;
+            }
+            (miss <= thresh ? found : cleared)[w].push_back(hit);
+        }
+    });
+
+    auto byMiss = [](const ConjunctionHit& a, const ConjunctionHit& b) { return a.missKm < b.missKm; };
+    for (const auto& f : found) out.hits.insert(out.hits.end(), f.begin(), f.end());
+    std::sort(out.hits.begin(), out.hits.end(), byMiss);
+    for (const auto& c : cleared) out.avoided.insert(out.avoided.end(), c.begin(), c.end());
+    std::sort(out.avoided.begin(), out.avoided.end(), byMiss);
+
+    out.minMissKm = out.hits.empty() ? 0.0 : out.hits.front().missKm;
+    for (const ConjunctionHit& h : out.hits) out.maxPc = std::max(out.maxPc, h.pc);
+    out.valid = true;
+    out.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+    return out;
+}
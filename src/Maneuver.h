@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Conjunction.h"
+#include "CollisionProbability.h"
+#include "NumericalPropagator.h"
+
+class Sgp4System;
+
+// Impulsive burn in the object's radial / in-track / cross-track frame.
+struct Burn {
+    double tSec = 0.0;
+    glm::dvec3 dvRtnMS{0.0};
+};
+
+// A TLE cannot take an impulse, so after the burn the object is SGP4 plus
+// the difference between two Cowell integrations (NumericalPropagator's
+// zonal and drag model) started from the SGP4 state, one with the impulse
+// and one without. Their shared model error cancels and only the burn's
+// effect is added.
+class ManeuveredTrajectory {
+public:
+    bool build(const Sgp4System& sys, size_t idx, const Burn& burn, double tEndSec, double stepSec = 10.0);
+
+    bool valid() const { return m_sys != nullptr; }
+    bool stateKm(double tSec, glm::dvec3& posKm, glm::dvec3& velKmS) const;
+
+private:
+    const Sgp4System* m_sys = nullptr;
+    size_t m_idx = 0;
+    double m_t0 = 0.0;
+
+    // slot 0 without the impulse, slot 1 with it
+    NumericalPropagator m_pair;
+};
+
+// Coarse positions of one primary's candidate secondaries over a window,
+// propagated once and reused for every candidate burn. Candidates come from
+// the perigee/apogee pre-filter widened by padKm, enough to cover the
+// altitude change of the burns being explored.
+class SecondaryEphemeris {
+public:
+    bool build(const Sgp4System& sys, size_t primary, double t0Sec, const ConjunctionParams& p, double padKm);
+
+    bool valid() const { return m_steps > 0; }
+    size_t primary() const { return m_primary; }
+    double t0Sec() const { return m_t0; }
+    double t1Sec() const { return m_t0 + (double)(m_steps - 1) * m_dt; }
+    size_t objectCount() const { return m_ids.size(); }
+    const ConjunctionParams& params() const { return m_params; }
+    double buildMs() const { return m_buildMs; }
+
+    size_t steps() const { return m_steps; }
+    double stepSec() const { return m_dt; }
+    uint32_t objectIndex(size_t k) const { return m_ids[k]; }
+    bool sample(size_t k, size_t step, glm::dvec3& posKm) const {
+        const size_t i = k * m_steps + step;
+        posKm = glm::dvec3(m_pos[i]);
+        return m_ok[i] != 0;
+    }
+
+private:
+    size_t m_primary = (size_t)-1;
+    double m_t0 = 0.0;
+    double m_dt = 20.0;
+    size_t m_steps = 0;
+    ConjunctionParams m_params;
+    std::vector<uint32_t> m_ids;
+    std::vector<glm::vec3> m_pos; // [object * m_steps + step], km
+    std::vector<char> m_ok;
+    double m_buildMs = 0.0;
+};
+
+struct ManeuverResult {
+    bool valid = false;
+    std::vector<ConjunctionHit> hits; // sorted by miss
+    // baseline secondaries the burn moves outside the threshold, with their
+    // closest approach after the burn; sorted by miss
+    std::vector<ConjunctionHit> avoided;
+    double minMissKm = 0.0;
+    double maxPc = 0.0;
+    double ms = 0.0;
+};
+
+// Re-screens only the maneuvered primary against the cached secondaries; a
+// zero burn gives the baseline. Secondaries in baseline are followed even
+// when the burn clears them (see avoided). Pc uses the quadrature only (no
+// Monte Carlo).
+ManeuverResult evaluateManeuver(
+    const Sgp4System& sys,
+    const SecondaryEphemeris& eph,
+    const Burn& burn,
+    const CovarianceCatalog& cov,
+    const PcParams& pc,
+    const std::vector<ConjunctionHit>* baseline = nullptr
+);
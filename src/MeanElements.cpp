@@ -0,0 +1,161 @@
+#include "MeanElements.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <cmath>
+#include <algorithm>
+
+// WGS-72, matching the constants SGP4 uses for the TLE mean motion
+static constexpr double MU_KM3_S2 = 398600.8;
+static constexpr double RE_KM = 6378.135;
+static constexpr double J2 = 0.001082616;
+static constexpr double PI = 3.14159265358979323846;
+
+bool fitMeanElements(const glm::dvec3& r, const glm::dvec3& v, double meanMotionRadS,
+                     double epochSec, MeanElements& out) {
+    out = MeanElements{};
+
+    const double rn = glm::length(r);
+    const double v2 = glm::dot(v, v);
+    if (rn < 1e-3 || meanMotionRadS <= 0.0) return false;
+
+    const double invA = 2.0 / rn - v2 / MU_KM3_S2;
+    if (invA <= 0.0) return false;
+    const double a = 1.0 / invA;
+
+    const glm::dvec3 h = glm::cross(r, v);
+    const double hn = glm::length(h);
+    if (hn < 1e-9) return false;
+    const glm::dvec3 hHat = h / hn;
+
+    const glm::dvec3 eVec = ((v2 - MU_KM3_S2 / rn) * r - glm::dot(r, v) * v) / MU_KM3_S2;
+    const double e = glm::length(eVec);
+    if (e >= 0.99) return false;
+
+    const double inc = std::acos(std::clamp(hHat.z, -1.0, 1.0));
+
+    // node line; equatorial orbits fall back to +x so raan = 0
+    glm::dvec3 nHat(-h.y, h.x, 0.0);
+    const double nn = glm::length(nHat);
+    nHat = (nn > 1e-9 * hn) ? nHat / nn : glm::dvec3(1.0, 0.0, 0.0);
+    const glm::dvec3 wHat = glm::cross(hHat, nHat);
+
+    const double raan = std::atan2(nHat.y, nHat.x);
+    const double u = std::atan2(glm::dot(r, wHat), glm::dot(r, nHat));
+    const double argp = (e > 1e-8) ? std::atan2(glm::dot(eVec, wHat), glm::dot(eVec, nHat)) : 0.0;
+    const double nu = u - argp;
+
+    const double E = std::atan2(std::sqrt(1.0 - e * e) * std::sin(nu), e + std::cos(nu));
+    const double M = E - e * std::sin(E);
+
+    // un-Kozai the TLE mean motion (same recovery as SGP4 init), then the
+    // classic secular J2 rates
+    const double ci = std::cos(inc), si2 = 1.0 - ci * ci;
+    const double beta2 = 1.0 - e * e;
+    const double ke = std::sqrt(MU_KM3_S2 / (RE_KM * RE_KM * RE_KM)); // rad/s in Earth radii
+    const double a1 = std::pow(ke / meanMotionRadS, 2.0 / 3.0);
+    const double k = 0.75 * J2 * (3.0 * ci * ci - 1.0) / std::pow(beta2, 1.5);
+    const double d1 = k / (a1 * a1);
+    const double a0 = a1 * (1.0 - d1 / 3.0 - d1 * d1 - 134.0 / 81.0 * d1 * d1 * d1);
+    const double n0 = meanMotionRadS / (1.0 + k / (a0 * a0));
+
+    const double p = a0 * beta2; // Earth radii
+    const double f = 1.5 * J2 * n0 / (p * p);
+
+    out.aKm = (float)a;
+    out.e = (float)e;
+    out.inc = (float)inc;
+    out.m0 = (float)M;
+    out.raan0 = (float)raan;
+    out.argp0 = (float)argp;
+    out.mDot = (float)(n0 + f * std::sqrt(beta2) * (1.0 - 1.5 * si2));
+    out.raanDot = (float)(-f * ci);
+    out.argpDot = (float)(f * (2.0 - 2.5 * si2));
+    out.epochSec = (float)epochSec;
+    out.valid = 1.0f;
+    return true;
+}
+
+glm::dvec3 evalMeanElementsKm(const MeanElements& el, double dtSec) {
+    if (el.valid < 0.5f) return glm::dvec3(0.0);
+
+    const double dt = dtSec - (double)el.epochSec;
+    const double e = el.e;
+    const double M = std::remainder((double)el.m0 + (double)el.mDot * dt, 2.0 * PI);
+    const double raan = (double)el.raan0 + (double)el.raanDot * dt;
+    const double argp = (double)el.argp0 + (double)el.argpDot * dt;
+
+    double E = (e < 0.8) ? M : PI;
+    for (int it = 0; it < 8; ++it)
+        E -= (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+
+    const double xp = el.aKm * (std::cos(E) - e);
+    const double yp = el.aKm * std::sqrt(1.0 - e * e) * std::sin(E);
+
+    const double cO = std::cos(raan), sO = std::sin(raan);
+    const double cw = std::cos(argp), sw = std::sin(argp);
+    const double ci = std::cos((double)el.inc), si = std::sin((double)el.inc);
+
+    const glm::dvec3 P(cO * cw - sO * sw * ci, sO * cw + cO * sw * ci, sw * si);
+    const glm::dvec3 Q(-cO * sw - sO * cw * ci, -sO * sw + cO * cw * ci, cw * si);
+    return xp * P + yp * Q;
+}
+
+bool MeanElementSet::fitOne(const Sgp4System& sys, size_t idx, double tSec, MeanElements& out) const {
+    glm::dvec3 r, v;
+    const double T = sys.periodSeconds(idx);
+    if (T <= 0.0 || !sys.sampleStateKm(idx, tSec, r, v)) {
+        out = MeanElements{};
+        return false;
+    }
+    return fitMeanElements(r, v, 2.0 * PI / T, tSec - m_baseSec, out);
+}
+
+void MeanElementSet::resyncAll(const Sgp4System& sys, double tSec) {
+    m_baseSec = tSec;
+    m_lastFullSync = tSec;
+    m_el.assign(sys.count(), MeanElements{});
+
+    parallelFor(m_el.size(), 256, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) fitOne(sys, i, tSec, m_el[i]);
+    });
+
+    m_synced = true;
+    m_cursor = 0;
+    m_allDirty = true;
+    m_dirty.clear();
+}
+
+double MeanElementSet::checkAndRepair(const Sgp4System& sys, double tSec, size_t count, double boundKm, size_t& repaired) {
+    repaired = 0;
+    if (m_el.empty() || count == 0) return 0.0;
+
+    count = std::min(count, m_el.size());
+    double worst = 0.0;
+    for (size_t k = 0; k < count; ++k) {
+        const size_t i = (m_cursor + k) % m_el.size();
+
+        glm::dvec3 ref;
+        if (!sys.sampleKm(i, tSec, ref)) continue;
+
+        const double err = glm::length(evalMeanElementsKm(m_el[i], tSec - m_baseSec) - ref);
+        worst = std::max(worst, err);
+        if (err > boundKm) {
+            fitOne(sys, i, tSec, m_el[i]);
+            m_dirty.push_back((uint32_t)i);
+            repaired++;
+        }
+    }
+    m_cursor = (m_cursor + count) % m_el.size();
+    return worst;
+}
+
+glm::vec3 MeanElementSet::positionAt(size_t idx, double tSec, float scale) const {
+    if (idx >= m_el.size()) return glm::vec3(0.0f);
+    return glm::vec3(evalMeanElementsKm(m_el[idx], tSec - m_baseSec)) * scale;
+}
+
+void MeanElementSet::clearDirty() {
+    m_allDirty = false;
+    m_dirty.clear();
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+class Sgp4System;
+
+// Display-only stand-in for SGP4: Keplerian elements fitted to an SGP4 state
+// at a sync time, advanced with secular J2 rates. Laid out as three vec4
+// vertex attributes so the GPU (shaders/satprop.vert) and the CPU reference
+// below evaluate exactly the same numbers.
+struct MeanElements {
+    float aKm, e, inc, m0;             // shape at epoch, M at epoch
+    float raan0, argp0, mDot, raanDot; // rad, rad/s
+    float argpDot, epochSec, valid, pad; // epochSec is relative to the set base
+};
+static_assert(sizeof(MeanElements) == 48, "MeanElements must stay 3 x vec4");
+
+// Fits elements to an ECI state. meanMotionRadS is the TLE (Kozai) mean motion;
+// it drives the secular rates so the fit does not inherit the short-period
+// wobble of the osculating semi-major axis.
+bool fitMeanElements(const glm::dvec3& rKm, const glm::dvec3& vKmS, double meanMotionRadS,
+                     double epochSec, MeanElements& out);
+
+// CPU reference of the GPU model. dtSec is time since the set base.
+glm::dvec3 evalMeanElementsKm(const MeanElements& el, double dtSec);
+
+class MeanElementSet {
+public:
+    size_t count() const { return m_el.size(); }
+    const std::vector<MeanElements>& elements() const { return m_el; }
+
+    double baseSec() const { return m_baseSec; }
+    double lastFullSyncSec() const { return m_lastFullSync; }
+    bool synced() const { return m_synced; }
+
+    // Refit every object against SGP4 at tSec and move the base there.
+    void resyncAll(const Sgp4System& sys, double tSec);
+
+    // Compares `count` objects (rotating) against SGP4 and refits the ones
+    // further than boundKm away. Returns the largest error seen.
+    double checkAndRepair(const Sgp4System& sys, double tSec, size_t count, double boundKm, size_t& repaired);
+
+    glm::vec3 positionAt(size_t idx, double tSec, float scale) const;
+
+    // Indices refit since the last clearDirty(); allDirty after resyncAll().
+    bool allDirty() const { return m_allDirty; }
+    const std::vector<uint32_t>& dirty() const { return m_dirty; }
+    void clearDirty();
+
+private:
+    std::vector<MeanElements> m_el;
+    double m_baseSec = 0.0;
+    double m_lastFullSync = 0.0;
+    bool m_synced = false;
+    size_t m_cursor = 0;
+
+    bool m_allDirty = false;
+    std::vector<uint32_t> m_dirty;
+
+    bool fitOne(const Sgp4System& sys, size_t idx, double tSec, MeanElements& out) const;
+};
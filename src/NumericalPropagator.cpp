@@ -0,0 +1,277 @@
+#include "NumericalPropagator.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static constexpr double kDecayAltKm = 90.0;
+static constexpr uint32_t kAlive = UINT32_MAX;
+
+// Exponential atmosphere (Vallado table 8-4): base altitude km, base density kg/m^3, scale height km.
+struct AtmosphereBand {
+    double h0, rho0, H;
+};
+static constexpr AtmosphereBand kAtmosphere[] = {
+    {0, 1.225, 7.249},           {25, 3.899e-2, 6.349},       {30, 1.774e-2, 6.682},       {40, 3.972e-3, 7.554},
+    {50, 1.057e-3, 8.382},       {60, 3.206e-4, 7.714},       {70, 8.770e-5, 6.549},       {80, 1.905e-5, 5.799},
+    {90, 3.396e-6, 5.382},       {100, 5.297e-7, 5.877},      {110, 9.661e-8, 7.263},      {120, 2.438e-8, 9.473},
+    {130, 8.484e-9, 12.636},     {140, 3.845e-9, 16.149},     {150, 2.070e-9, 22.523},     {180, 5.464e-10, 29.740},
+    {200, 2.789e-10, 37.105},    {250, 7.248e-11, 45.546},    {300, 2.418e-11, 53.628},    {350, 9.518e-12, 53.298},
+    {400, 3.725e-12, 58.515},    {450, 1.585e-12, 60.828},    {500, 6.967e-13, 63.822},    {600, 1.454e-13, 71.835},
+    {700, 3.614e-14, 88.667},    {800, 1.170e-14, 124.64},    {900, 5.245e-15, 181.05},    {1000, 3.019e-15, 268.00},
+};
+
+static double atmosphereDensity(double altKm) {
+    if (altKm < 0.0) altKm = 0.0;
+    size_t b = 0;
+    while (b + 1 < sizeof(kAtmosphere) / sizeof(kAtmosphere[0]) && altKm >= kAtmosphere[b + 1].h0) b++;
+    return kAtmosphere[b].rho0 * std::exp(-(altKm - kAtmosphere[b].h0) / kAtmosphere[b].H);
+}
+
+// Force model over objects [b, e) of SoA state; writes accelerations (km/s^2).
+static void accelerations(const NumericalParams& p, size_t b, size_t e, const double* bc,
+                          const double* x, const double* y, const double* z,
+                          const double* vx, const double* vy, const double* vz,
+                          double* ax, double* ay, double* az) {
+    const int degree = std::clamp(p.zonalDegree, 0, 6);
+
+    for (size_t i = b; i < e; ++i) {
+        const double r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        const double r = std::sqrt(r2);
+        const double k = -MU_KM3_S2 / (r2 * r);
+        ax[i] = k * x[i];
+        ay[i] = k * y[i];
+        az[i] = k * z[i];
+    }
+
+    if (degree >= 2) {
+        for (size_t i = b; i < e; ++i) {
+            const double r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+            const double r = std::sqrt(r2);
+            const double s = z[i] / r;
+            const double q = EARTH_RADIUS_KM / r;
+
+            // a_n = mu Jn (Re/r)^n / r^2 [((n+1) Pn + s Pn') r_hat - Pn' z_hat]
+            double P0 = 1.0, P1 = s, dP0 = 0.0, dP1 = 1.0;
+            double qn = q;
+            double radial = 0.0, polar = 0.0;
+            for (int n = 2; n <= degree; ++n) {
+                const double Pn = ((2.0 * n - 1.0) * s * P1 - (n - 1.0) * P0) / n;
+                const double dPn = n * P1 + s * dP1;
+                qn *= q;
+                radial += ZONAL_J[n] * qn * ((n + 1.0) * Pn + s * dPn);
+                polar += ZONAL_J[n] * qn * dPn;
+                P0 = P1;
+                P1 = Pn;
+                dP0 = dP1;
+                dP1 = dPn;
+            }
+            (void)dP0;
+
+            const double f = MU_KM3_S2 / r2;
+            ax[i] += f * radial * x[i] / r;
+            ay[i] += f * radial * y[i] / r;
+            az[i] += f * (radial * s - polar);
+        }
+    }
+
+    if (p.drag) {
+        for (size_t i = b; i < e; ++i) {
+            if (bc[i] <= 0.0) continue;
+            const double r = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+            const double rho = atmosphereDensity(r - EARTH_RADIUS_KM);
+
+            // velocity relative to the co-rotating atmosphere
+            const double wx = vx[i] + EARTH_ROT_RAD_S * y[i];
+            const double wy = vy[i] - EARTH_ROT_RAD_S * x[i];
+            const double wz = vz[i];
+            const double w = std::sqrt(wx * wx + wy * wy + wz * wz);
+
+            // -1/2 B rho |v| v with v in m/s, back to km/s^2
+            const double d = -0.5 * bc[i] * rho * w * 1e3;
+            ax[i] += d * wx;
+            ay[i] += d * wy;
+            az[i] += d * wz;
+        }
+    }
+}
+
+double NumericalPropagator::historyBytesFor(size_t objects, double spanSec, const NumericalParams& p) {
+    const double step = std::max(1.0, p.stepSec);
+    const double outDt = std::max(1.0, std::round(p.outputSec / step)) * step;
+    const double records = std::ceil(std::max(0.0, spanSec) / outDt) + 1.0;
+    return (double)objects * records * 6.0 * sizeof(double);
+}
+
+void NumericalPropagator::reset(double epochSec, const NumericalParams& p) {
+    m_p = p;
+    m_p.stepSec = std::max(1.0, p.stepSec);
+    m_stride = (size_t)std::max(1.0, std::round(p.outputSec / m_p.stepSec));
+    m_outDt = (double)m_stride * m_p.stepSec;
+    m_t0 = epochSec;
+    m_records = 0;
+    m_obj.clear();
+    m_bc.clear();
+    m_lastRecord.clear();
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_vx.clear();
+    m_vy.clear();
+    m_vz.clear();
+    m_hist.clear();
+}
+
+double NumericalPropagator::ballisticFromBstar(double bstar) {
+    // B* = rho0 * B / 2
+    return 2.0 * bstar / BSTAR_RHO0;
+}
+
+size_t NumericalPropagator::add(uint32_t objectIdx, const glm::dvec3& posKm, const glm::dvec3& velKmS, double bcM2Kg) {
+    m_obj.push_back(objectIdx);
+    m_bc.push_back(std::max(0.0, bcM2Kg));
+    m_lastRecord.push_back(kAlive);
+    m_x.push_back(posKm.x);
+    m_y.push_back(posKm.y);
+    m_z.push_back(posKm.z);
+    m_vx.push_back(velKmS.x);
+    m_vy.push_back(velKmS.y);
+    m_vz.push_back(velKmS.z);
+    return m_obj.size() - 1;
+}
+
+void NumericalPropagator::seedFromSgp4(const Sgp4System& sys, const std::vector<uint32_t>& objects, double epochSec, const NumericalParams& p) {
+    reset(epochSec, p);
+    for (uint32_t idx : objects) {
+        glm::dvec3 r, v;
+        if (!sys.sampleSgp4StateKm(idx, epochSec, r, v)) continue;
+        add(idx, r, v, ballisticFromBstar(sys.catalogElements(idx).bstar));
+    }
+}
+
+void NumericalPropagator::appendHistory() {
+    const size_t n = m_obj.size();
+    const std::vector<double>* comp[6] = {&m_x, &m_y, &m_z, &m_vx, &m_vy, &m_vz};
+    for (const std::vector<double>* c : comp) m_hist.insert(m_hist.end(), c->begin(), c->begin() + (std::ptrdiff_t)n);
+    m_records++;
+}
+
+void NumericalPropagator::propagateTo(double tEndSec) {
+    const auto c0 = std::chrono::steady_clock::now();
+    const size_t n = m_obj.size();
+    if (n == 0) return;
+    if (m_records == 0) {
+        appendHistory();
+        const double rDecay = EARTH_RADIUS_KM + kDecayAltKm;
+        for (size_t i = 0; i < n; ++i)
+            if (m_x[i] * m_x[i] + m_y[i] * m_y[i] + m_z[i] * m_z[i] < rDecay * rDecay) m_lastRecord[i] = 0;
+    }
+
+    const double h = m_p.stepSec;
+    const size_t target = (size_t)std::ceil(std::max(0.0, tEndSec - m_t0) / m_outDt) + 1;
+    if (target <= m_records) return;
+    const size_t first = m_records;
+    const size_t newRecords = target - first;
+    m_hist.resize(target * 6 * n);
+
+    // each worker advances its own slice through every step; no sync between steps
+    parallelFor(n, 256, [&](size_t b, size_t e, unsigned) {
+        const size_t m = e - b;
+        std::vector<double> k(6 * 4 * m); // 4 stages of (dx dy dz dvx dvy dvz)
+        std::vector<double> t(6 * m);     // stage state
+        double* tx = &t[0 * m]; double* ty = &t[1 * m]; double* tz = &t[2 * m];
+        double* tvx = &t[3 * m]; double* tvy = &t[4 * m]; double* tvz = &t[5 * m];
+
+        double* x = m_x.data() + b; double* y = m_y.data() + b; double* z = m_z.data() + b;
+        double* vx = m_vx.data() + b; double* vy = m_vy.data() + b; double* vz = m_vz.data() + b;
+        double* st[6] = {x, y, z, vx, vy, vz};
+        const double* bc = m_bc.data() + b;
+        uint32_t* lastRecord = m_lastRecord.data() + b;
+        const double rDecay = EARTH_RADIUS_KM + kDecayAltKm;
+
+        auto stage = [&](int s, double scale, int prev) {
+            double* kk = &k[(size_t)s * 6 * m];
+            if (prev < 0) {
+                std::copy(x, x + m, tx); std::copy(y, y + m, ty); std::copy(z, z + m, tz);
+                std::copy(vx, vx + m, tvx); std::copy(vy, vy + m, tvy); std::copy(vz, vz + m, tvz);
+            } else {
+                const double* kp = &k[(size_t)prev * 6 * m];
+                const double a = scale * h;
+                for (size_t i = 0; i < m; ++i) {
+                    tx[i] = x[i] + a * kp[0 * m + i];
+                    ty[i] = y[i] + a * kp[1 * m + i];
+                    tz[i] = z[i] + a * kp[2 * m + i];
+                    tvx[i] = vx[i] + a * kp[3 * m + i];
+                    tvy[i] = vy[i] + a * kp[4 * m + i];
+                    tvz[i] = vz[i] + a * kp[5 * m + i];
+                }
+            }
+            std::copy(tvx, tvx + m, kk + 0 * m);
+            std::copy(tvy, tvy + m, kk + 1 * m);
+            std::copy(tvz, tvz + m, kk + 2 * m);
+            accelerations(m_p, 0, m, bc, tx, ty, tz, tvx, tvy, tvz, kk + 3 * m, kk + 4 * m, kk + 5 * m);
+        };
+
+        for (size_t rec = first; rec < first + newRecords; ++rec) {
+            for (size_t sub = 0; sub < m_stride; ++sub) {
+                stage(0, 0.0, -1);
+                stage(1, 0.5, 0);
+                stage(2, 0.5, 1);
+                stage(3, 1.0, 2);
+
+                const double w = h / 6.0;
+                for (int c = 0; c < 6; ++c) {
+                    const double* k1 = &k[(0 * 6 + (size_t)c) * m];
+                    const double* k2 = &k[(1 * 6 + (size_t)c) * m];
+                    const double* k3 = &k[(2 * 6 + (size_t)c) * m];
+                    const double* k4 = &k[(3 * 6 + (size_t)c) * m];
+                    double* sc = st[c];
+                    for (size_t i = 0; i < m; ++i) sc[i] += w * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+                }
+
+                // re-entered objects are pinned to their last good record so the
+                // dense atmosphere never reaches the integrator
+                for (size_t i = 0; i < m; ++i) {
+                    if (lastRecord[i] == kAlive && x[i] * x[i] + y[i] * y[i] + z[i] * z[i] >= rDecay * rDecay) continue;
+                    if (lastRecord[i] == kAlive) lastRecord[i] = (uint32_t)(rec - 1);
+                    for (int c = 0; c < 6; ++c) st[c][i] = m_hist[((size_t)lastRecord[i] * 6 + (size_t)c) * n + b + i];
+                }
+            }
+
+            for (int c = 0; c < 6; ++c) std::copy(st[c], st[c] + m, &m_hist[(rec * 6 + (size_t)c) * n + b]);
+        }
+    });
+
+    m_records = target;
+    m_lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+}
+
+size_t NumericalPropagator::decayedCount(double tSec) const {
+    size_t c = 0;
+    for (uint32_t r : m_lastRecord)
+        if (r != kAlive && m_t0 + (double)r * m_outDt < tSec) c++;
+    return c;
+}
+
+bool NumericalPropagator::sampleStateKm(size_t slot, double tSec, glm::dvec3& posKm, glm::dvec3& velKmS) const {
+    const size_t n = m_obj.size();
+    if (slot >= n || m_records < 2 || tSec < m_t0 || tSec > t1Sec()) return false;
+
+    const double h = m_outDt;
+    const double u = (tSec - m_t0) / h;
+    const size_t k = std::min((size_t)u, m_records - 2);
+    const double s = u - (double)k;
+    if (m_lastRecord[slot] != kAlive && (double)k + s > (double)m_lastRecord[slot]) return false;
+
+    auto at = [&](size_t rec, int c) { return m_hist[(rec * 6 + (size_t)c) * n + slot]; };
+    const glm::dvec3 p0(at(k, 0), at(k, 1), at(k, 2)), v0(at(k, 3), at(k, 4), at(k, 5));
+    const glm::dvec3 p1(at(k + 1, 0), at(k + 1, 1), at(k + 1, 2)), v1(at(k + 1, 3), at(k + 1, 4), at(k + 1, 5));
+
+    const double s2 = s * s, s3 = s2 * s;
+    posKm = (2.0 * s3 - 3.0 * s2 + 1.0) * p0 + (s3 - 2.0 * s2 + s) * h * v0 + (-2.0 * s3 + 3.0 * s2) * p1 + (s3 - s2) * h * v1;
+    velKmS = ((6.0 * s2 - 6.0 * s) * p0 + (3.0 * s2 - 4.0 * s + 1.0) * h * v0 + (-6.0 * s2 + 6.0 * s) * p1 + (3.0 * s2 - 2.0 * s) * h * v1) / h;
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Sgp4System;
+
+struct NumericalParams {
+    int zonalDegree = 6;   // 0 = two-body, n >= 2 adds J2..Jn (up to J6)
+    bool drag = true;      // exponential atmosphere, co-rotating with the Earth
+    double stepSec = 30.0; // fixed RK4 step
+    double outputSec = 0.0; // spacing of stored states, whole steps; 0 = every step
+};
+
+// Cowell propagation of many objects in lockstep. States are kept
+// structure-of-arrays so each RK4 stage is one pass of the force model over
+// contiguous x[], y[], z[] ... that the compiler can vectorize; workers take
+// slices of objects. States are stored every outputSec and queries between
+// them are cubic Hermite on position and velocity (dense output). An object
+// that sinks below the decay altitude is frozen there and stops answering.
+class NumericalPropagator {
+public:
+    // Drops all objects and history; new ones start at epochSec.
+    void reset(double epochSec, const NumericalParams& p);
+
+    // Cd * A / m from an SGP4 B*.
+    static double ballisticFromBstar(double bstar);
+
+    // TEME km and km/s at the epoch; bcM2Kg = Cd * A / m.
+    size_t add(uint32_t objectIdx, const glm::dvec3& posKm, const glm::dvec3& velKmS, double bcM2Kg);
+
+    // Seeds from the TLE model at the epoch; B* gives the ballistic
+    // coefficient. Objects SGP4 cannot evaluate are skipped.
+    void seedFromSgp4(const Sgp4System& sys, const std::vector<uint32_t>& objects, double epochSec, const NumericalParams& p);
+
+    // Integrates forward to at least tEndSec. Adding objects afterwards is not
+    // supported; reset first.
+    void propagateTo(double tEndSec);
+
+    size_t count() const { return m_obj.size(); }
+    uint32_t objectIndex(size_t slot) const { return m_obj[slot]; }
+    double t0Sec() const { return m_t0; }
+    double t1Sec() const { return m_t0 + (double)(m_records - 1) * m_outDt; }
+    double outputSec() const { return m_outDt; }
+    const NumericalParams& params() const { return m_p; }
+    double ballisticCoeff(size_t slot) const { return m_bc[slot]; }
+    double lastPropagateMs() const { return m_lastMs; }
+    size_t historyBytes() const { return m_hist.size() * sizeof(double); }
+
+    // What historyBytes() will be for this many objects over spanSec.
+    static double historyBytesFor(size_t objects, double spanSec, const NumericalParams& p);
+
+    // Objects that re-entered by tSec.
+    size_t decayedCount(double tSec) const;
+
+    // Same contract as Sgp4System::sampleStateKm; false outside [t0, t1] or after decay.
+    bool sampleStateKm(size_t slot, double tSec, glm::dvec3& posKm, glm::dvec3& velKmS) const;
+
+private:
+    NumericalParams m_p;
+    double m_t0 = 0.0;
+    double m_outDt = 30.0;
+    size_t m_stride = 1;  // integration steps per stored record
+    size_t m_records = 0; // stored epochs, the first being m_t0
+    std::vector<uint32_t> m_obj;
+    std::vector<double> m_bc;
+    std::vector<uint32_t> m_lastRecord; // last record above the decay altitude; UINT32_MAX = still up
+
+    // current state, one array per component
+    std::vector<double> m_x, m_y, m_z, m_vx, m_vy, m_vz;
+    // dense output: [record][component 0..5][object]
+    std::vector<double> m_hist;
+    double m_lastMs = 0.0;
+
+    void appendHistory();
+};
@@ -0,0 +1,134 @@
+#include "OrbitBatch.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "MeanElements.h"
+#include "Parallel.h"
+#include "Shader.h"
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// h in [0, 1): red -> yellow -> green -> cyan -> blue
+static glm::vec3 hueRamp(float h) {
+    h = std::clamp(h, 0.0f, 1.0f) * 0.66f * 6.0f;
+    const float x = 1.0f - std::fabs(std::fmod(h, 2.0f) - 1.0f);
+    if (h < 1.0f) return glm::vec3(1.0f, x, 0.0f);
+    if (h < 2.0f) return glm::vec3(x, 1.0f, 0.0f);
+    if (h < 3.0f) return glm::vec3(0.0f, 1.0f, x);
+    return glm::vec3(0.0f, x, 1.0f);
+}
+
+OrbitBatch::~OrbitBatch() {
+    if (m_inst) glDeleteBuffers(1, &m_inst);
+    if (m_strip) glDeleteBuffers(1, &m_strip);
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+}
+
+void OrbitBatch::init(int samplesPerOrbit) {
+    m_samples = (GLsizei)std::max(8, samplesPerOrbit);
+
+    // closed strip: last sample repeats the first
+    std::vector<glm::vec2> strip((size_t)m_samples + 1);
+    for (GLsizei i = 0; i <= m_samples; ++i) {
+        const double E = 2.0 * PI * (double)i / (double)m_samples;
+        strip[(size_t)i] = glm::vec2((float)std::cos(E), (float)std::sin(E));
+    }
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_strip);
+    glGenBuffers(1, &m_inst);
+
+    glBindVertexArray(m_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_strip);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(strip.size() * sizeof(glm::vec2)), strip.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_inst);
+    glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    const size_t offs[4] = {offsetof(Instance, u), offsetof(Instance, v), offsetof(Instance, c), offsetof(Instance, color)};
+    for (GLuint a = 0; a < 4; ++a) {
+        glEnableVertexAttribArray(1 + a);
+        glVertexAttribPointer(1 + a, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offs[a]);
+        glVertexAttribDivisor(1 + a, 1);
+    }
+
+    glBindVertexArray(0);
+}
+
+void OrbitBatch::build(const Sgp4System& sys, const std::vector<int>& sats, OrbitColorBy colorBy,
+                       const glm::vec4& baseColor, double tSec, float kmToRender) {
+    std::vector<Instance> inst(sats.size());
+    std::vector<char> ok(sats.size(), 0);
+
+    parallelFor(sats.size(), 128, [&](size_t begin, size_t end, unsigned) {
+        for (size_t k = begin; k < end; ++k) {
+            const int s = sats[k];
+            if (s < 0 || (size_t)s >= sys.count()) continue;
+
+            glm::dvec3 r, v;
+            const double T = sys.periodSeconds((size_t)s);
+            MeanElements el;
+            if (T <= 0.0 || !sys.sampleStateKm((size_t)s, tSec, r, v)) continue;
+            if (!fitMeanElements(r, v, 2.0 * PI / T, 0.0, el)) continue;
+
+            const double cO = std::cos((double)el.raan0), sO = std::sin((double)el.raan0);
+            const double cw = std::cos((double)el.argp0), sw = std::sin((double)el.argp0);
+            const double ci = std::cos((double)el.inc), si = std::sin((double)el.inc);
+            const glm::dvec3 P(cO * cw - sO * sw * ci, sO * cw + cO * sw * ci, sw * si);
+            const glm::dvec3 Q(-cO * sw - sO * cw * ci, -sO * sw + cO * cw * ci, cw * si);
+
+            const double a = (double)el.aKm * (double)kmToRender;
+            const double b = a * std::sqrt(1.0 - (double)el.e * (double)el.e);
+
+            Instance& o = inst[k];
+            o.u = glm::vec3(P * a);
+            o.v = glm::vec3(Q * b);
+            o.c = glm::vec3(P * (-a * (double)el.e));
+            o.raanDot = el.raanDot;
+            o.pad0 = o.pad1 = 0.0f;
+            switch (colorBy) {
+                case OrbitColorBy::Inclination:
+                    o.color = glm::vec4(hueRamp((float)(el.inc / PI)), baseColor.w);
+                    break;
+                case OrbitColorBy::Altitude: {
+                    // log scale, LEO red .. GEO blue
+                    const double alt = std::max(100.0, (double)el.aKm - EARTH_RADIUS_KM);
+                    const float h = (float)(std::log(alt / 200.0) / std::log(36000.0 / 200.0));
+                    o.color = glm::vec4(hueRamp(h), baseColor.w);
+                    break;
+                }
+                default:
+                    o.color = baseColor;
+                    break;
+            }
+            ok[k] = 1;
+        }
+    });
+
+    size_t n = 0;
+    for (size_t k = 0; k < inst.size(); ++k)
+        if (ok[k]) inst[n++] = inst[k];
+    inst.resize(n);
+
+    m_instances = (GLsizei)n;
+    m_fitSec = tSec;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_inst);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(inst.size() * sizeof(Instance)), inst.empty() ? nullptr : inst.data(), GL_DYNAMIC_DRAW);
+}
+
+void OrbitBatch::clear() {
+    m_instances = 0;
+}
+
+void OrbitBatch::draw(const Shader& sh, double tSec) const {
+    if (m_instances == 0) return;
+
+    sh.setFloat("uDt", (float)(tSec - m_fitSec));
+    glBindVertexArray(m_vao);
+    glDrawArraysInstanced(GL_LINE_STRIP, 0, m_samples + 1, m_instances);
+    glBindVertexArray(0);
+}
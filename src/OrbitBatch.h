@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Sgp4System;
+class Shader;
+
+// Many orbits in one instanced draw. A single shared strip of (cos E, sin E)
+// samples is expanded per instance into the orbit ellipse
+//   p = c + cos(E) * u + sin(E) * v
+// and the instance is spun about the polar axis by its secular RAAN rate,
+// so the per-frame cost does not depend on sim time and geometry is only
+// refit when the element set changes.
+enum class OrbitColorBy { Single, Inclination, Altitude };
+
+class OrbitBatch {
+public:
+    OrbitBatch() = default;
+    ~OrbitBatch();
+
+    void init(int samplesPerOrbit = 128);
+
+    // Fits each sat against SGP4 at tSec; failed fits are dropped.
+    void build(const Sgp4System& sys, const std::vector<int>& sats, OrbitColorBy colorBy,
+               const glm::vec4& baseColor, double tSec, float kmToRender);
+    void clear();
+
+    // Expects orbitbatch.vert bound; sets uDt, view/proj come from FrameUniforms.
+    void draw(const Shader& sh, double tSec) const;
+
+    size_t orbitCount() const { return (size_t)m_instances; }
+    double fitSec() const { return m_fitSec; }
+
+private:
+    struct Instance {
+        glm::vec3 u;
+        float raanDot;
+        glm::vec3 v;
+        float pad0;
+        glm::vec3 c;
+        float pad1;
+        glm::vec4 color;
+    };
+
+    GLuint m_vao = 0;
+    GLuint m_strip = 0;
+    GLuint m_inst = 0;
+    GLsizei m_samples = 0;
+    GLsizei m_instances = 0;
+    double m_fitSec = 0.0;
+};
@@ -5,7 +5,8 @@ OrbitLine::~OrbitLine(){
     if(vao) glDeleteVertexArrays(1, &vao);
 }
 
-void OrbitLine::init(){
+void OrbitLine::init(GLenum drawMode){
+    mode = drawMode;
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
 
@@ -28,6 +29,6 @@ void OrbitLine::update(const std::vector<glm::vec3>& pts){
 
 void OrbitLine::draw() const{
     glBindVertexArray(vao);
-    glDrawArrays(GL_LINE_STRIP, 0, count);
+    glDrawArrays(mode, 0, count);
     glBindVertexArray(0);
 }
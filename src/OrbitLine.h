@@ -8,7 +8,7 @@ public:
     OrbitLine() = default;
     ~OrbitLine();
 
-    void init();
+    void init(GLenum drawMode = GL_LINE_STRIP);
     void update(const std::vector<glm::vec3>& pts);
     void draw() const;
 
@@ -16,4 +16,5 @@ private:
     GLuint vao = 0;
     GLuint vbo = 0;
     GLsizei count = 0;
+    GLenum mode = GL_LINE_STRIP;
 };
@@ -0,0 +1,90 @@
+#include "OrbitLod.h"
+
+#include <cmath>
+#include <algorithm>
+
+OrbitLodView::OrbitLodView(const glm::mat4& VP, const glm::vec3& eyePos, float fovYRad, int viewportH)
+    : eye(eyePos), frustum(Frustum::fromMatrix(VP)) {
+    pixelsPerRadian = 0.5f * (float)std::max(1, viewportH) / std::tan(0.5f * fovYRad);
+}
+
+namespace {
+
+struct Node {
+    double t;
+    glm::vec3 p;
+};
+
+bool failed(const glm::vec3& p) { return p.x == 0.0f && p.y == 0.0f && p.z == 0.0f; }
+
+}
+
+OrbitLodStats tessellateOrbit(
+    const std::function<glm::vec3(double)>& pos,
+    double t0, double t1,
+    const OrbitLodView& view,
+    const OrbitLodParams& p,
+    std::vector<glm::vec3>& out)
+{
+    OrbitLodStats st;
+    if (!(t1 > t0)) return st;
+
+    const int segs = std::max(1, p.initialSegments);
+    const int maxDepth = std::clamp(p.maxDepth, 0, 24);
+    const float budget = std::max(0.05f, p.maxPixelError);
+
+    auto eval = [&](double t) {
+        st.evaluations++;
+        return Node{t, pos(t)};
+    };
+
+    auto pixelError = [&](const Node& a, const Node& m, const Node& b) {
+        const glm::vec3 chordMid = 0.5f * (a.p + b.p);
+        const float dist = std::max(1e-4f, glm::length(m.p - view.eye));
+        float px = glm::length(m.p - chordMid) / dist * view.pixelsPerRadian;
+
+        if (!view.frustum.containsPoint(a.p) && !view.frustum.containsPoint(m.p) &&
+            !view.frustum.containsPoint(b.p))
+            px /= std::max(1.0f, p.offscreenScale);
+        return px;
+    };
+
+    // explicit stack; right half pushed first so vertices come out in time order
+    struct Span {
+        Node a, b;
+        int depth;
+    };
+    std::vector<Span> stack;
+
+    Node prev = eval(t0);
+    out.push_back(prev.p);
+    st.vertices++;
+
+    for (int s = 0; s < segs; ++s) {
+        const Node next = eval(t0 + (t1 - t0) * (double)(s + 1) / (double)segs);
+        stack.push_back({prev, next, 0});
+
+        while (!stack.empty()) {
+            Span sp = stack.back();
+            stack.pop_back();
+
+            bool split = false;
+            Node m{};
+            if (sp.depth < maxDepth && st.evaluations < p.maxSamples &&
+                !failed(sp.a.p) && !failed(sp.b.p)) {
+                m = eval(0.5 * (sp.a.t + sp.b.t));
+                split = !failed(m.p) && pixelError(sp.a, m, sp.b) > budget;
+            }
+
+            if (split) {
+                stack.push_back({m, sp.b, sp.depth + 1});
+                stack.push_back({sp.a, m, sp.depth + 1});
+            } else {
+                out.push_back(sp.b.p);
+                st.vertices++;
+            }
+        }
+        prev = next;
+    }
+    return st;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <glm/glm.hpp>
+
+#include "Culling.h"
+
+struct OrbitLodParams {
+    float maxPixelError = 0.75f;  // chord-to-curve deviation allowed on screen
+    float offscreenScale = 8.0f;  // budget multiplier for spans outside the frustum
+    int initialSegments = 16;     // coarse pass so symmetric arcs can't hide
+    int maxDepth = 12;
+    int maxSamples = 4096;
+};
+
+// Camera for the screen-space metric: angular size of a world-space error
+// seen from the eye, converted to pixels for the current vertical FOV.
+struct OrbitLodView {
+    glm::vec3 eye{0.0f};
+    float pixelsPerRadian = 1.0f;
+    Frustum frustum{};
+
+    OrbitLodView() = default;
+    OrbitLodView(const glm::mat4& VP, const glm::vec3& eyePos, float fovYRad, int viewportH);
+};
+
+struct OrbitLodStats {
+    int vertices = 0;
+    int evaluations = 0;
+};
+
+// Samples pos(t) on [t0, t1], bisecting a span while the true midpoint is
+// further than the pixel budget from its chord. Flat, distant or off-screen
+// spans stay coarse; perigee passes get the samples. Appends to out.
+// pos(t) returning the zero vector marks a failed sample (not subdivided).
+OrbitLodStats tessellateOrbit(
+    const std::function<glm::vec3(double)>& pos,
+    double t0, double t1,
+    const OrbitLodView& view,
+    const OrbitLodParams& p,
+    std::vector<glm::vec3>& out);
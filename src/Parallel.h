@@ -0,0 +1,40 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline unsigned workerCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return std::max(1u, n);
+}
+
+// Runs fn(begin, end, worker) over [0, n) in chunks pulled from a shared
+// counter so uneven per-item cost (decayed sats, long passes) still balances.
+template <class Fn>
+void parallelFor(size_t n, size_t chunk, Fn&& fn) {
+    if (n == 0) return;
+    chunk = std::max<size_t>(1, chunk);
+
+    const unsigned workers = (unsigned)std::min<size_t>(workerCount(), (n + chunk - 1) / chunk);
+    if (workers <= 1) {
+        fn((size_t)0, n, 0u);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto body = [&](unsigned w) {
+        for (;;) {
+            const size_t b = next.fetch_add(chunk);
+            if (b >= n) break;
+            fn(b, std::min(n, b + chunk), w);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) pool.emplace_back(body, w);
+    body(0);
+    for (auto& t : pool) t.join();
+}
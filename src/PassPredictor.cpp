@@ -1,12 +1,16 @@
 #include "PassPredictor.h"
+#include "EarthConstants.h"
 #include "Sgp4System.h"
+#include "Ephemeris.h"
+#include "Eclipse.h"
+#include "Parallel.h"
 
 #include <cmath>
 #include <algorithm>
-#include <ctime>
+#include <utility>
 
-double PassPredictor::deg2rad(double d) { return d * 3.14159265358979323846 / 180.0; }
-double PassPredictor::rad2deg(double r) { return r * 180.0 / 3.14159265358979323846; }
+double PassPredictor::deg2rad(double d) { return d * PI / 180.0; }
+double PassPredictor::rad2deg(double r) { return r * 180.0 / PI; }
 
 glm::vec3 PassPredictor::rotateY(const glm::vec3& v, float a) {
     float c = std::cos(a);
@@ -14,52 +18,6 @@ glm::vec3 PassPredictor::rotateY(const glm::vec3& v, float a) {
     return glm::vec3(c * v.x + s * v.z, v.y, -s * v.x + c * v.z);
 }
 
-double PassPredictor::julianDayUTC(const std::tm& utc, double fracSeconds) {
-    int Y = utc.tm_year + 1900;
-    int M = utc.tm_mon + 1;
-    int D = utc.tm_mday;
-
-    double hour = (double)utc.tm_hour + (double)utc.tm_min / 60.0 + ((double)utc.tm_sec + fracSeconds) / 3600.0;
-
-    if (M <= 2) { Y -= 1; M += 12; }
-    int A = Y / 100;
-    int B = 2 - A + (A / 4);
-
-    double JD = std::floor(365.25 * (Y + 4716)) +
-                std::floor(30.6001 * (M + 1)) +
-                (double)D + (double)B - 1524.5 + hour / 24.0;
-    return JD;
-}
-
-double PassPredictor::gmstRadians_FromUTC(const std::chrono::system_clock::time_point& tpUtc) {
-    using namespace std::chrono;
-    const auto tt = system_clock::to_time_t(tpUtc);
-
-    std::tm utc{};
-#if defined(_WIN32)
-    gmtime_s(&utc, &tt);
-#else
-    gmtime_r(&tt, &utc);
-#endif
-
-    const auto base = system_clock::from_time_t(tt);
-    const double frac = duration<double>(tpUtc - base).count();
-
-    const double JD = julianDayUTC(utc, frac);
-    const double T  = (JD - 2451545.0) / 36525.0;
-
-    double gmstDeg =
-        280.46061837 +
-        360.98564736629 * (JD - 2451545.0) +
-        0.000387933 * T * T -
-        (T * T * T) / 38710000.0;
-
-    gmstDeg = std::fmod(gmstDeg, 360.0);
-    if (gmstDeg < 0) gmstDeg += 360.0;
-
-    return deg2rad(gmstDeg);
-}
-
 glm::vec3 PassPredictor::stationEcefRender(const GroundStation& st, float earthRadiusRender, float earthRadiusKm) {
     const double lat = deg2rad(st.latDeg);
     const double lon = deg2rad(st.lonDeg);
@@ -93,6 +51,47 @@ double PassPredictor::elevationRad_EcefRho(const glm::vec3& rhoEcef, double latR
     return std::atan2(U, horiz);
 }
 
+double PassPredictor::elevationRad_EcefRhoZ(const glm::dvec3& rhoEcef, double latRad, double lonRad) {
+    const double slat = std::sin(latRad), clat = std::cos(latRad);
+    const double slon = std::sin(lonRad), clon = std::cos(lonRad);
+
+    const glm::dvec3 east(-slon, clon, 0.0);
+    const glm::dvec3 north(-slat * clon, -slat * slon, clat);
+    const glm::dvec3 up(clat * clon, clat * slon, slat);
+
+    const double E = glm::dot(east, rhoEcef);
+    const double N = glm::dot(north, rhoEcef);
+    const double U = glm::dot(up, rhoEcef);
+    return std::atan2(U, std::sqrt(E * E + N * N));
+}
+
+glm::dvec3 PassPredictor::temeToEcef(const glm::dvec3& r, double gmst) {
+    const double c = std::cos(gmst), s = std::sin(gmst);
+    return glm::dvec3(c * r.x + s * r.y, -s * r.x + c * r.y, r.z);
+}
+
+glm::dvec3 PassPredictor::ecefToTeme(const glm::dvec3& r, double gmst) {
+    return temeToEcef(r, -gmst);
+}
+
+glm::dvec3 PassPredictor::stationEcefKm(const GroundStation& st, double earthRadiusKm) {
+    const double lat = deg2rad(st.latDeg);
+    const double lon = deg2rad(st.lonDeg);
+    const double r = earthRadiusKm + st.altKm;
+    return glm::dvec3(r * std::cos(lat) * std::cos(lon), r * std::cos(lat) * std::sin(lon), r * std::sin(lat));
+}
+
+double PassPredictor::elevationEcefRad(
+    const glm::dvec3& satEcefKm,
+    const GroundStation& st,
+    double earthRadiusKm,
+    double* outRangeKm
+) {
+    const glm::dvec3 rho = satEcefKm - stationEcefKm(st, earthRadiusKm);
+    if (outRangeKm) *outRangeKm = glm::length(rho);
+    return elevationRad_EcefRhoZ(rho, deg2rad(st.latDeg), deg2rad(st.lonDeg));
+}
+
 double PassPredictor::elevationRad(
     const glm::vec3& satEciRender,
     const GroundStation& st,
@@ -263,3 +262,233 @@ void PassPredictor::predictSelectedSat(
         outPasses.push_back(cur);
     }
 }
+
+double PassPredictor::stationSunElevationRad(
+    const Ephemeris& eph,
+    const GroundStation& st,
+    double tSec,
+    double gmst
+) {
+    // the Sun is far enough away that the geocentric direction is the topocentric one
+    const glm::dvec3 sunEcef = temeToEcef(eph.sunPosKm(tSec), gmst);
+    return elevationRad_EcefRhoZ(sunEcef, deg2rad(st.latDeg), deg2rad(st.lonDeg));
+}
+
+void PassPredictor::predictVisibleCatalog(
+    const Sgp4System& sys,
+    const Ephemeris& eph,
+    float earthRadiusKm,
+    double tStartSec,
+    double horizonSec,
+    double stepSec,
+    const GroundStation& st,
+    double sunMaxElDeg,
+    std::vector<VisiblePass>& outPasses
+) const {
+    outPasses.clear();
+    const size_t N = sys.count();
+    if (N == 0 || horizonSec <= 0.0) return;
+
+    const auto& startUtcTP = eph.startUtc();
+    const double maskRad = deg2rad(st.maskDeg);
+    const double sunMaxRad = deg2rad(sunMaxElDeg);
+    const double tEnd = tStartSec + horizonSec;
+    stepSec = std::max(1.0, stepSec);
+
+    // GMST advances at the sidereal rate; one evaluation anchors the span
+    const double gmst0 = thetaAt(startUtcTP, tStartSec, true, 0.0f);
+    auto gmstAt = [&](double t) { return gmst0 + EARTH_ROT_RAD_S * (t - tStartSec); };
+
+    // shared grid: Earth angle and station darkness are the same for every sat
+    const int steps = (int)std::floor(horizonSec / stepSec) + 1;
+    std::vector<double> times((size_t)steps);
+    std::vector<double> sunEl((size_t)steps);
+    for (int k = 0; k < steps; ++k) {
+        const double t = tStartSec + (double)k * stepSec;
+        times[(size_t)k] = t;
+        sunEl[(size_t)k] = stationSunElevationRad(eph, st, t, gmstAt(t));
+    }
+
+    auto refineDusk = [&](double a, double b) -> double {
+        auto f = [&](double t) { return stationSunElevationRad(eph, st, t, gmstAt(t)) - sunMaxRad; };
+        double fa = f(a);
+        while (b - a > 0.5) {
+            double m = 0.5 * (a + b);
+            double fm = f(m);
+            if (fa * fm <= 0.0) b = m;
+            else { a = m; fa = fm; }
+        }
+        return 0.5 * (a + b);
+    };
+
+    struct Span { double t0, t1; int k0, k1; };
+    std::vector<Span> dark;
+    {
+        bool in = sunEl[0] < sunMaxRad;
+        Span cur{tStartSec, tStartSec, 0, -1};
+        for (int k = 1; k < steps; ++k) {
+            const bool now = sunEl[(size_t)k] < sunMaxRad;
+            if (now == in) continue;
+            const double tc = refineDusk(times[(size_t)k - 1], times[(size_t)k]);
+            if (now) {
+                cur = Span{tc, tc, k, -1};
+            } else {
+                cur.t1 = tc;
+                cur.k1 = k - 1;
+                dark.push_back(cur);
+            }
+            in = now;
+        }
+        if (in) {
+            cur.t1 = tEnd;
+            cur.k1 = steps - 1;
+            dark.push_back(cur);
+        }
+    }
+    if (dark.empty()) return;
+
+    struct Sample {
+        double t = 0.0;
+        double el = 0.0;
+        double rangeKm = 0.0;
+        double pen = 1.0;
+        double umb = 1.0;
+        bool ok = false;
+    };
+
+    auto sampleAt = [&](size_t idx, double t, Sample& s) {
+        s.t = t;
+        glm::dvec3 pKm;
+        s.ok = sys.sampleKm(idx, t, pKm);
+        if (!s.ok) return;
+        s.el = elevationEcefRad(temeToEcef(pKm, gmstAt(t)), st, (double)earthRadiusKm, &s.rangeKm);
+        const ShadowGeometry g = shadowGeometry(pKm, eph.sunPosKm(t));
+        s.pen = penumbraFunction(g);
+        s.umb = umbraFunction(g);
+    };
+
+    // mask crossing inside [a, b], same tolerance as refineCrossingSec
+    auto refineHorizon = [&](size_t idx, double a, double b) -> double {
+        Sample sa, sm;
+        sampleAt(idx, a, sa);
+        double fa = sa.el - maskRad;
+        for (int it = 0; it < 25; ++it) {
+            const double m = 0.5 * (a + b);
+            sampleAt(idx, m, sm);
+            const double fm = sm.el - maskRad;
+            if (fa * fm <= 0.0) b = m;
+            else { a = m; fa = fm; }
+        }
+        return 0.5 * (a + b);
+    };
+
+    std::vector<std::vector<VisiblePass>> perWorker(workerCount());
+
+    parallelFor(N, 32, [&](size_t begin, size_t end, unsigned w) {
+        auto& out = perWorker[w];
+
+        for (size_t idx = begin; idx < end; ++idx) {
+            for (const Span& sp : dark) {
+                VisiblePass cur{};
+                bool open = false;
+
+                auto track = [&](const Sample& s) {
+                    const double eDeg = rad2deg(s.el);
+                    if (eDeg > cur.maxElDeg) {
+                        cur.maxElDeg = eDeg;
+                        cur.tMaxSec = s.t;
+                        cur.rangeAtMaxKm = s.rangeKm;
+                    }
+                };
+                auto openAt = [&](double t, const Sample* known) {
+                    cur = VisiblePass{};
+                    cur.satIndex = (int)idx;
+                    cur.startSec = t;
+                    cur.tMaxSec = t;
+                    cur.maxElDeg = -90.0;
+                    open = true;
+
+                    Sample s;
+                    if (!known) {
+                        sampleAt(idx, t, s);
+                        known = &s;
+                    }
+                    if (known->ok) track(*known);
+                };
+                auto closeAt = [&](double t) {
+                    cur.endSec = t;
+                    cur.stationSunElDeg = rad2deg(stationSunElevationRad(eph, st, cur.tMaxSec, gmstAt(cur.tMaxSec)));
+                    if (cur.endSec > cur.startSec) out.push_back(cur);
+                    open = false;
+                };
+
+                Sample prev;
+                sampleAt(idx, sp.t0, prev);
+                if (!prev.ok) continue;
+
+                bool up = prev.el > maskRad;
+                bool lit = prev.umb > 0.0;
+                bool pen = prev.pen < 0.0;
+                if (up && lit) openAt(sp.t0, &prev);
+
+                const int kEnd = sp.k1 + 1;
+                for (int k = sp.k0; k <= kEnd; ++k) {
+                    Sample s;
+                    if (k == kEnd) {
+                        sampleAt(idx, sp.t1, s);
+                    } else {
+                        if (times[(size_t)k] <= sp.t0 || times[(size_t)k] >= sp.t1) continue;
+                        sampleAt(idx, times[(size_t)k], s);
+                    }
+                    if (!s.ok) break;
+
+                    const bool upNow = s.el > maskRad;
+                    const bool litNow = s.umb > 0.0;
+                    const bool penNow = s.pen < 0.0;
+
+                    // 0 = horizon, 1 = umbra, 2 = penumbra
+                    std::pair<double, int> ev[3];
+                    int nev = 0;
+                    if (upNow != up) ev[nev++] = {refineHorizon(idx, prev.t, s.t), 0};
+                    if (litNow != lit) ev[nev++] = {refineShadowBoundarySec(sys, idx, eph, prev.t, s.t, true), 1};
+                    if (penNow != pen) ev[nev++] = {refineShadowBoundarySec(sys, idx, eph, prev.t, s.t, false), 2};
+                    std::sort(ev, ev + nev);
+
+                    for (int e = 0; e < nev; ++e) {
+                        const double tc = ev[e].first;
+                        const bool wasVis = up && lit;
+
+                        if (ev[e].second == 0) up = !up;
+                        else if (ev[e].second == 1) lit = !lit;
+                        else pen = !pen;
+
+                        const bool isVis = up && lit;
+                        if (!wasVis && isVis) openAt(tc, nullptr);
+
+                        if (open) {
+                            if (ev[e].second == 1) (lit ? cur.umbraExitSec : cur.umbraEntrySec) = tc;
+                            if (ev[e].second == 2) (pen ? cur.penumbraEntrySec : cur.penumbraExitSec) = tc;
+                        }
+
+                        if (wasVis && !isVis) closeAt(tc);
+                    }
+
+                    up = upNow;
+                    lit = litNow;
+                    pen = penNow;
+                    if (open) track(s);
+                    prev = s;
+                }
+
+                if (open) closeAt(prev.t);
+            }
+        }
+    });
+
+    for (auto& v : perWorker)
+        outPasses.insert(outPasses.end(), v.begin(), v.end());
+
+    std::sort(outPasses.begin(), outPasses.end(), [](const VisiblePass& a, const VisiblePass& b) {
+        return a.startSec < b.startSec;
+    });
+}
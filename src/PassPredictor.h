@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 
 class Sgp4System;
+class Ephemeris;
 
 struct GroundStation {
     std::string name = "Station";
@@ -25,6 +26,25 @@ struct PassEvent {
     double rangeAtMaxKm = 0.0;
 };
 
+// Optical window: sat above the mask, not in umbra, station sun below sunMaxElDeg.
+// Eclipse times are -1 unless they fall inside (or bound) the window.
+struct VisiblePass {
+    int satIndex = -1;
+
+    double startSec = 0.0;
+    double endSec = 0.0;
+    double tMaxSec = 0.0;
+
+    double maxElDeg = 0.0;
+    double rangeAtMaxKm = 0.0;
+    double stationSunElDeg = 0.0;
+
+    double penumbraEntrySec = -1.0;
+    double penumbraExitSec = -1.0;
+    double umbraEntrySec = -1.0;
+    double umbraExitSec = -1.0;
+};
+
 class PassPredictor {
 public:
     void predictSelectedSat(
@@ -42,6 +62,39 @@ public:
         std::vector<PassEvent>& outPasses
     ) const;
 
+    // Whole catalog, in parallel. Sats are only propagated while the station is dark.
+    // Works in TEME km and Earth-fixed km (both z north), rotated by GMST.
+    void predictVisibleCatalog(
+        const Sgp4System& sys,
+        const Ephemeris& eph,
+        float earthRadiusKm,
+        double tStartSec,
+        double horizonSec,
+        double stepSec,
+        const GroundStation& st,
+        double sunMaxElDeg,
+        std::vector<VisiblePass>& outPasses
+    ) const;
+
+    static double stationSunElevationRad(
+        const Ephemeris& eph,
+        const GroundStation& st,
+        double tSec,
+        double gmst
+    );
+
+    // z-north Earth-fixed frame, the one SensorAccess and Coverage use
+    static glm::dvec3 temeToEcef(const glm::dvec3& r, double gmst);
+    static glm::dvec3 ecefToTeme(const glm::dvec3& r, double gmst);
+    static glm::dvec3 stationEcefKm(const GroundStation& st, double earthRadiusKm);
+
+    static double elevationEcefRad(
+        const glm::dvec3& satEcefKm,
+        const GroundStation& st,
+        double earthRadiusKm,
+        double* outRangeKm = nullptr
+    );
+
     static glm::vec3 stationEcefRender(
         const GroundStation& st,
         float earthRadiusRender,
@@ -61,9 +114,6 @@ private:
     static double deg2rad(double d);
     static double rad2deg(double r);
 
-    static double julianDayUTC(const std::tm& utc, double fracSeconds);
-    static double gmstRadians_FromUTC(const std::chrono::system_clock::time_point& tpUtc);
-
     static glm::vec3 rotateY(const glm::vec3& v, float a);
 
     static double elevationRad_EcefRho(
@@ -72,6 +122,12 @@ private:
         double lonRad
     );
 
+    static double elevationRad_EcefRhoZ(
+        const glm::dvec3& rhoEcef,
+        double latRad,
+        double lonRad
+    );
+
     double thetaAt(
         const std::chrono::system_clock::time_point& startUtcTP,
         double tSec,
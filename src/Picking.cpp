@@ -0,0 +1,118 @@
+#include "Picking.h"
+
+#include <cmath>
+#include <algorithm>
+
+void ScreenPicker::begin(const glm::mat4& VP, int widthPx, int heightPx, float cellPx) {
+    m_vp = VP;
+    m_w = std::max(1, widthPx);
+    m_h = std::max(1, heightPx);
+    m_cell = std::max(2.0f, cellPx);
+    m_cols = std::max(1, (int)std::ceil((float)m_w / m_cell));
+    m_rows = std::max(1, (int)std::ceil((float)m_h / m_cell));
+    m_pts.clear();
+}
+
+void ScreenPicker::add(int id, const glm::vec3& worldPos, bool occluded) {
+    const glm::vec4 clip = m_vp * glm::vec4(worldPos, 1.0f);
+    if (clip.w <= 0.0f) return;
+
+    const float nx = clip.x / clip.w;
+    const float ny = clip.y / clip.w;
+    if (nx < -1.0f || nx > 1.0f || ny < -1.0f || ny > 1.0f) return;
+
+    Point p;
+    p.px = glm::vec2((nx * 0.5f + 0.5f) * (float)m_w, (0.5f - ny * 0.5f) * (float)m_h);
+    p.id = id;
+    p.occluded = occluded;
+    m_pts.push_back(p);
+}
+
+int ScreenPicker::cellX(float x) const { return std::clamp((int)(x / m_cell), 0, m_cols - 1); }
+int ScreenPicker::cellY(float y) const { return std::clamp((int)(y / m_cell), 0, m_rows - 1); }
+
+void ScreenPicker::finalize() {
+    const size_t cells = (size_t)m_cols * (size_t)m_rows;
+    m_cellStart.assign(cells + 1, 0);
+
+    for (const Point& p : m_pts)
+        m_cellStart[(size_t)cellY(p.px.y) * (size_t)m_cols + (size_t)cellX(p.px.x) + 1]++;
+    for (size_t i = 0; i < cells; ++i) m_cellStart[i + 1] += m_cellStart[i];
+
+    m_cellItems.resize(m_pts.size());
+    std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t i = 0; i < m_pts.size(); ++i) {
+        const Point& p = m_pts[i];
+        m_cellItems[fill[(size_t)cellY(p.px.y) * (size_t)m_cols + (size_t)cellX(p.px.x)]++] = (uint32_t)i;
+    }
+}
+
+template <class Fn>
+void ScreenPicker::forCells(const glm::vec2& lo, const glm::vec2& hi, Fn&& fn) const {
+    if (m_cellStart.empty()) return;
+    if (hi.x < 0.0f || hi.y < 0.0f || lo.x >= (float)m_w || lo.y >= (float)m_h) return;
+
+    const int x0 = cellX(lo.x), x1 = cellX(hi.x);
+    const int y0 = cellY(lo.y), y1 = cellY(hi.y);
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const size_t c = (size_t)y * (size_t)m_cols + (size_t)x;
+            for (uint32_t k = m_cellStart[c]; k < m_cellStart[c + 1]; ++k)
+                fn(m_pts[m_cellItems[k]]);
+        }
+    }
+}
+
+int ScreenPicker::pickNearest(const glm::vec2& mousePx, float radiusPx) const {
+    const float r2 = radiusPx * radiusPx;
+    int bestFront = -1, bestBack = -1;
+    float dFront = r2, dBack = r2;
+
+    forCells(mousePx - glm::vec2(radiusPx), mousePx + glm::vec2(radiusPx), [&](const Point& p) {
+        const glm::vec2 d = p.px - mousePx;
+        const float d2 = glm::dot(d, d);
+        if (!p.occluded && d2 <= dFront) { dFront = d2; bestFront = p.id; }
+        if (p.occluded && d2 <= dBack) { dBack = d2; bestBack = p.id; }
+    });
+
+    return (bestFront >= 0) ? bestFront : bestBack;
+}
+
+void ScreenPicker::pickRect(const glm::vec2& a, const glm::vec2& b, bool includeOccluded, std::vector<int>& out) const {
+    out.clear();
+    const glm::vec2 lo(std::min(a.x, b.x), std::min(a.y, b.y));
+    const glm::vec2 hi(std::max(a.x, b.x), std::max(a.y, b.y));
+
+    forCells(lo, hi, [&](const Point& p) {
+        if (p.occluded && !includeOccluded) return;
+        if (p.px.x >= lo.x && p.px.x <= hi.x && p.px.y >= lo.y && p.px.y <= hi.y) out.push_back(p.id);
+    });
+    std::sort(out.begin(), out.end());
+}
+
+void ScreenPicker::pickLasso(const std::vector<glm::vec2>& poly, bool includeOccluded, std::vector<int>& out) const {
+    out.clear();
+    if (poly.size() < 3) return;
+
+    glm::vec2 lo = poly[0], hi = poly[0];
+    for (const auto& v : poly) {
+        lo = glm::vec2(std::min(lo.x, v.x), std::min(lo.y, v.y));
+        hi = glm::vec2(std::max(hi.x, v.x), std::max(hi.y, v.y));
+    }
+
+    forCells(lo, hi, [&](const Point& p) {
+        if (p.occluded && !includeOccluded) return;
+
+        // even-odd rule
+        bool inside = false;
+        for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+            const glm::vec2& a = poly[i];
+            const glm::vec2& b = poly[j];
+            if ((a.y > p.px.y) != (b.y > p.px.y) &&
+                p.px.x < (b.x - a.x) * (p.px.y - a.y) / (b.y - a.y) + a.x)
+                inside = !inside;
+        }
+        if (inside) out.push_back(p.id);
+    });
+    std::sort(out.begin(), out.end());
+}
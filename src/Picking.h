@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Screen-space uniform grid over the projected satellites, rebuilt each frame
+// from the positions the update pass already produced. Click/hover queries
+// only visit the cells under the pick radius.
+class ScreenPicker {
+public:
+    void begin(const glm::mat4& VP, int widthPx, int heightPx, float cellPx = 16.0f);
+
+    // occluded comes from the culling pass (see Culling.h)
+    void add(int id, const glm::vec3& worldPos, bool occluded);
+    void finalize();
+
+    size_t size() const { return m_pts.size(); }
+
+    // Nearest within radius, preferring points in front of the Earth. -1 if none.
+    int pickNearest(const glm::vec2& mousePx, float radiusPx) const;
+
+    void pickRect(const glm::vec2& a, const glm::vec2& b, bool includeOccluded, std::vector<int>& out) const;
+    void pickLasso(const std::vector<glm::vec2>& poly, bool includeOccluded, std::vector<int>& out) const;
+
+private:
+    struct Point {
+        glm::vec2 px;
+        int id;
+        bool occluded;
+    };
+
+    glm::mat4 m_vp{1.0f};
+    int m_w = 1, m_h = 1;
+    float m_cell = 16.0f;
+    int m_cols = 1, m_rows = 1;
+
+    std::vector<Point> m_pts;
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_cellItems;
+
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+    template <class Fn>
+    void forCells(const glm::vec2& lo, const glm::vec2& hi, Fn&& fn) const;
+};
@@ -0,0 +1,315 @@
+#include "Profiler.h"
+
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+
+#include "imgui.h"
+
+// p in [0, 1]; negative samples mean "no data" and are skipped
+static float percentile(std::vector<float> v, float p) {
+    v.erase(std::remove_if(v.begin(), v.end(), [](float x) { return x < 0.0f; }), v.end());
+    if (v.empty()) return 0.0f;
+    const size_t k = std::min(v.size() - 1, (size_t)(p * (float)(v.size() - 1) + 0.5f));
+    std::nth_element(v.begin(), v.begin() + (std::ptrdiff_t)k, v.end());
+    return v[k];
+}
+
+static float mean(const std::vector<float>& v) {
+    double sum = 0.0;
+    int n = 0;
+    for (float x : v) {
+        if (x < 0.0f) continue;
+        sum += x;
+        n++;
+    }
+    return n ? (float)(sum / n) : 0.0f;
+}
+
+Profiler::~Profiler() {
+    destroy();
+}
+
+void Profiler::init(int historyFrames) {
+    m_history = std::max(kLatency + 2, historyFrames);
+    m_head = 0;
+    m_filled = 0;
+    m_frameMs.assign((size_t)m_history, 0.0f);
+    m_cpuFrameMs.assign((size_t)m_history, 0.0f);
+    for (Stage& s : m_stages) {
+        s.cpuMs.assign((size_t)m_history, 0.0f);
+        s.gpuMs.assign((size_t)m_history, -1.0f);
+    }
+    m_origin = Clock::now();
+    m_lastFrame = Clock::time_point{};
+}
+
+void Profiler::destroy() {
+    for (GpuFrame& f : m_gpu) {
+        if (!f.pool.empty()) glDeleteQueries((GLsizei)f.pool.size(), f.pool.data());
+        f = GpuFrame{};
+    }
+}
+
+int Profiler::stage(const char* name, bool gpu) {
+    for (size_t i = 0; i < m_stages.size(); ++i)
+        if (m_stages[i].name == name) return (int)i;
+
+    Stage s;
+    s.name = name;
+    s.gpu = gpu;
+    s.cpuMs.assign((size_t)m_history, 0.0f);
+    s.gpuMs.assign((size_t)m_history, -1.0f);
+    m_stages.push_back(std::move(s));
+    m_open.push_back(-1);
+    m_openQuery.push_back(0);
+    return (int)m_stages.size() - 1;
+}
+
+int64_t Profiler::nowUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_origin).count();
+}
+
+GLuint Profiler::query(GpuFrame& f) {
+    if (f.used == f.pool.size()) {
+        GLuint q = 0;
+        glGenQueries(1, &q);
+        f.pool.push_back(q);
+    }
+    return f.pool[f.used++];
+}
+
+void Profiler::collect(GpuFrame& f) {
+    if (f.events.empty() || f.historySlot < 0) return;
+
+    // queries complete in order, so the last one stands for the frame;
+    // if it still isn't back the frame's GPU numbers are dropped, never waited on
+    GLint ready = 0;
+    glGetQueryObjectiv(f.events.back().q1, GL_QUERY_RESULT_AVAILABLE, &ready);
+    if (!ready) return;
+
+    for (const GpuEvent& e : f.events) {
+        GLuint64 t0 = 0, t1 = 0;
+        glGetQueryObjectui64v(e.q0, GL_QUERY_RESULT, &t0);
+        glGetQueryObjectui64v(e.q1, GL_QUERY_RESULT, &t1);
+        const double ms = (double)(t1 - t0) * 1e-6;
+
+        float& slot = m_stages[(size_t)e.stage].gpuMs[(size_t)f.historySlot];
+        slot = std::max(0.0f, slot) + (float)ms;
+
+        if (f.traced)
+            m_trace.push_back({e.stage, 2, f.cpuRefUs + ((int64_t)t0 - f.gpuRefNs) / 1000, (int64_t)(t1 - t0) / 1000});
+    }
+}
+
+void Profiler::beginFrame() {
+    if (!enabled) return;
+
+    const Clock::time_point now = Clock::now();
+    m_head = (m_head + 1) % m_history;
+    m_frameMs[(size_t)m_head] = (m_lastFrame == Clock::time_point{})
+                                    ? 0.0f
+                                    : (float)std::chrono::duration<double, std::milli>(now - m_lastFrame).count();
+    m_lastFrame = now;
+
+    for (Stage& s : m_stages) {
+        s.cpuMs[(size_t)m_head] = 0.0f;
+        s.gpuMs[(size_t)m_head] = -1.0f;
+        s.cpuAccum = 0.0;
+    }
+
+    m_gpuSlot = (m_gpuSlot + 1) % kLatency;
+    GpuFrame& f = m_gpu[m_gpuSlot];
+    collect(f);
+    f.used = 0;
+    f.events.clear();
+    f.historySlot = m_head;
+    f.traced = m_traceFramesLeft > 0;
+    if (f.traced) {
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        f.gpuRefNs = (int64_t)gpuNow;
+        f.cpuRefUs = nowUs();
+    }
+
+    std::fill(m_open.begin(), m_open.end(), -1);
+    std::fill(m_openQuery.begin(), m_openQuery.end(), 0);
+    m_cpuEvents.clear();
+    m_frameBeginUs = nowUs();
+    m_inFrame = true;
+}
+
+void Profiler::begin(int stage) {
+    if (!m_inFrame || stage < 0 || (size_t)stage >= m_stages.size()) return;
+
+    m_open[(size_t)stage] = nowUs();
+    if (m_stages[(size_t)stage].gpu) {
+        const GLuint q = query(m_gpu[m_gpuSlot]);
+        glQueryCounter(q, GL_TIMESTAMP);
+        m_openQuery[(size_t)stage] = q;
+    }
+}
+
+void Profiler::end(int stage) {
+    if (!m_inFrame || stage < 0 || (size_t)stage >= m_stages.size() || m_open[(size_t)stage] < 0) return;
+
+    const int64_t t = nowUs();
+    const int64_t t0 = m_open[(size_t)stage];
+    m_stages[(size_t)stage].cpuAccum += (double)(t - t0) * 1e-3;
+    m_cpuEvents.push_back({stage, t0, t});
+    m_open[(size_t)stage] = -1;
+
+    if (const GLuint q0 = m_openQuery[(size_t)stage]) {
+        GpuFrame& f = m_gpu[m_gpuSlot];
+        const GLuint q1 = query(f);
+        glQueryCounter(q1, GL_TIMESTAMP);
+        f.events.push_back({stage, q0, q1});
+        m_openQuery[(size_t)stage] = 0;
+    }
+}
+
+void Profiler::endFrame() {
+    if (!m_inFrame) return;
+    m_inFrame = false;
+
+    const int64_t t = nowUs();
+    for (Stage& s : m_stages)
+        s.cpuMs[(size_t)m_head] = (float)s.cpuAccum;
+    m_cpuFrameMs[(size_t)m_head] = (float)((double)(t - m_frameBeginUs) * 1e-3);
+    m_filled = std::min(m_filled + 1, m_history);
+
+    if (m_traceFramesLeft > 0) {
+        m_trace.push_back({-1, 1, m_frameBeginUs, t - m_frameBeginUs});
+        for (const CpuEvent& e : m_cpuEvents)
+            m_trace.push_back({e.stage, 1, e.beginUs, e.endUs - e.beginUs});
+        if (--m_traceFramesLeft == 0) m_traceDrainLeft = kLatency;
+    } else if (m_traceDrainLeft > 0 && --m_traceDrainLeft == 0) {
+        if (writeTrace()) m_lastTracePath = m_tracePath;
+        m_trace.clear();
+    }
+}
+
+void Profiler::startTrace(int frames, const std::string& path) {
+    m_trace.clear();
+    m_tracePath = path;
+    m_traceFramesLeft = std::max(1, frames);
+    m_traceDrainLeft = 0;
+}
+
+bool Profiler::writeTrace() const {
+    std::FILE* f = std::fopen(m_tracePath.c_str(), "w");
+    if (!f) return false;
+
+    auto writeName = [&](const std::string& s) {
+        std::fputc('"', f);
+        for (char c : s) {
+            if (c == '"' || c == '\\') std::fputc('\\', f);
+            std::fputc(c, f);
+        }
+        std::fputc('"', f);
+    };
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU main\"}},\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+    for (const TraceEvent& e : m_trace) {
+        std::fprintf(f, ",\n{\"name\":");
+        writeName(e.stage < 0 ? std::string("frame") : m_stages[(size_t)e.stage].name);
+        std::fprintf(f, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d}",
+                     e.tid == 2 ? "gpu" : "cpu", (long long)e.tsUs, (long long)std::max<int64_t>(0, e.durUs), e.tid);
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+void Profiler::drawUi(bool* open) {
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Checkbox("Enabled", &enabled);
+    if (m_filled == 0) {
+        ImGui::TextDisabled("No frames recorded yet");
+        ImGui::End();
+        return;
+    }
+
+    // history in time order, oldest first
+    auto ordered = [&](const std::vector<float>& ring) {
+        std::vector<float> out((size_t)m_filled);
+        for (int i = 0; i < m_filled; ++i)
+            out[(size_t)i] = ring[(size_t)((m_head - m_filled + 1 + i + m_history) % m_history)];
+        return out;
+    };
+
+    const std::vector<float> frame = ordered(m_frameMs);
+    const std::vector<float> cpuFrame = ordered(m_cpuFrameMs);
+    ImGui::Text("Frame  p50 %.2f | p95 %.2f | p99 %.2f ms", percentile(frame, 0.50f), percentile(frame, 0.95f),
+                percentile(frame, 0.99f));
+    ImGui::Text("CPU    p50 %.2f | p95 %.2f | p99 %.2f ms", percentile(cpuFrame, 0.50f), percentile(cpuFrame, 0.95f),
+                percentile(cpuFrame, 0.99f));
+    ImGui::PlotHistogram("##frame", frame.data(), (int)frame.size(), 0, "frame ms", 0.0f,
+                         std::max(16.7f, percentile(frame, 0.99f) * 1.2f), ImVec2(-1.0f, 60.0f));
+
+    if (ImGui::BeginTable("stages", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("CPU avg");
+        ImGui::TableSetupColumn("CPU p95");
+        ImGui::TableSetupColumn("CPU p99");
+        ImGui::TableSetupColumn("GPU avg");
+        ImGui::TableSetupColumn("GPU p95");
+        ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            const Stage& s = m_stages[i];
+            const std::vector<float> cpu = ordered(s.cpuMs);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(s.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", mean(cpu));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", percentile(cpu, 0.95f));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", percentile(cpu, 0.99f));
+
+            if (s.gpu) {
+                const std::vector<float> gpu = ordered(s.gpuMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", mean(gpu));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", percentile(gpu, 0.95f));
+            } else {
+                ImGui::TableNextColumn();
+                ImGui::TextDisabled("-");
+                ImGui::TableNextColumn();
+                ImGui::TextDisabled("-");
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::PushID((int)i);
+            ImGui::PlotHistogram("##h", cpu.data(), (int)cpu.size(), 0, nullptr, 0.0f,
+                                 std::max(0.1f, percentile(cpu, 0.99f) * 1.2f), ImVec2(-1.0f, 16.0f));
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+    ImGui::SliderInt("Trace frames", &m_traceRequest, 10, 2000, "%d", ImGuiSliderFlags_Logarithmic);
+    if (tracing()) {
+        ImGui::Text("Recording trace... %d frames left", m_traceFramesLeft);
+    } else if (ImGui::Button("Record Chrome trace")) {
+        char path[64];
+        std::snprintf(path, sizeof(path), "trace_%lld.json", (long long)std::time(nullptr));
+        startTrace(m_traceRequest, path);
+    }
+    if (!m_lastTracePath.empty())
+        ImGui::Text("Last trace: %s", m_lastTracePath.c_str());
+
+    ImGui::End();
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <glad/glad.h>
+
+// Per-stage frame instrumentation for the main loop. CPU time comes from
+// steady_clock; stages registered with gpu = true also bracket their GL work
+// with GL_TIMESTAMP queries, read back a few frames later so the driver is
+// never forced to sync. Main thread only.
+class Profiler {
+public:
+    static constexpr int kLatency = 4; // frames a query may stay in flight
+
+    ~Profiler();
+
+    void init(int historyFrames = 240);
+    void destroy();
+
+    // Stable id for a stage; registering the same name twice returns the same id.
+    int stage(const char* name, bool gpu = false);
+
+    void beginFrame();
+    void endFrame();
+
+    // A stage may run several times a frame; its times are summed.
+    void begin(int stage);
+    void end(int stage);
+
+    // Record the next `frames` frames and write them as Chrome trace-event JSON
+    // (chrome://tracing, Perfetto) once their GPU results have come back.
+    void startTrace(int frames, const std::string& path);
+    bool tracing() const { return m_traceFramesLeft > 0 || m_traceDrainLeft > 0; }
+    const std::string& lastTracePath() const { return m_lastTracePath; }
+
+    void drawUi(bool* open);
+
+    bool enabled = true;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stage {
+        std::string name;
+        bool gpu = false;
+        std::vector<float> cpuMs, gpuMs; // rolling history, m_head is the newest slot
+        double cpuAccum = 0.0;
+    };
+
+    struct CpuEvent {
+        int stage;
+        int64_t beginUs, endUs;
+    };
+
+    struct GpuEvent {
+        int stage;
+        GLuint q0, q1;
+    };
+
+    // one per in-flight frame
+    struct GpuFrame {
+        std::vector<GLuint> pool;
+        size_t used = 0;
+        std::vector<GpuEvent> events;
+        int historySlot = -1;
+        bool traced = false;
+        int64_t cpuRefUs = 0;  // CPU clock at the reference GPU timestamp
+        int64_t gpuRefNs = 0;
+    };
+
+    struct TraceEvent {
+        int stage;
+        int tid; // 1 = CPU, 2 = GPU
+        int64_t tsUs, durUs;
+    };
+
+    int m_history = 240;
+    int m_head = 0;
+    int m_filled = 0;
+    std::vector<Stage> m_stages;
+    std::vector<float> m_frameMs, m_cpuFrameMs;
+
+    Clock::time_point m_origin = Clock::now();
+    Clock::time_point m_lastFrame{};
+    int64_t m_frameBeginUs = 0;
+    bool m_inFrame = false;
+    std::vector<int64_t> m_open;       // begin time per stage, -1 when closed
+    std::vector<GLuint> m_openQuery;   // begin query per stage
+    std::vector<CpuEvent> m_cpuEvents; // this frame
+
+    GpuFrame m_gpu[kLatency];
+    int m_gpuSlot = 0;
+
+    std::vector<TraceEvent> m_trace;
+    std::string m_tracePath, m_lastTracePath;
+    int m_traceFramesLeft = 0;
+    int m_traceDrainLeft = 0;
+    int m_traceRequest = 120;
+
+    int64_t nowUs() const;
+    GLuint query(GpuFrame& f);
+    void collect(GpuFrame& f);
+    bool writeTrace() const;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(Profiler& p, int stage) : m_p(p), m_stage(stage) { m_p.begin(m_stage); }
+    ~ProfileScope() { m_p.end(m_stage); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler& m_p;
+    int m_stage;
+};
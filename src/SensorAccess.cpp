@@ -0,0 +1,336 @@
+#include "SensorAccess.h"
+#include "EarthConstants.h"
+#include "Sgp4System.h"
+#include "ElementIndex.h"
+#include "Ephemeris.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+static constexpr double kIncMarginDeg = 1.0;
+
+static double deg2rad(double d) { return d * PI / 180.0; }
+
+namespace {
+
+// site frame and FOV, precomputed once
+struct SensorFrame {
+    glm::dvec3 site{0.0}, east{0.0}, north{0.0}, up{0.0}; // Earth-fixed
+    double latRad = 0.0;
+    FovShape shape = FovShape::Cone;
+    glm::dvec3 bore{0.0}, across{0.0}, vertical{0.0};     // ENU
+    double cosHalf = 0.0, tanHalfW = 0.0, tanHalfH = 0.0;
+    double sinMask = 0.0;
+    bool fullAz = true;
+    double minAz = 0.0, azSpan = 2.0 * PI;
+    double minRange = 0.0, maxRange = 0.0;
+    double elLo = 0.0;                                    // lowest elevation inside the FOV
+    double hMin = 0.0, hMax = 0.0;                        // altitude band the FOV reaches
+};
+
+struct ObjectBounds {
+    double perigeeKm = -1.0, apogeeKm = -1.0;
+    double maxLatRad = PI * 0.5;
+    double rateRadS = 0.0;       // bound on how fast the geocentric direction turns, Earth-fixed
+    bool known = false;
+};
+
+glm::dvec3 enuDir(double azRad, double elRad) {
+    return glm::dvec3(std::sin(azRad) * std::cos(elRad), std::cos(azRad) * std::cos(elRad), std::sin(elRad));
+}
+
+bool inFov(const SensorFrame& s, const glm::dvec3& l) {
+    if (l.z < s.sinMask) return false;
+    if (!s.fullAz) {
+        double rel = std::fmod(std::atan2(l.x, l.y) - s.minAz + 4.0 * PI, 2.0 * PI);
+        if (rel > s.azSpan) return false;
+    }
+    const double c = glm::dot(l, s.bore);
+    if (s.shape == FovShape::Cone) return c >= s.cosHalf;
+    return c > 0.0 && std::fabs(glm::dot(l, s.across)) <= s.tanHalfW * c && std::fabs(glm::dot(l, s.vertical)) <= s.tanHalfH * c;
+}
+
+bool inView(const SensorFrame& s, const glm::dvec3& rEcef, double& elRad, double& rangeKm) {
+    const glm::dvec3 rho = rEcef - s.site;
+    rangeKm = glm::length(rho);
+    if (rangeKm < s.minRange || rangeKm > s.maxRange || rangeKm <= 0.0) return false;
+    const glm::dvec3 l(glm::dot(rho, s.east) / rangeKm, glm::dot(rho, s.north) / rangeKm, glm::dot(rho, s.up) / rangeKm);
+    elRad = std::asin(std::clamp(l.z, -1.0, 1.0));
+    return inFov(s, l);
+}
+
+// altitude of the point at this range and elevation from the site
+double altitudeAt(double siteR, double rangeKm, double elRad) {
+    return std::sqrt(siteR * siteR + rangeKm * rangeKm + 2.0 * siteR * rangeKm * std::sin(elRad)) - EARTH_RADIUS_KM;
+}
+
+SensorFrame makeFrame(const Sensor& sn) {
+    SensorFrame s;
+    const double lat = deg2rad(sn.site.latDeg), lon = deg2rad(sn.site.lonDeg);
+    const double siteR = EARTH_RADIUS_KM + sn.site.altKm;
+    s.latRad = lat;
+    s.up = glm::dvec3(std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat));
+    s.east = glm::dvec3(-std::sin(lon), std::cos(lon), 0.0);
+    s.north = glm::cross(s.up, s.east);
+    s.site = siteR * s.up;
+
+    s.shape = sn.shape;
+    const double az = deg2rad(sn.boresightAzDeg), el = deg2rad(std::clamp(sn.boresightElDeg, -90.0, 90.0));
+    s.bore = enuDir(az, el);
+    s.across = glm::dvec3(std::cos(az), -std::sin(az), 0.0);
+    s.vertical = glm::cross(s.across, s.bore);
+    s.cosHalf = std::cos(deg2rad(std::clamp(sn.halfAngleDeg, 0.0, 180.0)));
+    s.tanHalfW = std::tan(deg2rad(std::clamp(sn.halfWidthDeg, 0.0, 89.9)));
+    s.tanHalfH = std::tan(deg2rad(std::clamp(sn.halfHeightDeg, 0.0, 89.9)));
+    const double mask = deg2rad(std::clamp(sn.site.maskDeg, -90.0, 90.0));
+    s.sinMask = std::sin(mask);
+
+    s.fullAz = sn.maxAzDeg - sn.minAzDeg >= 360.0;
+    s.minAz = deg2rad(sn.minAzDeg);
+    s.azSpan = deg2rad(std::fmod(sn.maxAzDeg - sn.minAzDeg + 720.0, 360.0));
+    s.minRange = std::max(0.0, sn.minRangeKm);
+    s.maxRange = std::max(s.minRange, sn.maxRangeKm);
+
+    // elevation extent of the FOV: exact for the cone; the pyramid's side
+    // edges are great-circle arcs whose extremes can fall between the
+    // corners, so it is bounded by the cone through its corners
+    const double half = sn.shape == FovShape::Cone ? std::acos(s.cosHalf)
+                                                   : std::atan(std::sqrt(s.tanHalfW * s.tanHalfW + s.tanHalfH * s.tanHalfH));
+    const double elLo = el - half;
+    const double elHi = std::min(PI * 0.5, el + half);
+    s.elLo = std::max(elLo, mask);
+    // below the horizon the line of sight dips before it climbs; bound by its lowest point
+    s.hMin = s.elLo >= 0.0 ? altitudeAt(siteR, s.minRange, s.elLo) : siteR * std::cos(s.elLo) - EARTH_RADIUS_KM;
+    s.hMax = altitudeAt(siteR, s.maxRange, std::max(elHi, s.elLo));
+    return s;
+}
+
+ObjectBounds boundsFor(const Sgp4System& sys, const ElementIndex* index, size_t idx) {
+    ObjectBounds b;
+    double inc;
+    if (index && index->count() == sys.count()) {
+        const OrbitShape& s = index->shape(idx);
+        b.perigeeKm = s.perigeeKm;
+        b.apogeeKm = s.apogeeKm;
+        inc = s.inclinationDeg;
+    } else {
+        const Sgp4System::CatalogElements el = sys.catalogElements(idx);
+        const double n = el.meanMotionRevDay * 2.0 * PI / 86400.0;
+        if (n <= 1e-12) return b;
+        const double a = std::cbrt(MU_KM3_S2 / (n * n));
+        const double e = std::clamp(el.eccentricity, 0.0, 0.999);
+        b.perigeeKm = a * (1.0 - e) - EARTH_RADIUS_KM;
+        b.apogeeKm = a * (1.0 + e) - EARTH_RADIUS_KM;
+        inc = el.inclinationDeg;
+    }
+    if (!(b.apogeeKm > 0.0) || b.apogeeKm < b.perigeeKm) return b;
+
+    // h / rp^2 is the fastest the radius vector turns inertially
+    const double rp = std::max(EARTH_RADIUS_KM * 0.5, EARTH_RADIUS_KM + b.perigeeKm);
+    const double ra = EARTH_RADIUS_KM + b.apogeeKm;
+    const double h = std::sqrt(MU_KM3_S2 * 2.0 * rp * ra / (rp + ra));
+    b.rateRadS = h / (rp * rp) + EARTH_ROT_RAD_S;
+
+    const double incFold = inc <= 90.0 ? inc : 180.0 - inc;
+    b.maxLatRad = deg2rad(std::min(90.0, incFold + kIncMarginDeg));
+    b.known = true;
+    return b;
+}
+
+// Earth central half-angle around the site inside which an object no higher than hKm can be in view
+double reachAngle(const SensorFrame& s, double hKm) {
+    const double r = EARTH_RADIUS_KM + std::max(0.0, hKm);
+    return std::acos(std::clamp(EARTH_RADIUS_KM * std::cos(s.elLo) / r, -1.0, 1.0)) - s.elLo;
+}
+
+}
+
+bool SensorAccessResult::exportCsv(const std::string& path, const Sgp4System& sys, const std::vector<Sensor>& sensors) const {
+    std::ofstream f(path);
+    if (!f.is_open()) return false;
+
+    f << "sensor,name,start_sec,end_sec,duration_sec,max_el_deg,min_range_km\n";
+    for (size_t s = 0; s < windows.size(); ++s) {
+        const std::string& sensor = s < sensors.size() ? sensors[s].site.name : std::string("?");
+        for (const AccessWindow& w : windows[s]) {
+            if (w.object >= sys.count()) continue;
+            f << sensor << "," << sys.name(w.object) << "," << w.startSec << "," << w.endSec << ","
+              << (w.endSec - w.startSec) << "," << w.maxElDeg << "," << w.minRangeKm << "\n";
+        }
+    }
+    return (bool)f;
+}
+
+bool computeSensorAccess(
+    const Sgp4System& sys,
+    const std::vector<Sensor>& sensors,
+    const std::vector<uint32_t>* subset,
+    const ElementIndex* index,
+    const std::chrono::system_clock::time_point& startUtcTP,
+    double t0Sec,
+    const AccessParams& p,
+    SensorAccessResult& out)
+{
+    const auto c0 = std::chrono::steady_clock::now();
+    out = SensorAccessResult{};
+    out.t0Sec = t0Sec;
+    out.durationSec = std::max(0.0, p.durationSec);
+    out.windows.resize(sensors.size());
+    if (sensors.empty() || sys.count() == 0) return false;
+
+    const size_t S = sensors.size();
+    std::vector<SensorFrame> frames;
+    frames.reserve(S);
+    for (const Sensor& sn : sensors) frames.push_back(makeFrame(sn));
+
+    std::vector<uint32_t> objects;
+    if (subset) {
+        for (uint32_t i : *subset)
+            if (i < sys.count()) objects.push_back(i);
+    } else {
+        objects.resize(sys.count());
+        for (size_t i = 0; i < objects.size(); ++i) objects[i] = (uint32_t)i;
+    }
+    out.objects = objects.size();
+
+    // GMST advances at the sidereal rate; one evaluation anchors the span
+    const double gmst0 = gmstRadians_FromUTC(
+        startUtcTP + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(t0Sec)));
+    auto toEcef = [gmst0, t0Sec](const glm::dvec3& r, double t) {
+        const double g = gmst0 + EARTH_ROT_RAD_S * (t - t0Sec);
+        const double c = std::cos(g), s = std::sin(g);
+        return glm::dvec3(c * r.x + s * r.y, -s * r.x + c * r.y, r.z);
+    };
+
+    const double t1 = t0Sec + out.durationSec;
+    const double dt = std::max(1.0, p.stepSec);
+    const double tol = std::max(1e-3, p.refineSec);
+    const double inf = std::numeric_limits<double>::infinity();
+
+    const unsigned workers = workerCount();
+    std::vector<std::vector<std::pair<uint32_t, AccessWindow>>> found(workers);
+    std::vector<size_t> samples(workers, 0), pruned(workers, 0);
+
+    parallelFor(objects.size(), 16, [&](size_t begin, size_t end, unsigned w) {
+        std::vector<char> viable(S), open(S);
+        std::vector<double> reach(S);
+        std::vector<AccessWindow> cur(S);
+
+        for (size_t j = begin; j < end; ++j) {
+            const uint32_t obj = objects[j];
+            const ObjectBounds ob = boundsFor(sys, index, obj);
+
+            size_t live = 0;
+            for (size_t s = 0; s < S; ++s) {
+                const SensorFrame& f = frames[s];
+                reach[s] = ob.known ? reachAngle(f, std::min(ob.apogeeKm + kBandMarginKm, f.hMax)) : PI;
+                bool ok = true;
+                if (p.geometryPrune && ob.known) {
+                    ok = ob.apogeeKm + kBandMarginKm >= f.hMin && ob.perigeeKm - kBandMarginKm <= f.hMax &&
+                         std::fabs(f.latRad) - reach[s] <= ob.maxLatRad;
+                }
+                viable[s] = ok ? 1 : 0;
+                open[s] = 0;
+                live += ok ? 1 : 0;
+            }
+            if (live == 0) {
+                pruned[w]++;
+                continue;
+            }
+
+            auto inViewAt = [&](size_t s, double t) {
+                glm::dvec3 r;
+                double el, range;
+                samples[w]++;
+                return sys.sampleKm(obj, t, r) && inView(frames[s], toEcef(r, t), el, range);
+            };
+            // the state flips once inside (a, b]; returns the first time it holds
+            auto crossing = [&](size_t s, double a, double b, bool toInside) {
+                while (b - a > tol) {
+                    const double m = 0.5 * (a + b);
+                    if (inViewAt(s, m) == toInside) b = m;
+                    else a = m;
+                }
+                return b;
+            };
+            auto closeWindow = [&](size_t s, double t) {
+                cur[s].endSec = t;
+                found[w].emplace_back((uint32_t)s, cur[s]);
+                open[s] = 0;
+            };
+
+            double t = t0Sec, prevT = t0Sec;
+            bool first = true;
+            for (;;) {
+                glm::dvec3 r;
+                samples[w]++;
+                const bool ok = sys.sampleKm(obj, t, r);
+                double skip = inf;
+
+                if (!ok) {
+                    // decayed or outside its span: nothing is in view
+                    for (size_t s = 0; s < S; ++s)
+                        if (open[s]) closeWindow(s, prevT);
+                    skip = 0.0;
+                } else {
+                    const glm::dvec3 e = toEcef(r, t);
+                    const double rn = glm::length(e);
+                    for (size_t s = 0; s < S; ++s) {
+                        if (!viable[s]) continue;
+                        const SensorFrame& f = frames[s];
+
+                        const double gamma = std::acos(std::clamp(glm::dot(e, f.up) / rn, -1.0, 1.0));
+                        double el = 0.0, range = 0.0;
+                        bool inside = false;
+                        if (gamma > reach[s] && ob.rateRadS > 0.0) {
+                            skip = std::min(skip, (gamma - reach[s]) / ob.rateRadS);
+                        } else {
+                            inside = inView(f, e, el, range);
+                            skip = 0.0;
+                        }
+
+                        if (inside && !open[s]) {
+                            cur[s] = AccessWindow{};
+                            cur[s].object = obj;
+                            cur[s].startSec = first ? t0Sec : crossing(s, prevT, t, true);
+                            cur[s].maxElDeg = -90.0;
+                            cur[s].minRangeKm = inf;
+                            open[s] = 1;
+                        } else if (!inside && open[s]) {
+                            closeWindow(s, crossing(s, prevT, t, false));
+                        }
+                        if (inside) {
+                            cur[s].maxElDeg = std::max(cur[s].maxElDeg, el * 180.0 / PI);
+                            cur[s].minRangeKm = std::min(cur[s].minRangeKm, range);
+                        }
+                    }
+                }
+
+                if (t >= t1) break;
+                first = false;
+                prevT = t;
+                // skips land back on the step grid, so they never change what is found
+                const double steps = std::max(1.0, std::ceil((t + skip - t0Sec) / dt - 1e-9) - std::round((t - t0Sec) / dt));
+                t = std::min(t1, t + steps * dt);
+            }
+            for (size_t s = 0; s < S; ++s)
+                if (open[s]) closeWindow(s, t1);
+        }
+    });
+
+    for (size_t w = 0; w < workers; ++w) {
+        for (const auto& [s, win] : found[w]) out.windows[s].push_back(win);
+        out.samples += samples[w];
+        out.pruned += pruned[w];
+    }
+    for (std::vector<AccessWindow>& v : out.windows)
+        std::sort(v.begin(), v.end(), [](const AccessWindow& a, const AccessWindow& b) {
+            return a.startSec < b.startSec || (a.startSec == b.startSec && a.object < b.object);
+        });
+
+    out.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - c0).count();
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PassPredictor.h"
+
+class Sgp4System;
+class ElementIndex;
+
+enum class FovShape : uint8_t {
+    Cone = 0,
+    Pyramid = 1
+};
+
+// A ground sensor: the site (its maskDeg is the horizon limit), a field of
+// view around a fixed boresight, and azimuth / range bounds on top.
+struct Sensor {
+    GroundStation site;
+    FovShape shape = FovShape::Cone;
+    double boresightAzDeg = 0.0;   // clockwise from north
+    double boresightElDeg = 90.0;
+    double halfAngleDeg = 60.0;    // cone
+    double halfWidthDeg = 60.0;    // pyramid, horizontal across the boresight
+    double halfHeightDeg = 30.0;   // pyramid, vertical
+    double minAzDeg = 0.0;         // field of regard, clockwise from minAzDeg to maxAzDeg
+    double maxAzDeg = 360.0;
+    double minRangeKm = 0.0;
+    double maxRangeKm = 40000.0;
+};
+
+struct AccessParams {
+    double durationSec = 6.0 * 3600.0;
+    double stepSec = 30.0;       // windows shorter than this can be missed
+    double refineSec = 0.5;      // entry / exit bisection tolerance
+    bool geometryPrune = true;
+};
+
+struct AccessWindow {
+    uint32_t object = 0;
+    double startSec = 0.0;       // clipped to the search span
+    double endSec = 0.0;
+    double maxElDeg = 0.0;       // over the samples inside
+    double minRangeKm = 0.0;
+};
+
+struct SensorAccessResult {
+    double t0Sec = 0.0;
+    double durationSec = 0.0;
+    std::vector<std::vector<AccessWindow>> windows; // per sensor, by start time
+    size_t objects = 0;
+    size_t pruned = 0;           // never visible to any sensor by orbit geometry
+    size_t samples = 0;          // propagations, after time skipping
+    double ms = 0.0;
+
+    // sensor,name,start_sec,end_sec,duration_sec,max_el_deg,min_range_km
+    bool exportCsv(const std::string& path, const Sgp4System& sys, const std::vector<Sensor>& sensors) const;
+};
+
+// Entry and exit times of every object (or the subset) through every sensor's
+// field of view, objects in parallel and each propagated once per step for
+// all sensors. Objects whose altitude band or inclination keeps them out of
+// a sensor's reach are dropped up front (index shapes, when given); while an
+// object is far outside a sensor's horizon circle the sampling jumps ahead by
+// the least time it could need to reach it.
+bool computeSensorAccess(
+    const Sgp4System& sys,
+    const std::vector<Sensor>& sensors,
+    const std::vector<uint32_t>* subset,
+    const ElementIndex* index,
+    const std::chrono::system_clock::time_point& startUtcTP,
+    double t0Sec,
+    const AccessParams& p,
+    SensorAccessResult& out
+);
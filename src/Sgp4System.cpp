@@ -1,8 +1,11 @@
 #include "Sgp4System.h"
+#include "EarthConstants.h"
+#include "NumericalPropagator.h"
 #include "TleLoader.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iostream>
 #include <exception>
 
@@ -11,8 +14,7 @@
 #include "Vector.h"
 #include "DecayedException.h"
 #include "SatelliteException.h"
-
-static constexpr double EARTH_RADIUS_KM = 6378.137;
+#include "TleException.h"
 
 static libsgp4::DateTime nowUtcDateTime()
 {
@@ -43,22 +45,85 @@ bool Sgp4System::loadFromTleFile(const std::string &path)
     if (tles.empty())
         return false;
 
-    m_names.clear();
-    m_sats.clear();
-    m_names.reserve(tles.size());
-    m_sats.reserve(tles.size());
+    // parsed aside and swapped in whole, so a bad element set leaves the current catalog intact
+    std::vector<std::string> names;
+    std::vector<SatImpl> sats;
+    names.reserve(tles.size());
+    sats.reserve(tles.size());
 
     for (const auto &t : tles)
     {
         const std::string name = t.name.empty() ? std::string("SAT") : t.name;
-        libsgp4::Tle tle(name, t.l1, t.l2);
-        m_names.push_back(name);
-        m_sats.emplace_back(tle);
+        try
+        {
+            libsgp4::Tle tle(name, t.l1, t.l2);
+            sats.emplace_back(tle);
+        }
+        catch (const libsgp4::TleException &e)
+        {
+            std::cerr << "[TLE] " << path << ": " << name << ": " << e.what() << "\n";
+            return false;
+        }
+        catch (const libsgp4::SatelliteException &e)
+        {
+            std::cerr << "[TLE] " << path << ": " << name << ": " << e.what() << "\n";
+            return false;
+        }
+        names.push_back(name);
     }
+
+    m_names.swap(names);
+    m_sats.swap(sats);
+    m_num = nullptr;
+    m_numSlot.clear();
+    m_synth = nullptr;
     return true;
 }
 
 bool Sgp4System::sampleKm(size_t idx, double simTimeSec, glm::dvec3 &outPosKm) const
+{
+    glm::dvec3 velKmS(0.0);
+    return sampleStateKm(idx, simTimeSec, outPosKm, velKmS);
+}
+
+bool Sgp4System::sampleStateKm(size_t idx, double simTimeSec, glm::dvec3 &outPosKm, glm::dvec3 &outVelKmS) const
+{
+    if (isSynthetic(idx))
+        return m_synth && m_synth->sampleStateKm(idx - m_sats.size(), simTimeSec, outPosKm, outVelKmS);
+    if (usesNumerical(idx) && m_num->sampleStateKm((size_t)m_numSlot[idx], simTimeSec, outPosKm, outVelKmS))
+        return true;
+    return sampleSgp4StateKm(idx, simTimeSec, outPosKm, outVelKmS);
+}
+
+void Sgp4System::setNumerical(const NumericalPropagator *prop)
+{
+    m_num = prop;
+    m_numSlot.assign(prop ? m_sats.size() : 0, -1);
+    for (size_t slot = 0; prop && slot < prop->count(); ++slot)
+    {
+        const uint32_t idx = prop->objectIndex(slot);
+        if (idx < m_numSlot.size())
+            m_numSlot[idx] = (int32_t)slot;
+    }
+}
+
+size_t Sgp4System::numericalCount() const
+{
+    return (size_t)std::count_if(m_numSlot.begin(), m_numSlot.end(), [](int32_t s)
+                                 { return s >= 0; });
+}
+
+void Sgp4System::setSynthetic(const NumericalPropagator *prop, const std::vector<std::string> &names)
+{
+    m_names.resize(m_sats.size());
+    m_synth = prop;
+    if (!prop)
+        return;
+    for (size_t k = 0; k < prop->count(); ++k)
+        m_names.push_back(k < names.size() ? names[k] : std::string("DEB"));
+}
+
+bool Sgp4System::sampleSgp4StateKm(size_t idx, double simTimeSec, glm::dvec3 &outPosKm, glm::dvec3 &outVelKmS) const
 {
     if (idx >= m_sats.size())
         return false;
@@ -70,7 +135,9 @@ bool Sgp4System::sampleKm(size_t idx, double simTimeSec, glm::dvec3 &outPosKm) c
         libsgp4::DateTime t = startUtc.AddSeconds(simTimeSec);
         libsgp4::Eci eci = m_sats[idx].sgp4.FindPosition(t);
         libsgp4::Vector p = eci.Position(); // km
+        libsgp4::Vector v = eci.Velocity(); // km/s
         outPosKm = glm::dvec3(p.x, p.y, p.z);
+        outVelKmS = glm::dvec3(v.x, v.y, v.z);
         return true;
     }
     catch (const libsgp4::DecayedException &)
@@ -117,8 +184,8 @@ glm::vec3 Sgp4System::sample(size_t idx, float simTimeSec, float earthRadiusRend
 
 void Sgp4System::positionsAt(float simTimeSec, float earthRadiusRender, std::vector<glm::vec3> &outPos) const
 {
-    outPos.resize(m_sats.size());
-    for (size_t i = 0; i < m_sats.size(); ++i)
+    outPos.resize(m_names.size());
+    for (size_t i = 0; i < m_names.size(); ++i)
     {
         outPos[i] = sample(i, simTimeSec, earthRadiusRender);
     }
@@ -126,10 +193,75 @@ void Sgp4System::positionsAt(float simTimeSec, float earthRadiusRender, std::vec
 
 double Sgp4System::periodSeconds(size_t idx) const
 {
-    if (idx >= m_sats.size())
+    if (idx >= m_names.size())
         return 0.0;
-    double mm = m_sats[idx].tle.MeanMotion();
+    double mm = isSynthetic(idx) ? catalogElements(idx).meanMotionRevDay : m_sats[idx].tle.MeanMotion();
     return (mm > 1e-9) ? (86400.0 / mm) : 0.0;
 }
 
+Sgp4System::CatalogElements Sgp4System::catalogElements(size_t idx) const
+{
+    CatalogElements el;
+    if (isSynthetic(idx))
+    {
+        // osculating at the synthetic set's epoch
+        glm::dvec3 r, v;
+        if (!m_synth || !m_synth->sampleStateKm(idx - m_sats.size(), m_synth->t0Sec(), r, v))
+            return el;
+        const glm::dvec3 h = glm::cross(r, v);
+        const glm::dvec3 ev = glm::cross(v, h) / MU_KM3_S2 - r / glm::length(r);
+        const double energy = 0.5 * glm::dot(v, v) - MU_KM3_S2 / glm::length(r);
+        el.inclinationDeg = std::acos(std::clamp(h.z / glm::length(h), -1.0, 1.0)) * 180.0 / PI;
+        el.raanDeg = std::fmod(std::atan2(h.x, -h.y) * 180.0 / PI + 360.0, 360.0);
+        el.eccentricity = glm::length(ev);
+        if (energy < 0.0)
+        {
+            const double a = -MU_KM3_S2 / (2.0 * energy);
+            el.meanMotionRevDay = std::sqrt(MU_KM3_S2 / (a * a * a)) * 86400.0 / (2.0 * PI);
+        }
+        el.bstar = 0.5 * BSTAR_RHO0 * m_synth->ballisticCoeff(idx - m_sats.size());
+        return el;
+    }
+    if (idx >= m_sats.size())
+        return el;
+
+    const libsgp4::Tle &tle = m_sats[idx].tle;
+    el.inclinationDeg = tle.Inclination(true);
+    el.raanDeg = tle.RightAscendingNode(true);
+    el.eccentricity = tle.Eccentricity();
+    el.meanMotionRevDay = tle.MeanMotion();
+    el.bstar = tle.BStar();
+    return el;
+}
 
+unsigned Sgp4System::noradId(size_t idx) const
+{
+    return (idx < m_sats.size()) ? m_sats[idx].tle.NoradNumber() : 0u;
+}
+
+uint64_t Sgp4System::elementsKey(size_t idx) const
+{
+    if (idx >= m_names.size())
+        return 0;
+
+    // FNV-1a over both element lines, or name and epoch elements for synthetic objects
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void *data, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            h ^= static_cast<const unsigned char *>(data)[i];
+            h *= 1099511628211ull;
+        }
+    };
+    if (isSynthetic(idx))
+    {
+        const CatalogElements el = catalogElements(idx);
+        mix(m_names[idx].data(), m_names[idx].size());
+        mix(&el, sizeof(el));
+        return h;
+    }
+    for (const std::string &line : {m_sats[idx].tle.Line1(), m_sats[idx].tle.Line2()})
+        mix(line.data(), line.size());
+    return h;
+}
@@ -1,25 +1,60 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 #include "Tle.h"
 #include "SGP4.h"
 
+class NumericalPropagator;
+
 class Sgp4System {
 public:
     bool loadFromTleFile(const std::string& path);
 
     size_t count() const { return m_names.size(); }
+    size_t catalogCount() const { return m_sats.size(); }
     const std::string& name(size_t i) const { return m_names[i]; }
 
     void positionsAt(float simTimeSec, float earthRadiusRender, std::vector<glm::vec3>& outPos) const;
     glm::vec3 sample(size_t idx, float simTimeSec, float earthRadiusRender) const;
 
     bool sampleKm(size_t idx, double simTimeSec, glm::dvec3& outPosKm) const;
+    bool sampleStateKm(size_t idx, double simTimeSec, glm::dvec3& outPosKm, glm::dvec3& outVelKmS) const;
+    // TLE model only, ignoring any numerical override.
+    bool sampleSgp4StateKm(size_t idx, double simTimeSec, glm::dvec3& outPosKm, glm::dvec3& outVelKmS) const;
+
+    // Objects carried by prop answer every sample*() from its dense output
+    // while the time lies inside its span, SGP4 otherwise. Not safe to change
+    // while other threads sample; a reload drops it.
+    void setNumerical(const NumericalPropagator* prop);
+    bool usesNumerical(size_t idx) const { return idx < m_numSlot.size() && m_numSlot[idx] >= 0; }
+    size_t numericalCount() const;
+
+    // Objects with no TLE (breakup fragments) appended after the catalog: object
+    // catalogCount() + k is slot k of prop and is sampled only from it, with
+    // elements taken from its state at t0. Replaces any previous set; nullptr
+    // drops them. Same threading rule as setNumerical.
+    void setSynthetic(const NumericalPropagator* prop, const std::vector<std::string>& names);
+    bool isSynthetic(size_t idx) const { return idx >= m_sats.size() && idx < m_names.size(); }
 
     double periodSeconds(size_t idx) const;
 
+    // Mean elements as published in the TLE.
+    struct CatalogElements {
+        double inclinationDeg = 0.0;
+        double raanDeg = 0.0;
+        double eccentricity = 0.0;
+        double meanMotionRevDay = 0.0;
+        double bstar = 0.0; // 1/earth radii
+    };
+    CatalogElements catalogElements(size_t idx) const;
+
+    // NORAD id and a fingerprint of the element set, for matching objects across reloads
+    unsigned noradId(size_t idx) const;
+    uint64_t elementsKey(size_t idx) const;
+
 private:
     std::vector<std::string> m_names;
 
@@ -30,4 +65,8 @@ private:
     };
 
     std::vector<SatImpl> m_sats;
+
+    const NumericalPropagator* m_num = nullptr;
+    std::vector<int32_t> m_numSlot; // per object, -1 = SGP4
+    const NumericalPropagator* m_synth = nullptr;
 };
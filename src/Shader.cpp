@@ -1,7 +1,9 @@
 #include "Shader.h"
+#include "FrameUniforms.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 std::string Shader::readFile(const std::string& path) {
     std::ifstream f(path, std::ios::binary);
@@ -55,6 +57,39 @@ bool Shader::load(const std::string& vsPath, const std::string& fsPath){
     glDeleteShader(v);
     glDeleteShader(f);
 
+    if(!checkLink(p)) return false;
+
+    if(m_id) glDeleteProgram(m_id);
+    m_id = p;
+    reflect();
+    return true;
+}
+
+bool Shader::loadFeedback(const std::string& vsPath, const std::vector<std::string>& varyings){
+    std::string vs = readFile(vsPath);
+    if(vs.empty() || varyings.empty()) return false;
+
+    GLuint v = compile(GL_VERTEX_SHADER, vs, vsPath);
+
+    GLuint p = glCreateProgram();
+    glAttachShader(p, v);
+
+    std::vector<const char*> names;
+    for(const auto& n : varyings) names.push_back(n.c_str());
+    glTransformFeedbackVaryings(p, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+
+    glLinkProgram(p);
+    glDeleteShader(v);
+
+    if(!checkLink(p)) return false;
+
+    if(m_id) glDeleteProgram(m_id);
+    m_id = p;
+    reflect();
+    return true;
+}
+
+bool Shader::checkLink(GLuint p){
     GLint ok = 0;
     glGetProgramiv(p, GL_LINK_STATUS, &ok);
     if(!ok){
@@ -65,31 +100,53 @@ bool Shader::load(const std::string& vsPath, const std::string& fsPath){
         glDeleteProgram(p);
         return false;
     }
-
-    if(m_id) glDeleteProgram(m_id);
-    m_id = p;
     return true;
 }
 
+void Shader::reflect(){
+    m_locations.clear();
+
+    GLint count = 0, maxLen = 0;
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+
+    std::string buf((size_t)std::max(maxLen, 1), '\0');
+    for(GLint i = 0; i < count; i++){
+        GLsizei len = 0; GLint size = 0; GLenum type = 0;
+        glGetActiveUniform(m_id, (GLuint)i, (GLsizei)buf.size(), &len, &size, &type, buf.data());
+        std::string name(buf.data(), (size_t)len);
+
+        GLint loc = glGetUniformLocation(m_id, name.c_str());
+        if(loc < 0) continue; // block members
+
+        m_locations[name] = loc;
+        size_t br = name.find('[');
+        if(br != std::string::npos) m_locations[name.substr(0, br)] = loc;
+    }
+
+    GLuint block = glGetUniformBlockIndex(m_id, "FrameUniforms");
+    if(block != GL_INVALID_INDEX) glUniformBlockBinding(m_id, block, kFrameUniformsBinding);
+}
+
+GLint Shader::location(const char* name) const {
+    auto it = m_locations.find(name);
+    return (it != m_locations.end()) ? it->second : -1;
+}
+
 void Shader::use() const { glUseProgram(m_id); }
 
 void Shader::setMat4(const char* name, const glm::mat4& m) const {
-    GLint loc = glGetUniformLocation(m_id, name);
-    glUniformMatrix4fv(loc, 1, GL_FALSE, &m[0][0]);
+    glUniformMatrix4fv(location(name), 1, GL_FALSE, &m[0][0]);
 }
 void Shader::setVec3(const char* name, const glm::vec3& v) const {
-    GLint loc = glGetUniformLocation(m_id, name);
-    glUniform3fv(loc, 1, &v[0]);
+    glUniform3fv(location(name), 1, &v[0]);
 }
 void Shader::setInt(const char* name, int v) const {
-    GLint loc = glGetUniformLocation(m_id, name);
-    glUniform1i(loc, v);
+    glUniform1i(location(name), v);
 }
 void Shader::setBool(const char* name, bool v) const {
-    GLint loc = glGetUniformLocation(m_id, name);
-    glUniform1i(loc, v ? 1 : 0);
+    glUniform1i(location(name), v ? 1 : 0);
 }
 void Shader::setFloat(const char* name, float v) const {
-    GLint loc = glGetUniformLocation(m_id, name);
-    glUniform1f(loc, v);
+    glUniform1f(location(name), v);
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -10,10 +12,17 @@ public:
     ~Shader();
 
     bool load(const std::string& vsPath, const std::string& fsPath);
+
+    // Vertex-only program; the named outputs are captured interleaved by
+    // transform feedback (draw with GL_RASTERIZER_DISCARD enabled).
+    bool loadFeedback(const std::string& vsPath, const std::vector<std::string>& varyings);
     void use() const;
 
     GLuint id() const { return m_id; }
 
+    // Cached at link; -1 for names the program doesn't use.
+    GLint location(const char* name) const;
+
     void setMat4(const char* name, const glm::mat4& m) const;
     void setVec3(const char* name, const glm::vec3& v) const;
     void setInt(const char* name, int v) const;
@@ -22,6 +31,10 @@ public:
 
 private:
     GLuint m_id = 0;
+    std::unordered_map<std::string, GLint> m_locations;
+
+    void reflect();
     static std::string readFile(const std::string& path);
     static GLuint compile(GLenum type, const std::string& src, const std::string& debugName);
+    static bool checkLink(GLuint p);
 };
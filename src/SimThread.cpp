@@ -0,0 +1,220 @@
+#include "SimThread.h"
+#include "Sgp4System.h"
+#include "Parallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+static bool failed(const glm::vec3& p) { return p.x == 0.0f && p.y == 0.0f && p.z == 0.0f; }
+
+SimBlend::SimBlend(std::shared_ptr<const SimSnapshot> prev, std::shared_ptr<const SimSnapshot> cur, double tSec)
+    : m_prev(std::move(prev)), m_cur(std::move(cur)), m_t(tSec) {
+    if (!m_cur) return;
+    if (m_prev && (m_prev->pos.size() != m_cur->pos.size() || m_prev->simSec >= m_cur->simSec)) m_prev.reset();
+
+    m_h = m_prev ? m_cur->simSec - m_prev->simSec : 0.0;
+    const double lo = m_prev ? m_prev->simSec : m_cur->simSec;
+    // one interval of extrapolation past the newest snapshot covers a late tick
+    const double hi = m_cur->simSec + m_h;
+    m_valid = tSec >= lo - 1e-3 && tSec <= hi + 1e-3;
+    m_s = (m_h > 0.0) ? (tSec - lo) / m_h : 1.0;
+}
+
+glm::vec3 SimBlend::position(size_t i) const {
+    const glm::vec3& p1 = m_cur->pos[i];
+    const glm::vec3& v1 = m_cur->vel[i];
+    if (failed(p1)) return p1;
+
+    const float dt1 = (float)(m_t - m_cur->simSec);
+    if (!m_prev || m_s >= 1.0 || failed(m_prev->pos[i])) return p1 + v1 * dt1;
+
+    // cubic Hermite on positions + velocities
+    const float s = (float)std::max(0.0, m_s);
+    const float h = (float)m_h;
+    const float s2 = s * s, s3 = s2 * s;
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = s3 - 2.0f * s2 + s;
+    const float h01 = -2.0f * s3 + 3.0f * s2;
+    const float h11 = s3 - s2;
+    return h00 * m_prev->pos[i] + (h10 * h) * m_prev->vel[i] + h01 * p1 + (h11 * h) * v1;
+}
+
+float SimBlend::brightness(size_t i) const {
+    if (!m_prev) return m_cur->bright[i];
+    const float s = (float)std::clamp(m_s, 0.0, 1.0);
+    return m_prev->bright[i] + (m_cur->bright[i] - m_prev->bright[i]) * s;
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::start(const Sgp4System& sys, float kmToRender, BrightnessFn brightness) {
+    stop();
+    m_sys = &sys;
+    m_kmToRender = kmToRender;
+    m_brightness = std::move(brightness);
+    m_stop = false;
+    m_hasInput = false;
+    m_thread = std::thread(&SimThread::loop, this);
+}
+
+void SimThread::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    {
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_prev.reset();
+        m_cur.reset();
+    }
+    std::lock_guard<std::mutex> lk(m_pool->mu);
+    m_pool->free.clear();
+}
+
+void SimThread::setRateHz(float hz) {
+    std::lock_guard<std::mutex> lk(m_mu);
+    m_rateHz = std::clamp(hz, 1.0f, 240.0f);
+}
+
+void SimThread::submit(const SimInputs& in) {
+    {
+        std::lock_guard<std::mutex> lk(m_mu);
+        m_in = in;
+        m_hasInput = true;
+    }
+    m_cv.notify_all();
+}
+
+SimBlend SimThread::blend(double tSec) const {
+    std::lock_guard<std::mutex> lk(m_mu);
+    return SimBlend(m_prev, m_cur, tSec);
+}
+
+float SimThread::lastBuildMs() const {
+    std::lock_guard<std::mutex> lk(m_mu);
+    return m_cur ? m_cur->buildMs : 0.0f;
+}
+
+float SimThread::achievedHz() const {
+    std::lock_guard<std::mutex> lk(m_mu);
+    return m_achievedHz;
+}
+
+std::shared_ptr<SimSnapshot> SimThread::acquire() {
+    std::unique_ptr<SimSnapshot> s;
+    {
+        std::lock_guard<std::mutex> lk(m_pool->mu);
+        if (!m_pool->free.empty()) {
+            s = std::move(m_pool->free.back());
+            m_pool->free.pop_back();
+        }
+    }
+    if (!s) s = std::make_unique<SimSnapshot>();
+
+    // the deleter runs once every owner (sim thread, renderer's SimBlend) has
+    // released it, so a buffer on the free list is never still being read
+    std::shared_ptr<Pool> pool = m_pool;
+    return std::shared_ptr<SimSnapshot>(s.release(), [pool](SimSnapshot* p) {
+        std::unique_ptr<SimSnapshot> back(p);
+        std::lock_guard<std::mutex> lk(pool->mu);
+        pool->free.push_back(std::move(back));
+    });
+}
+
+void SimThread::build(SimSnapshot& s, const SimInputs& in, double tSec) const {
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t n = std::min(in.count, m_sys->count());
+    const double scale = (double)m_kmToRender;
+
+    s.simSec = tSec;
+    s.pos.resize(n);
+    s.vel.resize(n);
+    s.bright.resize(n);
+
+    parallelFor(n, 256, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            glm::dvec3 r, v;
+            if (!m_sys->sampleStateKm(i, tSec, r, v)) {
+                s.pos[i] = s.vel[i] = glm::vec3(0.0f);
+                s.bright[i] = 1.0f;
+                continue;
+            }
+            s.pos[i] = glm::vec3(r * scale);
+            s.vel[i] = glm::vec3(v * scale);
+            s.bright[i] = m_brightness ? m_brightness(s.pos[i], in.sunDir) : 1.0f;
+        }
+    });
+
+    s.orbitSat = in.selected;
+    s.orbitWindowSec = in.orbitWindowSec;
+    s.orbit.clear();
+    if (in.selected >= 0 && (size_t)in.selected < m_sys->count()) {
+        const int samples = 512;
+        s.orbit.reserve(samples);
+        for (int k = 0; k < samples; ++k) {
+            const double t = tSec + (double)in.orbitWindowSec * (double)k / (double)(samples - 1);
+            glm::dvec3 r;
+            s.orbit.push_back(m_sys->sampleKm((size_t)in.selected, t, r) ? glm::vec3(r * scale) : glm::vec3(0.0f));
+        }
+    }
+
+    s.buildMs = (float)std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void SimThread::loop() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastPublish{};
+
+    for (;;) {
+        SimInputs in;
+        float hz = 30.0f;
+        bool unchanged = false;
+        {
+            std::unique_lock<std::mutex> lk(m_mu);
+            m_cv.wait(lk, [&] { return m_stop || m_hasInput; });
+            if (m_stop) return;
+            in = m_in;
+            hz = m_rateHz;
+        }
+
+        const Clock::time_point tick = Clock::now();
+        const double period = 1.0 / (double)hz;
+        // aim one tick ahead so the render clock sits between the last two snapshots
+        const double tSec = in.paused ? in.simSec : in.simSec + in.timeScale * period;
+
+        {
+            std::lock_guard<std::mutex> lk(m_mu);
+            unchanged = m_cur && in.paused && m_cur->simSec == tSec && m_cur->pos.size() == in.count &&
+                        m_cur->orbitSat == in.selected && m_cur->orbitWindowSec == in.orbitWindowSec;
+        }
+
+        if (!unchanged) {
+            std::shared_ptr<SimSnapshot> snap = acquire();
+            build(*snap, in, tSec);
+
+            std::lock_guard<std::mutex> lk(m_mu);
+            snap->seq = ++m_seq;
+            m_prev = std::move(m_cur);
+            m_cur = std::move(snap);
+
+            const Clock::time_point now = Clock::now();
+            if (lastPublish != Clock::time_point{}) {
+                const float inst = 1.0f / (float)std::max(1e-6, std::chrono::duration<double>(now - lastPublish).count());
+                m_achievedHz = (m_achievedHz > 0.0f) ? 0.9f * m_achievedHz + 0.1f * inst : inst;
+            }
+            lastPublish = now;
+        }
+
+        std::unique_lock<std::mutex> lk(m_mu);
+        m_cv.wait_until(lk, tick + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(period)),
+                        [&] { return m_stop; });
+        if (m_stop) return;
+    }
+}
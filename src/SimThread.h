@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Sgp4System;
+
+// One propagation pass over the catalog at a single sim time, in render
+// units. Velocities let the render side interpolate with a cubic instead of
+// cutting chords through the orbit at high time scales.
+struct SimSnapshot {
+    uint64_t seq = 0;
+    double simSec = 0.0;
+    std::vector<glm::vec3> pos;
+    std::vector<glm::vec3> vel;  // render units per sim second
+    std::vector<float> bright;
+
+    int orbitSat = -1;
+    float orbitWindowSec = 0.0f;
+    std::vector<glm::vec3> orbit; // selected sat, one window from simSec
+
+    float buildMs = 0.0f;
+};
+
+// What the render thread last told the sim thread.
+struct SimInputs {
+    double simSec = 0.0;
+    double timeScale = 1.0;
+    bool paused = false;
+    glm::vec3 sunDir{1.0f, 0.0f, 0.0f};
+    size_t count = 0;
+    int selected = -1;
+    float orbitWindowSec = 240.0f;
+};
+
+// Latest two snapshots bracketing (or just behind) a render time.
+class SimBlend {
+public:
+    SimBlend() = default;
+    SimBlend(std::shared_ptr<const SimSnapshot> prev, std::shared_ptr<const SimSnapshot> cur, double tSec);
+
+    // false when the snapshots don't cover tSec (time jump, reset, catalog
+    // mismatch); callers then propagate directly for that frame
+    bool valid() const { return m_valid; }
+    bool covers(size_t count) const { return m_valid && m_cur->pos.size() >= count; }
+
+    glm::vec3 position(size_t i) const;
+    float brightness(size_t i) const;
+
+    const SimSnapshot* latest() const { return m_cur.get(); }
+
+private:
+    std::shared_ptr<const SimSnapshot> m_prev, m_cur;
+    double m_t = 0.0;
+    double m_h = 0.0;   // prev -> cur sim seconds
+    double m_s = 1.0;   // normalized position in [prev, cur]
+    bool m_valid = false;
+};
+
+// Fixed-rate propagation off the render thread. Each tick reads the latest
+// SimInputs, propagates one tick ahead of the render clock and publishes the
+// result; the render thread blends the two newest snapshots. Snapshot buffers
+// are handed back to a free list by their deleter when the last reference
+// drops, and reused from there.
+class SimThread {
+public:
+    using BrightnessFn = std::function<float(const glm::vec3& pos, const glm::vec3& sunDir)>;
+
+    ~SimThread();
+
+    void start(const Sgp4System& sys, float kmToRender, BrightnessFn brightness);
+    void stop();
+    bool running() const { return m_thread.joinable(); }
+
+    void setRateHz(float hz);
+    void submit(const SimInputs& in);
+
+    SimBlend blend(double tSec) const;
+
+    float lastBuildMs() const;
+    float achievedHz() const;
+
+private:
+    const Sgp4System* m_sys = nullptr;
+    float m_kmToRender = 1.0f;
+    BrightnessFn m_brightness;
+
+    mutable std::mutex m_mu;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+    bool m_stop = false;
+
+    SimInputs m_in;
+    bool m_hasInput = false;
+    float m_rateHz = 30.0f;
+
+    // shared with every live snapshot's deleter, so it outlives stop()
+    struct Pool {
+        std::mutex mu;
+        std::vector<std::unique_ptr<SimSnapshot>> free;
+    };
+    std::shared_ptr<Pool> m_pool = std::make_shared<Pool>();
+    std::shared_ptr<const SimSnapshot> m_prev, m_cur;
+    uint64_t m_seq = 0;
+    float m_achievedHz = 0.0f;
+
+    std::shared_ptr<SimSnapshot> acquire();
+    void build(SimSnapshot& s, const SimInputs& in, double tSec) const;
+    void loop();
+};
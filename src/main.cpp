@@ -12,25 +12,51 @@
 #include <chrono>
 #include <ctime>
 #include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <future>
+#include <memory>
+#include <thread>
 
 #include "Shader.h"
 #include "Camera.h"
 #include "OrbitLine.h"
 #include "GltfModel.h"
+#include "AssetLoader.h"
 
 #include "TleLoader.h"
 #include "Sgp4System.h"
 
 #include "Conjunction.h"
+#include "CollisionProbability.h"
+#include "EarthConstants.h"
+#include "Ephemeris.h"
+#include "Eclipse.h"
+#include "PassPredictor.h"
+#include "Coverage.h"
+#include "SensorAccess.h"
+#include "GroundTrack.h"
+#include "Picking.h"
+#include "Culling.h"
+#include "MeanElements.h"
+#include "OrbitBatch.h"
+#include "OrbitLod.h"
+#include "ElementIndex.h"
+#include "CatalogQuery.h"
+#include "Maneuver.h"
+#include "NumericalPropagator.h"
+#include "Breakup.h"
+#include "LinkGraph.h"
+#include "FrameUniforms.h"
+#include "Capture.h"
+#include "Profiler.h"
+#include "SimThread.h"
+#include "Parallel.h"
 
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 static Camera gCam;
 static bool gFirstMouse = true;
 static double gLastX = 0.0, gLastY = 0.0;
@@ -55,14 +81,6 @@ static bool pressed(GLFWwindow *w, int key)
     prev[key] = cur;
     return cur && !was;
 }
-static bool pressedMouse(GLFWwindow *w, int button)
-{
-    static bool prev[16] = {};
-    bool cur = glfwGetMouseButton(w, button) == GLFW_PRESS;
-    bool was = prev[button];
-    prev[button] = cur;
-    return cur && !was;
-}
 
 static void framebuffer_size_callback(GLFWwindow *, int w, int h)
 {
@@ -139,115 +157,7 @@ static std::string pathJoin(const std::string &a, const std::string &b)
     return a + "/" + b;
 }
 
-static double deg2rad(double d) { return d * M_PI / 180.0; }
-static double rad2deg(double r) { return r * 180.0 / M_PI; }
-
-static double wrapDeg(double x)
-{
-    x = std::fmod(x, 360.0);
-    if (x < 0)
-        x += 360.0;
-    return x;
-}
-
-static double julianDayUTC(const std::tm &utc, double fracSeconds)
-{
-    int Y = utc.tm_year + 1900;
-    int M = utc.tm_mon + 1;
-    int D = utc.tm_mday;
-
-    double hour = (double)utc.tm_hour + (double)utc.tm_min / 60.0 + ((double)utc.tm_sec + fracSeconds) / 3600.0;
-
-    if (M <= 2)
-    {
-        Y -= 1;
-        M += 12;
-    }
-    int A = Y / 100;
-    int B = 2 - A + (A / 4);
-
-    double JD = std::floor(365.25 * (Y + 4716)) + std::floor(30.6001 * (M + 1)) + (double)D + (double)B - 1524.5 + hour / 24.0;
-    return JD;
-}
-
-static double julianDay_FromTimePointUTC(const std::chrono::system_clock::time_point &tpUtc)
-{
-    using namespace std::chrono;
-    const auto tt = system_clock::to_time_t(tpUtc);
-
-    std::tm utc{};
-#if defined(_WIN32)
-    gmtime_s(&utc, &tt);
-#else
-    gmtime_r(&tt, &utc);
-#endif
-
-    const auto base = system_clock::from_time_t(tt);
-    const double frac = duration<double>(tpUtc - base).count();
-    return julianDayUTC(utc, frac);
-}
-
-static glm::vec3 sunDirECI_FromUTC(const std::chrono::system_clock::time_point &tpUtc)
-{
-    const double JD = julianDay_FromTimePointUTC(tpUtc);
-    const double T = (JD - 2451545.0) / 36525.0;
-
-    double L0 = std::fmod(280.46646 + T * (36000.76983 + 0.0003032 * T), 360.0);
-    if (L0 < 0)
-        L0 += 360.0;
-
-    double M = std::fmod(357.52911 + T * (35999.05029 - 0.0001537 * T), 360.0);
-    if (M < 0)
-        M += 360.0;
-
-    const double Mr = deg2rad(M);
-
-    const double C =
-        (1.914602 - T * (0.004817 + 0.000014 * T)) * std::sin(Mr) +
-        (0.019993 - 0.000101 * T) * std::sin(2.0 * Mr) +
-        0.000289 * std::sin(3.0 * Mr);
-
-    const double trueLong = L0 + C;
-
-    const double omega = 125.04 - 1934.136 * T;
-    const double lambda = trueLong - 0.00569 - 0.00478 * std::sin(deg2rad(omega));
-
-    const double eps0 =
-        23.0 + (26.0 + (21.448 - T * (46.815 + T * (0.00059 - T * 0.001813))) / 60.0) / 60.0;
-    const double eps = eps0 + 0.00256 * std::cos(deg2rad(omega));
-
-    const double lam = deg2rad(lambda);
-    const double epr = deg2rad(eps);
-
-    const double alpha = std::atan2(std::cos(epr) * std::sin(lam), std::cos(lam));
-    const double delta = std::asin(std::sin(epr) * std::sin(lam));
-
-    glm::dvec3 s;
-    s.x = std::cos(delta) * std::cos(alpha);
-    s.y = std::cos(delta) * std::sin(alpha);
-    s.z = std::sin(delta);
-
-    glm::vec3 w((float)s.x, (float)s.z, (float)s.y);
-    return glm::normalize(w);
-}
-
-static double gmstRadians_FromUTC(const std::chrono::system_clock::time_point &tpUtc)
-{
-    const double JD = julianDay_FromTimePointUTC(tpUtc);
-    const double T = (JD - 2451545.0) / 36525.0;
-
-    double gmstDeg =
-        280.46061837 +
-        360.98564736629 * (JD - 2451545.0) +
-        0.000387933 * T * T -
-        (T * T * T) / 38710000.0;
-
-    gmstDeg = std::fmod(gmstDeg, 360.0);
-    if (gmstDeg < 0)
-        gmstDeg += 360.0;
-
-    return deg2rad(gmstDeg);
-}
+static double rad2deg(double r) { return r * 180.0 / PI; }
 
 static glm::vec3 rotateY(const glm::vec3 &v, float a)
 {
@@ -279,81 +189,37 @@ static float satBrightnessShadow(const glm::vec3 &p, const glm::vec3 &sunDir, fl
     return shadowMin + (1.0f - shadowMin) * t;
 }
 
+static bool containsNoCase(const std::string &hay, const char *needle)
+{
+    const size_t n = std::strlen(needle);
+    if (n == 0)
+        return true;
+    auto it = std::search(hay.begin(), hay.end(), needle, needle + n, [](char a, char b)
+                          { return std::toupper((unsigned char)a) == std::toupper((unsigned char)b); });
+    return it != hay.end();
+}
+
+static float eclipseBrightness(ShadowState s, const glm::dvec3 &satKm, const glm::dvec3 &sunKm)
+{
+    const float shadowMin = 0.25f;
+    switch (s)
+    {
+    case ShadowState::Umbra:
+        return shadowMin;
+    case ShadowState::Penumbra:
+        // the table only marks the cone; the disc overlap gives the light that is left
+        return shadowMin + (1.0f - shadowMin) * (float)illuminatedFraction(shadowGeometry(satKm, sunKm));
+    default:
+        return 1.0f;
+    }
+}
+
 struct SatVertex
 {
     glm::vec3 pos;
     float bright;
 };
 
-// fix later for closer accurate but prob close enough for now
-static glm::vec3 moonPosECI_FromUTC(const std::chrono::system_clock::time_point &tpUtc,
-                                    float earthRadius,
-                                    float EARTH_RADIUS_KM)
-{
-    const double JD = julianDay_FromTimePointUTC(tpUtc);
-    const double d = JD - 2451545.0;
-    const double T = d / 36525.0;
-
-    double L0 = wrapDeg(218.3164477 + 13.17639648 * d);
-    double Mm = wrapDeg(134.9633964 + 13.06499295 * d);
-    double Ms = wrapDeg(357.5291092 + 0.98560028 * d);
-    double D = wrapDeg(297.8501921 + 12.19074912 * d);
-    double F = wrapDeg(93.2720950 + 13.22935024 * d);
-
-    double L0r = deg2rad(L0);
-    double Mmr = deg2rad(Mm);
-    double Msr = deg2rad(Ms);
-    double Dr = deg2rad(D);
-    double Fr = deg2rad(F);
-
-    double lon =
-        L0 +
-        6.289 * std::sin(Mmr) +
-        1.274 * std::sin(2.0 * Dr - Mmr) +
-        0.658 * std::sin(2.0 * Dr) +
-        0.214 * std::sin(2.0 * Mmr) +
-        0.110 * std::sin(Dr);
-
-    double lat =
-        5.128 * std::sin(Fr) +
-        0.280 * std::sin(Mmr + Fr) +
-        0.277 * std::sin(Mmr - Fr) +
-        0.173 * std::sin(2.0 * Dr - Fr) +
-        0.055 * std::sin(2.0 * Dr + Fr - Mmr) +
-        0.046 * std::sin(2.0 * Dr - Fr - Mmr) +
-        0.033 * std::sin(2.0 * Dr + Fr) +
-        0.017 * std::sin(2.0 * Mmr + Fr);
-
-    double distKm =
-        385001.0 - 20905.0 * std::cos(Mmr) - 3699.0 * std::cos(2.0 * Dr - Mmr) - 2956.0 * std::cos(2.0 * Dr) - 570.0 * std::cos(2.0 * Mmr) + 246.0 * std::cos(2.0 * Mmr - 2.0 * Dr) - 205.0 * std::cos(Msr - 2.0 * Dr) - 171.0 * std::cos(Mmr + 2.0 * Dr) - 152.0 * std::cos(Mmr + Msr) - 129.0 * std::cos(Mmr - Msr) + 108.0 * std::cos(Dr);
-
-    double lonr = deg2rad(wrapDeg(lon));
-    double latr = deg2rad(lat);
-
-    double eps =
-        23.0 + (26.0 + (21.448 - T * (46.815 + T * (0.00059 - T * 0.001813))) / 60.0) / 60.0;
-    double epsr = deg2rad(eps);
-
-    double cl = std::cos(latr);
-    double x_ecl = distKm * cl * std::cos(lonr);
-    double y_ecl = distKm * cl * std::sin(lonr);
-    double z_ecl = distKm * std::sin(latr);
-
-    double x_eq = x_ecl;
-    double y_eq = y_ecl * std::cos(epsr) - z_ecl * std::sin(epsr);
-    double z_eq = y_ecl * std::sin(epsr) + z_ecl * std::cos(epsr);
-
-    glm::dvec3 w;
-    w.x = x_eq;
-    w.y = z_eq;
-    w.z = y_eq;
-
-    glm::vec3 pos = glm::vec3((float)(w.x / EARTH_RADIUS_KM),
-                              (float)(w.y / EARTH_RADIUS_KM),
-                              (float)(w.z / EARTH_RADIUS_KM));
-    return pos * earthRadius;
-}
-
 static float gSSA_HorizonHrs = 2.0f;
 static float gSSA_StepSec = 20.0f;
 static float gSSA_ThresholdKm = 25.0f;
@@ -363,12 +229,99 @@ static std::vector<ConjunctionHit> gSSA_Hits;
 static int gSSA_SelectedHit = -1;
 static float gSSA_LastRunMs = 0.0f;
 
+static bool gSSA_ComputePc = true;
+static PcParams gSSA_PcParams;
+static CovarianceCatalog gSSA_Covariance;
+static char gSSA_CovPath[128] = "data/covariance.csv";
+static int gSSA_CovLoaded = 0;
+static float gSSA_LastPcMs = 0.0f;
+static std::vector<int> gSSA_Order; // table row -> gSSA_Hits index
+static bool gSSA_Continuous = false;
+static int gSSA_StepsPerFrame = 32;
+static ConjunctionScreener gSSA_Screener;
+static bool gSSA_Prefilter = true;
+static bool gSSA_SubsetOnly = false;
+
+// primaries screened together in the background; results survive selection changes
+static std::vector<int> gWatch_Sats;
+static bool gWatch_Auto = true;
+static float gWatch_RefreshSec = 600.0f; // sim seconds between refreshes
+static bool gWatch_Dirty = false;
+
+// avoidance-burn trade space for one primary
+static float gMan_BurnInSec = 600.0f; // after the cache window start
+static float gMan_DvRtn[3] = {0.0f, 0.0f, 0.0f}; // m/s
+static float gMan_PadKm = 200.0f;
+
+// Cowell override (zonal harmonics + drag) for chosen objects; SGP4 for the rest
+// stored every 120 s like the breakup drill; builds whose history exceeds the cap are refused
+static NumericalParams gNum_Params{6, true, 30.0, 120.0};
+static float gNum_HorizonHrs = 24.0f;
+static float gNum_MaxHistoryMB = 2048.0f;
+static std::string gNum_Error;
+
+// fragmentation drill: the cloud is appended to the catalog as synthetic objects
+static BreakupParams gBrk_Params;
+// stored every 120 s, which keeps tens of thousands of fragments to a few hundred MB
+static NumericalParams gBrk_Num{6, true, 30.0, 120.0};
+static float gBrk_HorizonHrs = 6.0f;
+static float gBrk_EventInSec = 0.0f;
+static int gBrk_WatchLargest = 10;
+
+struct ManeuverCache
+{
+    std::shared_ptr<const SecondaryEphemeris> eph;
+    ManeuverResult base; // zero burn
+};
+
+struct WatchResult
+{
+    double startSec = 0.0;
+    std::vector<int> primaries;
+    std::vector<std::vector<ConjunctionHit>> hits; // per primaries[k]
+    float ms = 0.0f;
+};
+
+static GroundStation gVis_Station;
+static float gVis_HorizonHrs = 24.0f;
+static float gVis_StepSec = 30.0f;
+static float gVis_SunMaxElDeg = -6.0f;
+static std::vector<VisiblePass> gVis_Passes;
+static float gVis_LastRunMs = 0.0f;
+
+static bool gEcl_UseTable = true;
+static float gEcl_HorizonHrs = 6.0f;
+static float gEcl_StepSec = 60.0f;
+
+static char gCov_NameFilter[64] = "STARLINK";
+static CoverageParams gCov_Params;
+static CoverageGrid gCov_Grid;
+
+// tasking sensors: a site plus a fixed field of view, searched over the whole catalog
+static std::vector<Sensor> gSen_Sensors;
+static AccessParams gSen_Params;
+static bool gSen_UseSubset = false;
+static int gSen_Listed = 0;
+static char gSen_CsvPath[256] = "access.csv";
+
+// inter-satellite links inside a constellation, routed to gVis_Station
+static bool gLink_On = false;
+static char gLink_NameFilter[64] = "STARLINK";
+static bool gLink_UseSubset = false;
+static LinkParams gLink_Params;
+static float gLink_StepSec = 10.0f;
+static bool gLink_ShowLines = true;
+static float gLink_Alpha = 0.35f;
+static char gLink_CsvPath[256] = "links.csv";
+static bool gLink_Record = false;
+
 static bool gSSA_ShowConjLine = true;
 static float gSSA_ConjAlpha = 0.85f;
 
 static void clearSSA(OrbitLine &conjLine, std::vector<glm::vec3> &conjPts)
 {
     gSSA_Hits.clear();
+    gSSA_Order.clear();
     gSSA_SelectedHit = -1;
     gSSA_HitsForSat = -1;
 
@@ -376,8 +329,50 @@ static void clearSSA(OrbitLine &conjLine, std::vector<glm::vec3> &conjPts)
     conjLine.update(conjPts);
 }
 
-int main()
+static ConjunctionParams ssaParams(const ElementIndex &index, const std::shared_ptr<const std::vector<uint32_t>> &subset)
+{
+    ConjunctionParams p;
+    p.horizonSec = (double)gSSA_HorizonHrs * 3600.0;
+    p.stepSec = (double)gSSA_StepSec;
+    p.thresholdKm = (double)gSSA_ThresholdKm;
+    p.maxSatsToCheck = gSSA_MaxSats;
+    p.refine = gSSA_Refine;
+    p.prefilter = gSSA_Prefilter ? &index : nullptr;
+    if (gSSA_SubsetOnly)
+        p.secondaries = subset;
+    return p;
+}
+
+// Pc for the current gSSA_Hits and the default table order
+static void rankSSAHits(const Sgp4System &sys, size_t primary)
+{
+    gSSA_LastPcMs = 0.0f;
+    if (gSSA_ComputePc && !gSSA_Hits.empty())
+    {
+        auto tp0 = std::chrono::high_resolution_clock::now();
+        computeCollisionProbabilities(sys, primary, gSSA_Covariance, gSSA_PcParams, gSSA_Hits);
+        auto tp1 = std::chrono::high_resolution_clock::now();
+        gSSA_LastPcMs = (float)std::chrono::duration<double, std::milli>(tp1 - tp0).count();
+    }
+
+    // hits come back sorted by miss; with Pc the riskiest go first
+    gSSA_Order.resize(gSSA_Hits.size());
+    for (size_t i = 0; i < gSSA_Order.size(); ++i)
+        gSSA_Order[i] = (int)i;
+    if (gSSA_ComputePc)
+        std::stable_sort(gSSA_Order.begin(), gSSA_Order.end(), [](int a, int b)
+                         { return gSSA_Hits[(size_t)a].pc > gSSA_Hits[(size_t)b].pc; });
+}
+
+int main(int argc, char **argv)
 {
+    CaptureOptions capOpt;
+    if (!parseCaptureArgs(argc, argv, capOpt))
+        return 1;
+
+    if (capOpt.software)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
     if (!glfwInit())
     {
         std::cerr << "Failed to init GLFW\n";
@@ -388,6 +383,15 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_SRGB_CAPABLE, GLFW_TRUE);
+    if (capOpt.headless)
+    {
+        // the window only hosts the context; frames go to the capture FBO
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        gWinW = capOpt.width;
+        gWinH = capOpt.height;
+    }
+    if (capOpt.software)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 
     GLFWwindow *window = glfwCreateWindow(gWinW, gWinH, "Earth + Satellites + Moon/Sun (SSA)", nullptr, nullptr);
     if (!window)
@@ -397,7 +401,7 @@ int main()
         return 1;
     }
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    glfwSwapInterval(capOpt.headless ? 0 : 1);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -427,31 +431,44 @@ int main()
     Shader earthSh(pathJoin(shaderDir, "earth.vert"), pathJoin(shaderDir, "earth.frag"));
     Shader satSh(pathJoin(shaderDir, "sats.vert"), pathJoin(shaderDir, "sats.frag"));
     Shader orbitSh(pathJoin(shaderDir, "orbit.vert"), pathJoin(shaderDir, "orbit.frag"));
+    Shader orbitBatchSh(pathJoin(shaderDir, "orbitbatch.vert"), pathJoin(shaderDir, "orbitbatch.frag"));
+
+    Shader propSh;
+    if (!propSh.loadFeedback(pathJoin(shaderDir, "satprop.vert"), {"vPos", "vBright"}))
+        std::cerr << "GPU propagation unavailable, J2 display mode will run on the CPU\n";
 
     // looks yellow now make it better later
     Shader sunSh(pathJoin(shaderDir, "sun.vert"), pathJoin(shaderDir, "sun.frag"));
 
+    // view/proj/sun/camera/time for every program, uploaded once per frame
+    GLuint frameUBO = 0;
+    glGenBuffers(1, &frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameUniformsBinding, frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
     const float earthRadius = 1.0f;
-    const float EARTH_RADIUS_KM = 6378.137f;
+
+    // placeholder spheres draw from the first frame; the GLBs decode on workers
+    // (or come straight from the cache) and are swapped in by assetLoader.poll()
+    AssetLoader assetLoader("cache/assets");
 
     GltfModel earthGltf;
-    bool hasEarthGltf = earthGltf.loadFromFile(pathJoin(assetDir, "Earth_1_12756.glb"), true);
-    if (!hasEarthGltf)
-        std::cerr << "Failed to load GLB: " << pathJoin(assetDir, "Earth_1_12756.glb") << "\n";
+    bool hasEarthGltf = earthGltf.upload(makeSphereAsset(96, 48, glm::vec3(0.12f, 0.25f, 0.65f)));
+    assetLoader.request(earthGltf, pathJoin(assetDir, "Earth_1_12756.glb"), true);
     float earthScale = hasEarthGltf ? (earthRadius / earthGltf.boundsRadius()) : 1.0f;
 
-    const float MOON_RADIUS_EARTH = 1737.4f / EARTH_RADIUS_KM;
+    const float MOON_RADIUS_EARTH = (float)(1737.4 / EARTH_RADIUS_KM);
 
     GltfModel moonGltf;
-    bool hasMoon = moonGltf.loadFromFile(pathJoin(assetDir, "Moon.glb"), true);
-    if (!hasMoon)
-        std::cerr << "Failed to load Moon.glb (assets/Moon.glb)\n";
+    bool hasMoon = moonGltf.upload(makeSphereAsset(48, 24, glm::vec3(0.35f, 0.35f, 0.33f)));
+    assetLoader.request(moonGltf, pathJoin(assetDir, "Moon.glb"), true);
     float moonScale = hasMoon ? (MOON_RADIUS_EARTH / moonGltf.boundsRadius()) : 1.0f;
 
     GltfModel sunGltf;
-    bool hasSun = false;
-
-    hasSun = sunGltf.loadFromFile(pathJoin(assetDir, "Sun.glb"), true);
+    bool hasSun = sunGltf.upload(makeSphereAsset(48, 24, glm::vec3(1.0f, 0.65f, 0.20f)));
+    assetLoader.request(sunGltf, pathJoin(assetDir, "Sun.glb"), true);
 
     bool showMoon = true;
     bool showMoonOrbit = false;
@@ -471,6 +488,24 @@ int main()
 
     std::vector<glm::vec3> satPos(satCount);
     std::vector<SatVertex> satData(satCount);
+    std::vector<CullResult> satCull(satCount, CullResult::Visible);
+
+    // element ranges for display filtering and screening pre-selection
+    ElementIndex elIndex;
+    elIndex.build(sgp4sys);
+    CatalogTable catTable;
+    catTable.build(sgp4sys, elIndex);
+
+    // subset = element filter AND query; drives propagation, drawing, picking and (optionally) screening
+    ElementFilter elFilter;
+    CatalogQuery subsetQuery;
+    char queryText[256] = "";
+    std::string queryError;
+    bool subsetOn = false;
+    bool drawListDirty = true;
+    std::vector<uint32_t> drawList; // subset, ascending
+    std::shared_ptr<const std::vector<uint32_t>> subset = std::make_shared<const std::vector<uint32_t>>();
+    float elQueryUs = 0.0f;
 
     GLuint satVAO = 0, satVBO = 0;
     glGenVertexArrays(1, &satVAO);
@@ -498,6 +533,8 @@ int main()
     glBindBuffer(GL_ARRAY_BUFFER, hiVBO);
     SatVertex initHi{{0, 0, 0}, 1.0f};
     glBufferData(GL_ARRAY_BUFFER, sizeof(SatVertex), &initHi, GL_DYNAMIC_DRAW);
+    size_t hiCapacity = 1;
+    std::vector<SatVertex> hiData;
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SatVertex), (void *)0);
@@ -506,13 +543,41 @@ int main()
     glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(SatVertex), (void *)offsetof(SatVertex, bright));
     glBindVertexArray(0);
 
+    // per-sat mean elements for the transform-feedback propagation pass
+    GLuint propVAO = 0, elVBO = 0;
+    glGenVertexArrays(1, &propVAO);
+    glGenBuffers(1, &elVBO);
+
+    glBindVertexArray(propVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, elVBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(satCount * sizeof(MeanElements)), nullptr, GL_DYNAMIC_DRAW);
+    for (int a = 0; a < 3; a++)
+    {
+        glEnableVertexAttribArray(a);
+        glVertexAttribPointer(a, 4, GL_FLOAT, GL_FALSE, sizeof(MeanElements), (void *)(sizeof(float) * 4 * a));
+    }
+    // filtered draws propagate only the listed indices, written compactly
+    GLuint drawListEBO = 0;
+    glGenBuffers(1, &drawListEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawListEBO);
+    glBindVertexArray(0);
+
     OrbitLine orbitLine;
     orbitLine.init();
+
+    OrbitBatch orbitBatch;
+    orbitBatch.init(128);
+    std::string orbitBatchKey;
     std::vector<glm::vec3> orbitPts;
 
     OrbitLine groundLine;
-    groundLine.init();
+    groundLine.init(GL_LINES);
     std::vector<glm::vec3> groundPts;
+    GroundTrackCache groundCache;
+    uint64_t groundBuiltVersion = 0;
+    int64_t groundBuiltStep = -1;
+    std::vector<int> groundTracked;
+    std::string groundTrackedKey;
 
     OrbitLine nadirLine;
     nadirLine.init();
@@ -524,12 +589,94 @@ int main()
     std::vector<glm::vec3> conjPts;
     conjPts.reserve(2);
 
+    LinkGraph linkGraph;
+    bool linkMembersDirty = true;
+    OrbitLine linkLine;
+    linkLine.init(GL_LINES);
+    std::vector<glm::vec3> linkPts;
+    OrbitLine linkPathLine;
+    linkPathLine.init();
+    std::vector<glm::vec3> linkPathPts;
+
     OrbitLine moonOrbitLine;
     moonOrbitLine.init();
     std::vector<glm::vec3> moonOrbitPts;
+    double moonOrbitCenterSec = 0.0;
+
+    FrameCapture capture;
+    int capturedFrames = 0;
+    int exitCode = 0;
+    if (capOpt.headless && !capture.init(capOpt))
+    {
+        // skip the frame loop but still tear down GL, ImGui and the window
+        exitCode = 1;
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+    else if (capOpt.headless)
+    {
+        gSimTime = (float)capOpt.startSec;
+        std::cout << "Capturing " << capOpt.frames << " frames (" << capOpt.width << "x" << capOpt.height
+                  << ", " << capOpt.dtSec << " s/frame) to " << capOpt.outDir << "\n";
+    }
+    // captured frames should never show placeholders
+    while (capOpt.headless && exitCode == 0 && assetLoader.pending() > 0)
+    {
+        assetLoader.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto captureStart = std::chrono::steady_clock::now();
+
+    // per-stage timers; GPU stages also bracket their GL work with timestamp queries
+    Profiler prof;
+    prof.init();
+    bool showProfiler = false;
+    const int stInput = prof.stage("input");
+    const int stEphem = prof.stage("ephemeris + eclipse");
+    const int stElements = prof.stage("J2 elements", true);
+    const int stPropagate = prof.stage("propagate + cull");
+    const int stSatUpload = prof.stage("sat upload", true);
+    const int stPicking = prof.stage("picking");
+    const int stOrbit = prof.stage("selected orbit", true);
+    const int stGround = prof.stage("ground tracks", true);
+    const int stOrbitBatch = prof.stage("orbit batch fit", true);
+    const int stUi = prof.stage("ui build");
+    const int stScreen = prof.stage("conjunction screen");
+    const int stLinks = prof.stage("link graph");
+    const int stGltf = prof.stage("draw GLTF", true);
+    const int stLines = prof.stage("draw lines", true);
+    const int stSats = prof.stage("draw sats", true);
+    const int stImGui = prof.stage("ImGui render", true);
+    const int stPresent = prof.stage("present");
 
     float lastTime = (float)glfwGetTime();
     const auto startUtcTP = std::chrono::system_clock::now();
+    Ephemeris ephem(startUtcTP);
+
+    // outlive every future below, since their tasks sample through them
+    std::shared_ptr<NumericalPropagator> numProp;
+    std::shared_ptr<const DebrisCloud> cloud;
+
+    EclipseTable eclTable;
+    std::future<EclipseTable> eclPending;
+
+    WatchResult watchResult;
+    std::future<WatchResult> watchPending;
+
+    ManeuverCache manCache;
+    std::future<ManeuverCache> manCachePending;
+    ManeuverResult manResult;
+    std::future<ManeuverResult> manPending;
+    bool manDirty = false;
+
+    std::future<std::shared_ptr<NumericalPropagator>> numPending;
+    std::future<std::shared_ptr<const DebrisCloud>> cloudPending;
+
+    SensorAccessResult senResult;
+    std::future<SensorAccessResult> senPending;
+
+    std::future<CoverageGrid> covPending;
+
+    std::future<std::pair<std::vector<VisiblePass>, float>> visPending; // passes, ms
 
     bool useRealSun = true;
     bool rotateEarthGMST = true;
@@ -538,12 +685,27 @@ int main()
     bool autoOrbitWindow = true;
     bool showHiddenOrbit = true;
     float orbitWindowSec = 240.0f;
+    bool adaptiveOrbit = true;
+    float orbitPixelError = 0.75f;
+    OrbitLodParams orbitLodParams;
+    OrbitLodStats orbitLodStats;
 
     bool showGroundTrack = true;
     float groundDurationSec = 5400.0f;
-    int groundSamples = 512;
+    float groundStepSec = 10.0f;
+    bool showGroupTracks = false;
+    char groundGroupFilter[64] = "STARLINK";
+    int groundMaxTracks = 500;
+    int groundSampleBudget = 20000;
     bool showBacksideTrack = true;
 
+    bool showOrbitBatch = false;
+    char orbitBatchFilter[64] = "STARLINK";
+    int orbitBatchMax = 5000;
+    int orbitBatchColorBy = (int)OrbitColorBy::Inclination;
+    float orbitBatchAlpha = 0.35f;
+    float orbitBatchRefitHrs = 12.0f;
+
     bool showNadirLine = true;
     float nadirAlpha = 0.85f;
 
@@ -552,18 +714,182 @@ int main()
     int drawLimit = (int)std::min<size_t>(satCount, 30000);
 
     float pickRadiusPx = 10.0f;
+    bool pickIncludeHidden = false;
+    ScreenPicker picker;
+
+    // SGP4 every frame, or the secular-J2 display model on the CPU / GPU
+    enum class PropMode { Sgp4, J2Cpu, J2Gpu };
+    PropMode propMode = PropMode::Sgp4;
+    PropMode uploadedMode = PropMode::Sgp4;
+    MeanElementSet meanEls;
+    float j2ResyncSec = 3600.0f;
+    float j2ErrorBoundKm = 20.0f;
+    int j2CheckPerFrame = 64;
+    float j2MaxErrKm = 0.0f;
+    size_t j2Repaired = 0;
+
+    // SGP4 on its own thread at a fixed rate; the render loop blends the two newest snapshots
+    SimThread simThread;
+    bool simThreaded = false;
+    float simRateHz = 30.0f;
+    bool simFromSnapshot = false;
+
+    bool cullSats = true;
+    GLsizei satDrawCount = 0;
+    CullStats cullStats;
+    float cullMs = 0.0f;
+    int hoverSat = -1;
+    std::vector<int> multiSel;
+
+    // left drag: plain = click on release, shift = rectangle, ctrl = lasso
+    enum class DragMode { None, Click, Rect, Lasso };
+    DragMode dragMode = DragMode::None;
+    bool lmbWasDown = false;
+    glm::vec2 dragStart(0.0f);
+    std::vector<glm::vec2> lassoPts;
 
     float selAltKm = 0.0f;
     float selLatDeg = 0.0f;
     float selLonDeg = 0.0f;
     bool selInShadow = false;
 
+    // stops everything that samples the catalog off the main thread
+    auto quiesceCatalog = [&]()
+    {
+        simThread.stop();
+        if (eclPending.valid())
+            eclPending.wait();
+        if (watchPending.valid())
+            watchPending.wait();
+        if (manCachePending.valid())
+            manCachePending.wait();
+        if (manPending.valid())
+            manPending.wait();
+        if (numPending.valid())
+            numPending.wait();
+        if (cloudPending.valid())
+            cloudPending.wait();
+        if (senPending.valid())
+            senPending.wait();
+        if (covPending.valid())
+            covPending.wait();
+        if (visPending.valid())
+            visPending.wait();
+    };
+
+    // anything sampled from trajectories that just changed (call quiesced)
+    auto dropSampled = [&]()
+    {
+        eclPending = {};
+        eclTable.clear();
+        groundCache = GroundTrackCache();
+        groundTrackedKey.clear();
+        groundBuiltStep = -1;
+        orbitBatch.clear();
+        orbitBatchKey.clear();
+        visPending = {};
+        gVis_Passes.clear();
+        watchPending = {};
+        watchResult = WatchResult();
+        manCachePending = {};
+        manPending = {};
+        manCache = ManeuverCache();
+        manResult = ManeuverResult();
+        linkGraph = LinkGraph();
+        linkMembersDirty = true;
+        senPending = {};
+        senResult = SensorAccessResult();
+        covPending = {};
+    };
+
+    // the object count changed: per-object arrays, GPU buffers and indexes follow it
+    auto resizeObjects = [&]()
+    {
+        const size_t oldCount = satCount;
+        satCount = sgp4sys.count();
+        satPos.assign(satCount, glm::vec3(0.0f));
+        satData.assign(satCount, SatVertex{});
+        satCull.assign(satCount, CullResult::Visible);
+
+        glBindBuffer(GL_ARRAY_BUFFER, satVBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(satCount * sizeof(SatVertex)), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, elVBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(satCount * sizeof(MeanElements)), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // the buffers hold nothing valid until the next sat update refills them;
+        // this frame's draws must not read the old count or the old indices
+        satDrawCount = 0;
+        drawList.clear();
+        subset = std::make_shared<const std::vector<uint32_t>>();
+        glBindVertexArray(propVAO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+        glBindVertexArray(0);
+
+        // everything keyed by object index starts over
+        meanEls = MeanElementSet();
+        dropSampled();
+        hoverSat = -1;
+        if (drawLimit >= (int)oldCount)
+            drawLimit = (int)satCount;
+        drawLimit = std::clamp(drawLimit, 1, std::max(1, (int)satCount));
+
+        elIndex.build(sgp4sys);
+        catTable.build(sgp4sys, elIndex);
+        drawListDirty = true;
+    };
+
+    // swaps the numerical override; anything sampled from the old trajectories is rebuilt
+    auto attachNumerical = [&](std::shared_ptr<NumericalPropagator> prop)
+    {
+        quiesceCatalog();
+        sgp4sys.setNumerical(prop.get());
+        numProp = std::move(prop);
+
+        dropSampled();
+        gSSA_Screener.reset();
+        clearSSA(conjLine, conjPts);
+    };
+
+    // replaces the fragments appended after the catalog; catalog indices are unchanged
+    auto attachCloud = [&](std::shared_ptr<const DebrisCloud> c)
+    {
+        quiesceCatalog();
+        sgp4sys.setSynthetic(c ? c->prop.get() : nullptr, c ? c->names : std::vector<std::string>());
+        cloud = std::move(c);
+        resizeObjects();
+
+        if ((size_t)gSelectedSat >= satCount)
+            gSelectedSat = 0;
+        multiSel.erase(std::remove_if(multiSel.begin(), multiSel.end(), [&](int id)
+                                      { return (size_t)id >= satCount; }),
+                       multiSel.end());
+        gWatch_Sats.erase(std::remove_if(gWatch_Sats.begin(), gWatch_Sats.end(), [&](int id)
+                                         { return (size_t)id >= satCount; }),
+                          gWatch_Sats.end());
+        gSSA_Screener.reset();
+        clearSSA(conjLine, conjPts);
+    };
+
     while (!glfwWindowShouldClose(window))
     {
         float now = (float)glfwGetTime();
         float dt = now - lastTime;
         lastTime = now;
 
+        prof.beginFrame();
+
+        for (GltfModel *m : assetLoader.poll())
+        {
+            if (m == &earthGltf)
+                earthScale = earthRadius / earthGltf.boundsRadius();
+            else if (m == &moonGltf)
+                moonScale = MOON_RADIUS_EARTH / moonGltf.boundsRadius();
+            else if (m == &sunGltf && sunGltf.boundsRadius() > 1e-6f)
+                sunScale = sunVisualRadius / sunGltf.boundsRadius();
+        }
+
+        prof.begin(stInput);
         processInput(window, dt);
 
         if (pressed(window, GLFW_KEY_SPACE))
@@ -586,7 +912,9 @@ int main()
                 clearSSA(conjLine, conjPts);
         }
 
-        if (!gPaused)
+        if (capOpt.headless)
+            gSimTime = (float)(capOpt.startSec + capOpt.dtSec * (double)capturedFrames); // fixed step, independent of wall time
+        else if (!gPaused)
             gSimTime += dt * gTimeScale;
 
         auto simUtcTP =
@@ -594,9 +922,13 @@ int main()
             std::chrono::duration_cast<std::chrono::system_clock::duration>(
                 std::chrono::duration<double>(gSimTime));
 
+        prof.end(stInput);
+        prof.begin(stEphem);
+        ephem.ensureCovers(gSimTime, gSimTime);
+
         glm::vec3 sunDir = glm::normalize(glm::vec3(1.0f, 0.2f, 0.6f));
         if (useRealSun)
-            sunDir = sunDirECI_FromUTC(simUtcTP);
+            sunDir = ephem.sunDirRender(gSimTime);
 
         float theta = 0.0f;
         if (useRealSun && rotateEarthGMST)
@@ -606,36 +938,78 @@ int main()
         glm::mat4 view = gCam.view();
         glm::mat4 VP = proj * view;
 
-        glm::vec3 moonPos = moonPosECI_FromUTC(simUtcTP, earthRadius, EARTH_RADIUS_KM);
+        glm::vec3 moonPos = ephem.moonPosRender(gSimTime, earthRadius, (float)EARTH_RADIUS_KM);
 
+        // the Moon orbit only changes visibly over days, so rebuild it per window
         if (showMoonOrbit)
         {
-            moonOrbitPts.clear();
-            const int N = 512;
-            moonOrbitPts.reserve(N);
-            const double spanSec = 28.0 * 86400.0;
-
-            for (int i = 0; i < N; ++i)
+            const double windowSec = 86400.0;
+            const double center = std::floor((double)gSimTime / windowSec + 0.5) * windowSec;
+            if (moonOrbitPts.empty() || center != moonOrbitCenterSec)
             {
-                double u = (double)i / (double)(N - 1);
-                double offsetSec = (u - 0.5) * spanSec;
+                const int N = 512;
+                const double spanSec = 28.0 * 86400.0;
+                ephem.ensureCovers(center - 0.5 * spanSec, center + 0.5 * spanSec);
 
-                auto tp =
-                    simUtcTP +
-                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
-                        std::chrono::duration<double>(offsetSec));
-
-                moonOrbitPts.push_back(moonPosECI_FromUTC(tp, earthRadius, EARTH_RADIUS_KM));
+                moonOrbitPts.clear();
+                moonOrbitPts.reserve(N);
+                for (int i = 0; i < N; ++i)
+                {
+                    double u = (double)i / (double)(N - 1);
+                    double t = center + (u - 0.5) * spanSec;
+                    moonOrbitPts.push_back(ephem.moonPosRender(t, earthRadius, (float)EARTH_RADIUS_KM));
+                }
+                if (!moonOrbitPts.empty())
+                    moonOrbitPts.back() = moonOrbitPts.front();
+                moonOrbitLine.update(moonOrbitPts);
+                moonOrbitCenterSec = center;
             }
-            if (!moonOrbitPts.empty())
-                moonOrbitPts.back() = moonOrbitPts.front();
-            moonOrbitLine.update(moonOrbitPts);
         }
-        else
+        else if (!moonOrbitPts.empty())
         {
             moonOrbitPts.clear();
             moonOrbitLine.update(moonOrbitPts);
         }
+
+        // eclipse table is built off-thread and swapped in when ready (in place when capturing)
+        if (gEcl_UseTable && loaded && satCount > 0)
+        {
+            EclipseParams p;
+            p.horizonSec = (double)gEcl_HorizonHrs * 3600.0;
+            p.stepSec = (double)gEcl_StepSec;
+
+            // a build started before the sliders moved is dropped, not swapped in
+            if (eclPending.valid() && eclPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                EclipseTable t = eclPending.get();
+                if (t.builtWith(p))
+                    eclTable = std::move(t);
+            }
+
+            const double lead = 0.25 * p.horizonSec;
+            if (!eclPending.valid() &&
+                (!eclTable.builtWith(p) || !eclTable.covers(gSimTime) || !eclTable.covers(gSimTime + lead)))
+            {
+                Ephemeris eph = ephem;
+                eph.ensureCovers(gSimTime, gSimTime + p.horizonSec);
+                const double t0 = (double)gSimTime;
+
+                // headless capture builds in place so every frame sees the same table
+                if (capOpt.headless)
+                    eclTable.build(sgp4sys, eph, t0, p);
+                else
+                    eclPending = std::async(std::launch::async, [&sgp4sys, eph, t0, p]()
+                    {
+                        EclipseTable t;
+                        t.build(sgp4sys, eph, t0, p);
+                        return t;
+                    });
+            }
+        }
+        const bool useEclTable = gEcl_UseTable && eclTable.covers(gSimTime) && eclTable.objectCount() == satCount;
+        const glm::dvec3 sunKm = ephem.sunPosKm(gSimTime);
+        prof.end(stEphem);
+
         // sat update
         if (loaded && satCount > 0)
         {
@@ -651,66 +1025,263 @@ int main()
                 }
             }
 
-            sgp4sys.positionsAt(gSimTime, earthRadius, satPos);
-
-            const size_t drawN = (size_t)std::clamp(drawLimit, 0, (int)satCount);
-            for (size_t i = 0; i < drawN; i++)
+            // the subset replaces "the first drawLimit in file order" with a compact index list
+            if (drawListDirty)
             {
-                float b = satBrightnessShadow(satPos[i], sunDir, earthRadius);
-                satData[i] = {satPos[i], b};
+                auto tq0 = std::chrono::high_resolution_clock::now();
+                IndexBitset sel = elIndex.query(elFilter);
+                sel &= subsetQuery.evaluate(catTable);
+                sel.indices(drawList);
+                subset = std::make_shared<const std::vector<uint32_t>>(drawList);
+                linkMembersDirty = true;
+                auto tq1 = std::chrono::high_resolution_clock::now();
+                elQueryUs = (float)std::chrono::duration<double, std::micro>(tq1 - tq0).count();
+
+                glBindVertexArray(propVAO);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(drawList.size() * sizeof(uint32_t)),
+                             drawList.empty() ? nullptr : drawList.data(), GL_DYNAMIC_DRAW);
+                glBindVertexArray(0);
+                drawListDirty = false;
             }
+            const bool useDrawList = subsetOn;
+            const size_t drawN = useDrawList ? std::min(drawList.size(), (size_t)std::max(drawLimit, 0))
+                                             : (size_t)std::clamp(drawLimit, 0, (int)satCount);
+            const float kmToRender = (float)(earthRadius / EARTH_RADIUS_KM);
+
+            // headless capture stays on the synchronous path so frames are reproducible
+            const bool wantSimThread = simThreaded && propMode == PropMode::Sgp4 && !capOpt.headless;
+            if (wantSimThread && !simThread.running())
+                simThread.start(sgp4sys, kmToRender, [earthRadius](const glm::vec3 &p, const glm::vec3 &sun)
+                                { return satBrightnessShadow(p, sun, earthRadius); });
+            else if (!wantSimThread && simThread.running())
+                simThread.stop();
+
+            SimBlend simBlend;
+            if (simThread.running())
+            {
+                SimInputs in;
+                in.simSec = gSimTime;
+                in.timeScale = gTimeScale;
+                in.paused = gPaused;
+                in.sunDir = sunDir;
+                in.count = satCount;
+                in.selected = gSelectedSat;
+                in.orbitWindowSec = orbitWindowSec;
+                simThread.setRateHz(simRateHz);
+                simThread.submit(in);
+                simBlend = simThread.blend(gSimTime);
+            }
+            // outside the snapshots (time jump, first ticks) this frame propagates directly
+            simFromSnapshot = simBlend.covers(satCount);
 
-            glBindBuffer(GL_ARRAY_BUFFER, satVBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(drawN * sizeof(SatVertex)), satData.data());
-
-            ImGuiIO &io = ImGui::GetIO();
-            if (pressedMouse(window, GLFW_MOUSE_BUTTON_LEFT) && !io.WantCaptureMouse)
+            // display model: full refit on an interval, rolling spot checks against SGP4 in between
+            prof.begin(stElements);
+            if (propMode != PropMode::Sgp4)
             {
-                double mx = 0.0, my = 0.0;
-                glfwGetCursorPos(window, &mx, &my);
+                if (!meanEls.synced() || meanEls.count() != satCount ||
+                    std::fabs((double)gSimTime - meanEls.lastFullSyncSec()) > (double)j2ResyncSec)
+                    meanEls.resyncAll(sgp4sys, gSimTime);
+                else
+                    j2MaxErrKm = (float)meanEls.checkAndRepair(sgp4sys, gSimTime, (size_t)j2CheckPerFrame,
+                                                               (double)j2ErrorBoundKm, j2Repaired);
+            }
 
-                float mNdcX = (2.0f * (float)mx / (float)gWinW) - 1.0f;
-                float mNdcY = 1.0f - (2.0f * (float)my / (float)gWinH);
+            // satprop.vert only has the cylinder shadow; eclipse shading stays on the CPU path
+            const bool gpuProp = propMode == PropMode::J2Gpu && propSh.id() != 0 && !gEcl_UseTable;
+            if (gpuProp)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, elVBO);
+                const auto &els = meanEls.elements();
+                if (meanEls.allDirty() || uploadedMode != PropMode::J2Gpu)
+                {
+                    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(els.size() * sizeof(MeanElements)), els.data());
+                }
+                else
+                {
+                    for (uint32_t i : meanEls.dirty())
+                        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(i * sizeof(MeanElements)), sizeof(MeanElements), &els[i]);
+                }
+            }
+            meanEls.clearDirty();
+            // anything but J2Gpu forces a full upload the next time the GPU path runs
+            uploadedMode = gpuProp ? PropMode::J2Gpu : PropMode::J2Cpu;
+            prof.end(stElements);
 
-                float threshNdc = (2.0f * pickRadiusPx) / (float)gWinW;
-                float thresh2 = threshNdc * threshNdc;
+            auto propagate = [&](size_t i)
+            {
+                if (simFromSnapshot)
+                    return simBlend.position(i);
+                return (propMode == PropMode::Sgp4) ? sgp4sys.sample(i, gSimTime, earthRadius)
+                                                    : meanEls.positionAt(i, gSimTime, kmToRender);
+            };
+
+            // on the GPU path the CPU only needs every position while the cursor can pick
+            const bool needPick = !gpuProp || !gMouseCaptured || dragMode != DragMode::None ||
+                                  glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+
+            const PointCuller culler(VP, gCam.pos, earthRadius);
+            std::vector<CullStats> workerStats(workerCount());
+            cullStats = CullStats{};
+            picker.begin(VP, gWinW, gWinH);
+
+            auto tc0 = std::chrono::high_resolution_clock::now();
+            prof.begin(stPropagate);
+            if (needPick)
+            {
+                // propagate + cull in the same pass; brightness only for what survives
+                // j walks the draw order; i is the catalog index
+                parallelFor(useDrawList ? drawN : satCount, 256, [&](size_t begin, size_t end, unsigned w)
+                {
+                    CullStats &st = workerStats[w];
+                    for (size_t j = begin; j < end; j++)
+                    {
+                        const size_t i = useDrawList ? drawList[j] : j;
+                        satPos[i] = propagate(i);
+                        if (j >= drawN)
+                            continue;
+
+                        const CullResult r = culler.test(satPos[i]);
+                        satCull[j] = r;
+                        st.add(r);
+                        if (gpuProp || (cullSats && r != CullResult::Visible))
+                            continue;
+
+                        float b = useEclTable        ? eclipseBrightness(eclTable.stateAt(i, gSimTime),
+                                                                         glm::dvec3(satPos[i]) / (double)kmToRender, sunKm)
+                                  : simFromSnapshot ? simBlend.brightness(i)
+                                                    : satBrightnessShadow(satPos[i], sunDir, earthRadius);
+                        satData[j] = {satPos[i], b};
+                    }
+                });
 
-                int bestId = -1;
-                float bestD2 = 1e30f;
+                for (const CullStats &st : workerStats)
+                    cullStats.merge(st);
 
-                for (size_t i = 0; i < drawN; i++)
+                // compact in place (k <= i) and feed the picker from the same list
+                size_t k = 0;
+                for (size_t j = 0; j < drawN; j++)
                 {
-                    glm::vec4 clip = VP * glm::vec4(satPos[i], 1.0f);
-                    if (clip.w <= 0.0f)
+                    const size_t i = useDrawList ? drawList[j] : j;
+                    const CullResult r = satCull[j];
+                    if (r != CullResult::OutsideFrustum)
+                        picker.add((int)i, satPos[i], r == CullResult::Occluded);
+                    if (gpuProp || (cullSats && r != CullResult::Visible))
                         continue;
+                    satData[k++] = satData[j];
+                }
+                satDrawCount = (GLsizei)k;
+            }
+            // highlights may sit outside the filtered list
+            if (!needPick || useDrawList)
+            {
+                satPos[(size_t)gSelectedSat] = propagate((size_t)gSelectedSat);
+                for (int id : multiSel)
+                    if (id >= 0 && (size_t)id < satCount)
+                        satPos[(size_t)id] = propagate((size_t)id);
+            }
+            picker.finalize();
+            prof.end(stPropagate);
 
-                    glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
-                    float dx = ndc.x - mNdcX;
-                    float dy = ndc.y - mNdcY;
-                    float d2 = dx * dx + dy * dy;
+            prof.begin(stSatUpload);
+            if (gpuProp)
+            {
+                // positions + brightness land directly in the buffer sats.vert reads
+                glEnable(GL_RASTERIZER_DISCARD);
+                propSh.use();
+                propSh.setFloat("uTime", (float)((double)gSimTime - meanEls.baseSec()));
+                propSh.setFloat("uScale", kmToRender);
+                propSh.setVec3("uSunDir", sunDir);
+                propSh.setFloat("uEarthRadius", earthRadius);
+
+                glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, satVBO);
+                glBindVertexArray(propVAO);
+                glBeginTransformFeedback(GL_POINTS);
+                if (useDrawList)
+                    glDrawElements(GL_POINTS, (GLsizei)drawN, GL_UNSIGNED_INT, nullptr);
+                else
+                    glDrawArrays(GL_POINTS, 0, (GLsizei)drawN);
+                glEndTransformFeedback();
+                glBindVertexArray(0);
+                glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+                glDisable(GL_RASTERIZER_DISCARD);
+
+                satDrawCount = (GLsizei)drawN;
+            }
+            else
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, satVBO);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(satDrawCount * sizeof(SatVertex)), satData.data());
+            }
+            prof.end(stSatUpload);
+            auto tc1 = std::chrono::high_resolution_clock::now();
+            cullMs = (float)std::chrono::duration<double, std::milli>(tc1 - tc0).count();
 
-                    if (d2 < thresh2 && d2 < bestD2)
-                    {
-                        bestD2 = d2;
-                        bestId = (int)i;
-                    }
-                }
+            prof.begin(stPicking);
+            ImGuiIO &io = ImGui::GetIO();
+            double mx = 0.0, my = 0.0;
+            glfwGetCursorPos(window, &mx, &my);
+            const glm::vec2 mouse((float)mx, (float)my);
+            const bool lmb = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
 
-                if (bestId >= 0 && bestId != gSelectedSat)
+            if (lmb && !lmbWasDown && !io.WantCaptureMouse)
+            {
+                dragStart = mouse;
+                lassoPts.assign(1, mouse);
+                if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+                    dragMode = DragMode::Lasso;
+                else if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+                    dragMode = DragMode::Rect;
+                else
+                    dragMode = DragMode::Click;
+            }
+            if (lmb && dragMode == DragMode::Lasso && glm::length(mouse - lassoPts.back()) > 3.0f)
+                lassoPts.push_back(mouse);
+
+            if (!lmb && dragMode != DragMode::None)
+            {
+                const bool moved = glm::length(mouse - dragStart) > 4.0f;
+                if (dragMode == DragMode::Rect && moved)
+                    picker.pickRect(dragStart, mouse, pickIncludeHidden, multiSel);
+                else if (dragMode == DragMode::Lasso && moved)
+                    picker.pickLasso(lassoPts, pickIncludeHidden, multiSel);
+                else if (!moved)
                 {
-                    gSelectedSat = bestId;
-                    clearSSA(conjLine, conjPts);
+                    int bestId = picker.pickNearest(mouse, pickRadiusPx);
+                    if (bestId >= 0 && bestId != gSelectedSat)
+                    {
+                        gSelectedSat = bestId;
+                        clearSSA(conjLine, conjPts);
+                    }
                 }
+                dragMode = DragMode::None;
+                lassoPts.clear();
             }
+            lmbWasDown = lmb;
+
+            hoverSat = (!gMouseCaptured && !io.WantCaptureMouse && dragMode == DragMode::None)
+                           ? picker.pickNearest(mouse, pickRadiusPx)
+                           : -1;
+            prof.end(stPicking);
 
             glm::vec3 selPos = satPos[(size_t)gSelectedSat];
 
-            SatVertex hi{selPos, 1.0f};
+            // [0] = selected, then the multi-selection
+            hiData.clear();
+            hiData.push_back({selPos, 1.0f});
+            for (int id : multiSel)
+                if (id >= 0 && (size_t)id < satCount)
+                    hiData.push_back({satPos[(size_t)id], 1.0f});
+
             glBindBuffer(GL_ARRAY_BUFFER, hiVBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(SatVertex), &hi);
+            if (hiData.size() > hiCapacity)
+            {
+                hiCapacity = hiData.size();
+                glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(hiCapacity * sizeof(SatVertex)), nullptr, GL_DYNAMIC_DRAW);
+            }
+            glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(hiData.size() * sizeof(SatVertex)), hiData.data());
 
             float r = glm::length(selPos);
-            selAltKm = (r - earthRadius) * EARTH_RADIUS_KM;
+            selAltKm = (float)((r - earthRadius) * EARTH_RADIUS_KM);
 
             glm::vec3 selEcef = rotateY(selPos, -theta);
             float rr = glm::length(selEcef);
@@ -725,56 +1296,103 @@ int main()
                 selLatDeg = selLonDeg = 0.0f;
             }
 
-            float sb = satBrightnessShadow(selPos, sunDir, earthRadius);
-            selInShadow = (sb < 0.6f);
+            if (useEclTable)
+            {
+                selInShadow = eclTable.stateAt((size_t)gSelectedSat, gSimTime) != ShadowState::Sunlit;
+            }
+            else
+            {
+                float sb = satBrightnessShadow(selPos, sunDir, earthRadius);
+                selInShadow = (sb < 0.6f);
+            }
 
+            prof.begin(stOrbit);
             orbitPts.clear();
-            const int orbitSamples = 512;
-            orbitPts.reserve(orbitSamples);
-            for (int i = 0; i < orbitSamples; i++)
+            if (adaptiveOrbit)
             {
-                float t = gSimTime + (orbitWindowSec * (float)i / (float)(orbitSamples - 1));
-                orbitPts.push_back(sgp4sys.sample((size_t)gSelectedSat, t, earthRadius));
+                // samples follow projected error: coarse for distant/flat arcs, dense at perigee
+                const OrbitLodView lodView(VP, gCam.pos, glm::radians(gCam.fov), gWinH);
+                orbitLodParams.maxPixelError = orbitPixelError;
+                orbitLodStats = tessellateOrbit(
+                    [&](double t)
+                    { return sgp4sys.sample((size_t)gSelectedSat, (float)t, earthRadius); },
+                    (double)gSimTime, (double)gSimTime + (double)orbitWindowSec, lodView, orbitLodParams, orbitPts);
+            }
+            else if (simFromSnapshot && simBlend.latest()->orbitSat == gSelectedSat && !simBlend.latest()->orbit.empty())
+            {
+                orbitPts = simBlend.latest()->orbit;
+                orbitLodStats.vertices = (int)orbitPts.size();
+                orbitLodStats.evaluations = 0;
+            }
+            else
+            {
+                const int orbitSamples = 512;
+                orbitPts.reserve(orbitSamples);
+                for (int i = 0; i < orbitSamples; i++)
+                {
+                    float t = gSimTime + (orbitWindowSec * (float)i / (float)(orbitSamples - 1));
+                    orbitPts.push_back(sgp4sys.sample((size_t)gSelectedSat, t, earthRadius));
+                }
+                orbitLodStats.vertices = orbitLodStats.evaluations = orbitSamples;
             }
             if (!orbitPts.empty())
                 orbitPts.back() = orbitPts.front();
             orbitLine.update(orbitPts);
-            
-            // ground track adjust later i dont really like this maybe disable it on start:/
+            prof.end(stOrbit);
+
+            // ground tracks are cached as lat/lon and only extended as time advances
             if (showGroundTrack)
             {
-                groundPts.clear();
-                int N = std::max(32, groundSamples);
-                groundPts.reserve((size_t)N);
+                ProfileScope ps(prof, stGround);
+                groundCache.configure(startUtcTP, useRealSun && rotateEarthGMST, earthLonOffsetDeg, groundStepSec);
 
-                float t0 = std::max(0.0f, gSimTime - groundDurationSec);
-                float t1 = gSimTime;
-
-                for (int i = 0; i < N; i++)
+                std::string key = std::to_string(gSelectedSat);
+                if (showGroupTracks)
+                    key += std::string("|") + groundGroupFilter + "|" + std::to_string(groundMaxTracks);
+                if (key != groundTrackedKey)
                 {
-                    float t = t0 + (t1 - t0) * (float)i / (float)(N - 1);
-
-                    auto tp =
-                        startUtcTP +
-                        std::chrono::duration_cast<std::chrono::system_clock::duration>(
-                            std::chrono::duration<double>(t));
-
-                    float th = 0.0f;
-                    if (useRealSun && rotateEarthGMST)
-                        th = (float)gmstRadians_FromUTC(tp) + glm::radians(earthLonOffsetDeg);
+                    groundTracked.assign(1, gSelectedSat);
+                    if (showGroupTracks)
+                    {
+                        for (size_t i = 0; i < satCount && (int)groundTracked.size() < groundMaxTracks; ++i)
+                            if ((int)i != gSelectedSat && containsNoCase(sgp4sys.name(i), groundGroupFilter))
+                                groundTracked.push_back((int)i);
+                    }
+                    groundCache.setTracked(groundTracked);
+                    groundTrackedKey = key;
+                }
 
-                    glm::vec3 pEci = sgp4sys.sample((size_t)gSelectedSat, t, earthRadius);
-                    glm::vec3 pEcef = rotateY(pEci, -th);
+                groundCache.update(sgp4sys, gSimTime, groundDurationSec, groundSampleBudget);
 
-                    float len = glm::length(pEcef);
-                    if (len < 1e-6f)
-                        continue;
+                const int64_t stepIdx = (int64_t)std::floor((double)gSimTime / groundCache.stepSec());
+                if (groundCache.version() != groundBuiltVersion || stepIdx != groundBuiltStep)
+                {
+                    groundCache.buildSegments(gSimTime, groundDurationSec, earthRadius * 1.002f, groundPts);
+                    groundLine.update(groundPts);
+                    groundBuiltVersion = groundCache.version();
+                    groundBuiltStep = stepIdx;
+                }
+            }
 
-                    glm::vec3 s = (pEcef / len) * (earthRadius * 1.002f);
-                    glm::vec3 sWorld = rotateY(s, th);
-                    groundPts.push_back(sWorld);
+            // whole-constellation orbits: refit on filter change or after the refit interval,
+            // otherwise the batch just spins its nodes on the GPU
+            if (showOrbitBatch)
+            {
+                std::string key = std::string(orbitBatchFilter) + "|" + std::to_string(orbitBatchMax) + "|" +
+                                  std::to_string(orbitBatchColorBy);
+                if (key != orbitBatchKey ||
+                    std::fabs((double)gSimTime - orbitBatch.fitSec()) > (double)orbitBatchRefitHrs * 3600.0)
+                {
+                    ProfileScope ps(prof, stOrbitBatch);
+                    std::vector<int> sats;
+                    for (size_t i = 0; i < satCount && (int)sats.size() < orbitBatchMax; ++i)
+                        if (containsNoCase(sgp4sys.name(i), orbitBatchFilter))
+                            sats.push_back((int)i);
+
+                    orbitBatch.build(sgp4sys, sats, (OrbitColorBy)orbitBatchColorBy, glm::vec4(0.55f, 0.75f, 1.0f, 1.0f),
+                                     gSimTime, (float)(earthRadius / EARTH_RADIUS_KM));
+                    orbitBatchKey = key;
                 }
-                groundLine.update(groundPts);
             }
 
             if (showNadirLine)
@@ -787,11 +1405,196 @@ int main()
             }
         }
 
+        // watch list: one background pass for every primary, secondaries propagated once per step
+        if (watchPending.valid() && watchPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            watchResult = watchPending.get();
+        if (!watchPending.valid() && loaded && !gWatch_Sats.empty() &&
+            (gWatch_Dirty || watchResult.primaries != gWatch_Sats ||
+             (gWatch_Auto && std::fabs((double)gSimTime - watchResult.startSec) > (double)gWatch_RefreshSec)))
+        {
+            gWatch_Dirty = false;
+            const ConjunctionParams p = ssaParams(elIndex, subset);
+            const double t0 = (double)gSimTime;
+            const bool withPc = gSSA_ComputePc;
+            const CovarianceCatalog cov = gSSA_Covariance;
+            const PcParams pcp = gSSA_PcParams;
+            watchPending = std::async(std::launch::async, [&sgp4sys, sats = gWatch_Sats, p, t0, withPc, cov, pcp]()
+            {
+                auto w0 = std::chrono::high_resolution_clock::now();
+                WatchResult r;
+                r.startSec = t0;
+                r.primaries = sats;
+                const std::vector<size_t> prim(sats.begin(), sats.end());
+                computeConjunctionsWatchList(sgp4sys, prim, t0, p, r.hits);
+                if (withPc)
+                {
+                    for (size_t k = 0; k < prim.size(); ++k)
+                        computeCollisionProbabilities(sgp4sys, prim[k], cov, pcp, r.hits[k]);
+                }
+                auto w1 = std::chrono::high_resolution_clock::now();
+                r.ms = (float)std::chrono::duration<double, std::milli>(w1 - w0).count();
+                return r;
+            });
+        }
+
+        // maneuver what-if: secondaries are cached once, each candidate burn only re-propagates the primary
+        if (manCachePending.valid() && manCachePending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            manCache = manCachePending.get();
+            manDirty = true;
+        }
+        if (manPending.valid() && manPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            manResult = manPending.get();
+        if (manDirty && !manPending.valid() && manCache.eph)
+        {
+            manDirty = false;
+            Burn burn;
+            burn.tSec = manCache.eph->t0Sec() + (double)gMan_BurnInSec;
+            burn.dvRtnMS = glm::dvec3(gMan_DvRtn[0], gMan_DvRtn[1], gMan_DvRtn[2]);
+            manPending = std::async(std::launch::async, [&sgp4sys, eph = manCache.eph, burn, cov = gSSA_Covariance, pcp = gSSA_PcParams,
+                                                         base = manCache.base.hits]()
+                                    { return evaluateManeuver(sgp4sys, *eph, burn, cov, pcp, &base); });
+        }
+
+        if (numPending.valid() && numPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            // a failed build leaves the current override in place
+            std::shared_ptr<NumericalPropagator> prop = numPending.get();
+            if (prop)
+                attachNumerical(std::move(prop));
+            else
+                gNum_Error = "Integration failed (could not allocate the history)";
+        }
+        if (cloudPending.valid() && cloudPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            std::shared_ptr<const DebrisCloud> c = cloudPending.get();
+            if (c)
+                attachCloud(std::move(c));
+        }
+        if (senPending.valid() && senPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            senResult = senPending.get();
+        if (covPending.valid() && covPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            gCov_Grid = covPending.get();
+        if (visPending.valid() && visPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            auto r = visPending.get();
+            gVis_Passes = std::move(r.first);
+            gVis_LastRunMs = r.second;
+        }
+
+        // link graph: re-tested once per step against a neighbour list that survives several steps
+        if (gLink_On && loaded && satCount > 0)
+        {
+            ProfileScope ps(prof, stLinks);
+            if (linkMembersDirty)
+            {
+                std::vector<uint32_t> members;
+                if (gLink_UseSubset)
+                    members = *subset;
+                else
+                    for (size_t i = 0; i < satCount; ++i)
+                        if (containsNoCase(sgp4sys.name(i), gLink_NameFilter))
+                            members.push_back((uint32_t)i);
+                linkGraph.setMembers(std::move(members));
+                linkMembersDirty = false;
+            }
+
+            const bool stepped = !linkGraph.valid() || std::fabs((double)gSimTime - linkGraph.timeSec()) >= (double)gLink_StepSec;
+            if (stepped)
+            {
+                linkGraph.update(sgp4sys, (double)gSimTime, gLink_Params, gVis_Station, gmstRadians_FromUTC(simUtcTP));
+                linkGraph.buildSegments((float)(earthRadius / EARTH_RADIUS_KM), linkPts);
+                linkLine.update(linkPts);
+                if (gLink_Record && !linkGraph.exportCsv(gLink_CsvPath, sgp4sys, gVis_Station.name, true))
+                {
+                    std::cerr << "Failed to write " << gLink_CsvPath << "\n";
+                    gLink_Record = false;
+                }
+            }
+
+            // route from the selected member down to the station
+            const int slot = linkGraph.slotOf((uint32_t)gSelectedSat);
+            std::vector<uint32_t> route;
+            linkPathPts.clear();
+            if (slot >= 0 && linkGraph.pathToGround((size_t)slot, route))
+            {
+                glm::vec3 p;
+                for (uint32_t k : route)
+                    if (linkGraph.positionKm(k, p))
+                        linkPathPts.push_back(p * (float)(earthRadius / EARTH_RADIUS_KM));
+                linkPathPts.push_back(linkGraph.stationKm() * (float)(earthRadius / EARTH_RADIUS_KM));
+            }
+            linkPathLine.update(linkPathPts);
+        }
+
+        // continuous screening only samples the newly exposed tail of the horizon
+        if (gSSA_Continuous && loaded && satCount > 0)
+        {
+            ProfileScope ps(prof, stScreen);
+            auto t0 = std::chrono::high_resolution_clock::now();
+            const bool changed = gSSA_Screener.update(sgp4sys, (size_t)gSelectedSat, (double)gSimTime, ssaParams(elIndex, subset), gSSA_StepsPerFrame);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gSSA_LastRunMs = (float)std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+            if (changed || gSSA_HitsForSat != gSelectedSat)
+            {
+                // keep the selected event across refreshes
+                const bool hadSel = gSSA_HitsForSat == gSelectedSat && gSSA_SelectedHit >= 0 &&
+                                    (size_t)gSSA_SelectedHit < gSSA_Hits.size();
+                const ConjunctionHit prevSel = hadSel ? gSSA_Hits[(size_t)gSSA_SelectedHit] : ConjunctionHit{};
+
+                gSSA_Hits = gSSA_Screener.hits();
+                rankSSAHits(sgp4sys, (size_t)gSelectedSat);
+                gSSA_HitsForSat = gSelectedSat;
+                gSSA_SelectedHit = -1;
+                for (size_t i = 0; hadSel && i < gSSA_Hits.size(); ++i)
+                {
+                    if (gSSA_Hits[i].otherIdx == prevSel.otherIdx && std::fabs(gSSA_Hits[i].tcaSec - prevSel.tcaSec) < (double)gSSA_StepSec)
+                    {
+                        gSSA_SelectedHit = (int)i;
+                        break;
+                    }
+                }
+                if (gSSA_SelectedHit < 0 && !gSSA_Order.empty())
+                    gSSA_SelectedHit = gSSA_Order.front();
+                if (gSSA_Hits.empty())
+                {
+                    conjPts.clear();
+                    conjLine.update(conjPts);
+                }
+            }
+        }
+
         // ImGui
+        prof.begin(stUi);
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        if (hoverSat >= 0 && (size_t)hoverSat < satCount)
+        {
+            float hr = glm::length(satPos[(size_t)hoverSat]);
+            ImGui::SetTooltip("%s\nAlt: %.0f km", sgp4sys.name((size_t)hoverSat).c_str(),
+                              (hr - earthRadius) * EARTH_RADIUS_KM);
+        }
+        if (dragMode == DragMode::Rect || dragMode == DragMode::Lasso)
+        {
+            ImDrawList *fg = ImGui::GetForegroundDrawList();
+            const ImU32 col = IM_COL32(255, 215, 64, 200);
+            double mx = 0.0, my = 0.0;
+            glfwGetCursorPos(window, &mx, &my);
+            if (dragMode == DragMode::Rect)
+            {
+                fg->AddRect(ImVec2(dragStart.x, dragStart.y), ImVec2((float)mx, (float)my), col);
+            }
+            else
+            {
+                for (size_t i = 1; i < lassoPts.size(); i++)
+                    fg->AddLine(ImVec2(lassoPts[i - 1].x, lassoPts[i - 1].y), ImVec2(lassoPts[i].x, lassoPts[i].y), col);
+                fg->AddLine(ImVec2(lassoPts.back().x, lassoPts.back().y), ImVec2((float)mx, (float)my), col);
+            }
+        }
+
         ImGui::Begin("Controls");
         ImGui::Checkbox("Paused", &gPaused);
         ImGui::SliderFloat("Time scale", &gTimeScale, 0.125f, 512.0f, "%.3gx", ImGuiSliderFlags_Logarithmic);
@@ -804,13 +1607,71 @@ int main()
 
         ImGui::Separator();
         ImGui::Text("TLE: %s", tlePath.c_str());
-        ImGui::Text("Loaded: %s | sats: %d", loaded ? "yes" : "no", (int)satCount);
-
-        ImGui::Separator();
+        ImGui::SameLine();
+        if (ImGui::Button("Reload"))
         {
-            int before = gSelectedSat;
-            ImGui::SliderInt("Selected", &gSelectedSat, 0, (satCount > 0) ? ((int)satCount - 1) : 0);
-            if (gSelectedSat != before)
+            // nothing may read the catalog while it is replaced
+            quiesceCatalog();
+            numPending = {};
+            cloudPending = {};
+
+            const unsigned selNorad = satCount > 0 ? sgp4sys.noradId((size_t)gSelectedSat) : 0;
+            std::vector<unsigned> watchNorad;
+            for (int id : gWatch_Sats)
+                watchNorad.push_back(sgp4sys.noradId((size_t)id));
+            if (sgp4sys.loadFromTleFile(tlePath))
+            {
+                loaded = true;
+                // the load dropped the override and the fragments
+                numProp.reset();
+                cloud.reset();
+                resizeObjects();
+                multiSel.clear();
+
+                gSelectedSat = 0;
+                for (size_t i = 0; i < satCount; ++i)
+                {
+                    if (sgp4sys.noradId(i) == selNorad)
+                    {
+                        gSelectedSat = (int)i;
+                        break;
+                    }
+                }
+                gWatch_Sats.clear();
+                for (unsigned norad : watchNorad)
+                {
+                    for (size_t i = 0; i < satCount; ++i)
+                    {
+                        if (sgp4sys.noradId(i) == norad)
+                        {
+                            gWatch_Sats.push_back((int)i);
+                            break;
+                        }
+                    }
+                }
+
+                if (gSSA_CovLoaded > 0)
+                {
+                    gSSA_Covariance.clearSupplied();
+                    gSSA_CovLoaded = gSSA_Covariance.loadCsv(gSSA_CovPath, sgp4sys);
+                }
+
+                // the screener keeps every pair whose elements did not change
+                gSSA_Screener.onCatalogReload(sgp4sys);
+                clearSSA(conjLine, conjPts);
+            }
+            else
+            {
+                std::cerr << "Failed to reload TLE file: " << tlePath << "\n";
+            }
+        }
+        ImGui::Text("Loaded: %s | sats: %d", loaded ? "yes" : "no", (int)satCount);
+
+        ImGui::Separator();
+        {
+            int before = gSelectedSat;
+            ImGui::SliderInt("Selected", &gSelectedSat, 0, (satCount > 0) ? ((int)satCount - 1) : 0);
+            if (gSelectedSat != before)
                 clearSSA(conjLine, conjPts);
         }
 
@@ -827,19 +1688,138 @@ int main()
 
         ImGui::Separator();
         ImGui::SliderInt("Draw limit", &drawLimit, 1, (satCount > 0) ? (int)satCount : 1);
+        if (ImGui::CollapsingHeader("Subset (element filter + query)"))
+        {
+            ImGui::Checkbox("Draw only the subset", &subsetOn);
+            bool changed = ImGui::Checkbox("Altitude band (km)", &elFilter.useAltitude);
+            if (elFilter.useAltitude)
+                changed |= ImGui::DragFloatRange2("##alt", &elFilter.altLoKm, &elFilter.altHiKm, 1.0f, -200.0f, 400000.0f, "%.0f");
+            changed |= ImGui::Checkbox("Inclination (deg)", &elFilter.useInclination);
+            if (elFilter.useInclination)
+                changed |= ImGui::DragFloatRange2("##inc", &elFilter.incLoDeg, &elFilter.incHiDeg, 0.1f, 0.0f, 180.0f, "%.1f");
+            changed |= ImGui::Checkbox("RAAN (deg, wraps)", &elFilter.useRaan);
+            if (elFilter.useRaan)
+            {
+                changed |= ImGui::SliderFloat("RAAN from", &elFilter.raanLoDeg, 0.0f, 360.0f, "%.1f");
+                changed |= ImGui::SliderFloat("RAAN to", &elFilter.raanHiDeg, 0.0f, 360.0f, "%.1f");
+            }
+            changed |= ImGui::Checkbox("Eccentricity", &elFilter.useEccentricity);
+            if (elFilter.useEccentricity)
+                changed |= ImGui::DragFloatRange2("##ecc", &elFilter.eccLo, &elFilter.eccHi, 0.001f, 0.0f, 1.0f, "%.4f");
+            changed |= ImGui::Checkbox("Sun-synchronous", &elFilter.sunSynchronous);
+
+            if (ImGui::InputText("Query", queryText, sizeof(queryText), ImGuiInputTextFlags_EnterReturnsTrue))
+            {
+                if (subsetQuery.compile(queryText, queryError))
+                    changed = true;
+            }
+            ImGui::TextDisabled("e.g. alt_perigee < 600 && inc > 97 && name ~ \"STARLINK\"");
+            if (!queryError.empty())
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "%s", queryError.c_str());
+            if (changed)
+                drawListDirty = true;
+
+            ImGui::Text("Subset: %d (drawing %d) | query %.0f us", (int)drawList.size(),
+                        (int)(subsetOn ? std::min(drawList.size(), (size_t)drawLimit) : std::min(satCount, (size_t)drawLimit)),
+                        elQueryUs);
+            ImGui::Text("Index: %d objects, built in %.1f ms", (int)elIndex.count(), elIndex.lastBuildMs());
+        }
+        {
+            const char *modes[] = {"SGP4 (CPU)", "J2 mean elements (CPU)", "J2 mean elements (GPU)"};
+            int m = (int)propMode;
+            if (ImGui::Combo("Propagation", &m, modes, 3))
+                propMode = (PropMode)m;
+        }
+        if (propMode != PropMode::Sgp4)
+        {
+            ImGui::SliderFloat("Full resync (sim sec)", &j2ResyncSec, 60.0f, 86400.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+            ImGui::SliderFloat("Error bound (km)", &j2ErrorBoundKm, 1.0f, 200.0f, "%.0f");
+            ImGui::SliderInt("SGP4 checks / frame", &j2CheckPerFrame, 0, 1024);
+            ImGui::Text("Max checked error: %.1f km | refit: %d", j2MaxErrKm, (int)j2Repaired);
+            if (propMode == PropMode::J2Gpu && propSh.id() == 0)
+                ImGui::TextUnformatted("GPU path unavailable, using the CPU reference");
+            else if (propMode == PropMode::J2Gpu && gEcl_UseTable)
+                ImGui::TextUnformatted("Eclipse table shading is on, using the CPU reference");
+        }
+        else
+        {
+            ImGui::Checkbox("Propagate on sim thread", &simThreaded);
+            if (simThreaded)
+            {
+                ImGui::SliderFloat("Sim rate (Hz)", &simRateHz, 1.0f, 120.0f, "%.0f");
+                ImGui::Text("Sim pass: %.1f ms | %.1f Hz | %s", simThread.lastBuildMs(), simThread.achievedHz(),
+                            simFromSnapshot ? "blending snapshots" : "direct (no snapshot)");
+            }
+        }
+        ImGui::Checkbox("Cull sats (frustum + Earth)", &cullSats);
+        ImGui::Text("Drawn: %d / %d | offscreen %d | behind Earth %d",
+                    (int)satDrawCount, (int)cullStats.tested, (int)cullStats.outsideFrustum, (int)cullStats.occluded);
+        ImGui::Text("Propagate+cull: %.2f ms | upload %.0f KB (%.0f KB unculled)", cullMs,
+                    (double)satDrawCount * sizeof(SatVertex) / 1024.0,
+                    (double)cullStats.tested * sizeof(SatVertex) / 1024.0);
         ImGui::SliderFloat("Pick radius (px)", &pickRadiusPx, 3.0f, 30.0f, "%.0f");
+        ImGui::Checkbox("Select behind Earth", &pickIncludeHidden);
+        ImGui::Text("Pickable: %d | shift-drag = rect, ctrl-drag = lasso", (int)picker.size());
+
+        if (!multiSel.empty() && ImGui::CollapsingHeader("Multi-selection"))
+        {
+            ImGui::Text("%d sats", (int)multiSel.size());
+            ImGui::SameLine();
+            if (ImGui::Button("Clear##multisel"))
+                multiSel.clear();
+
+            const int shown = std::min(50, (int)multiSel.size());
+            for (int i = 0; i < shown; ++i)
+            {
+                const int id = multiSel[(size_t)i];
+                if (id < 0 || (size_t)id >= satCount)
+                    continue;
+                char label[160];
+                std::snprintf(label, sizeof(label), "%s##ms%d", sgp4sys.name((size_t)id).c_str(), id);
+                if (ImGui::Selectable(label, id == gSelectedSat) && id != gSelectedSat)
+                {
+                    gSelectedSat = id;
+                    clearSSA(conjLine, conjPts);
+                }
+            }
+        }
 
         ImGui::Separator();
         ImGui::Checkbox("Auto orbit window (1 period)", &autoOrbitWindow);
         ImGui::Checkbox("Show hidden orbit (dim)", &showHiddenOrbit);
         ImGui::SliderFloat("Orbit window (sec)", &orbitWindowSec, 10.0f, 172800.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+        ImGui::Checkbox("Adaptive orbit (screen-space error)", &adaptiveOrbit);
+        if (adaptiveOrbit)
+            ImGui::SliderFloat("Orbit pixel error", &orbitPixelError, 0.1f, 8.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+        ImGui::Text("Orbit vertices: %d | SGP4 calls: %d", orbitLodStats.vertices, orbitLodStats.evaluations);
 
         ImGui::Separator();
         ImGui::Checkbox("Ground track", &showGroundTrack);
         ImGui::SliderFloat("Track duration (sec)", &groundDurationSec, 300.0f, 43200.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
-        ImGui::SliderInt("Track samples", &groundSamples, 64, 2048);
+        ImGui::SliderFloat("Track step (sec)", &groundStepSec, 2.0f, 120.0f, "%.0f");
+        ImGui::Checkbox("Tracks for all matching", &showGroupTracks);
+        if (showGroupTracks)
+        {
+            ImGui::InputText("Track name contains", groundGroupFilter, sizeof(groundGroupFilter));
+            ImGui::SliderInt("Max tracks", &groundMaxTracks, 1, 5000);
+        }
+        ImGui::SliderInt("Track samples / frame", &groundSampleBudget, 500, 200000, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::Text("Tracks: %d | cached samples: %d", (int)groundCache.trackedCount(), (int)groundCache.cachedSamples());
         ImGui::Checkbox("Show backside track (dim)", &showBacksideTrack);
 
+        ImGui::Separator();
+        ImGui::Checkbox("Orbits for all matching", &showOrbitBatch);
+        if (showOrbitBatch)
+        {
+            const char *colorBy[] = {"Single color", "By inclination", "By altitude"};
+            ImGui::InputText("Orbit name contains", orbitBatchFilter, sizeof(orbitBatchFilter));
+            ImGui::SliderInt("Max orbits", &orbitBatchMax, 1, 30000, "%d", ImGuiSliderFlags_Logarithmic);
+            ImGui::Combo("Orbit color", &orbitBatchColorBy, colorBy, 3);
+            ImGui::SliderFloat("Orbit alpha", &orbitBatchAlpha, 0.02f, 1.0f, "%.2f");
+            ImGui::SliderFloat("Orbit refit (hours)", &orbitBatchRefitHrs, 0.5f, 72.0f, "%.1f");
+            ImGui::Text("Orbits: %d | fit %.0f s ago", (int)orbitBatch.orbitCount(), gSimTime - orbitBatch.fitSec());
+        }
+
         ImGui::Separator();
         ImGui::Checkbox("Nadir line (sat -> surface)", &showNadirLine);
         ImGui::SliderFloat("Nadir alpha", &nadirAlpha, 0.05f, 1.0f, "%.2f");
@@ -871,6 +1851,10 @@ int main()
             ImGui::SliderFloat("Step (sec)", &gSSA_StepSec, 1.0f, 120.0f, "%.0f");
             ImGui::SliderFloat("Threshold (km)", &gSSA_ThresholdKm, 1.0f, 200.0f, "%.1f");
             ImGui::Checkbox("Refine TCA", &gSSA_Refine);
+            ImGui::SameLine();
+            ImGui::Checkbox("Perigee/apogee pre-filter", &gSSA_Prefilter);
+            ImGui::SameLine();
+            ImGui::Checkbox("Subset only", &gSSA_SubsetOnly);
 
             int maxMax = (satCount > 0) ? (int)satCount : 1;
             gSSA_MaxSats = std::clamp(gSSA_MaxSats, 1, maxMax);
@@ -879,27 +1863,38 @@ int main()
             ImGui::Checkbox("Show conjunction line", &gSSA_ShowConjLine);
             ImGui::SliderFloat("Conj line alpha", &gSSA_ConjAlpha, 0.05f, 1.0f, "%.2f");
 
-            if (ImGui::Button("Run conjunction screening"))
+            if (ImGui::Checkbox("Continuous screening", &gSSA_Continuous))
+            {
+                gSSA_Screener.reset();
+                clearSSA(conjLine, conjPts);
+            }
+            if (gSSA_Continuous)
+            {
+                ImGui::SliderInt("Steps per frame", &gSSA_StepsPerFrame, 1, 256);
+                if (gSSA_Screener.caughtUp())
+                    ImGui::Text("Covered to %+.0f s | %.2f ms/frame | hits: %d", gSSA_Screener.coveredUntilSec() - gSimTime,
+                                gSSA_LastRunMs, (int)gSSA_Hits.size());
+                else
+                    ImGui::Text("Catching up: %+.0f s of %.0f s | hits: %d", gSSA_Screener.coveredUntilSec() - gSimTime,
+                                (double)gSSA_HorizonHrs * 3600.0, (int)gSSA_Hits.size());
+            }
+            else if (ImGui::Button("Run conjunction screening"))
             {
                 if (loaded && satCount > 0)
                 {
-                    ConjunctionParams p;
-                    p.horizonSec = (double)gSSA_HorizonHrs * 3600.0;
-                    p.stepSec = (double)gSSA_StepSec;
-                    p.thresholdKm = (double)gSSA_ThresholdKm;
-                    p.maxSatsToCheck = gSSA_MaxSats;
-                    p.refine = gSSA_Refine;
-
+                    ProfileScope ps(prof, stScreen);
                     auto t0 = std::chrono::high_resolution_clock::now();
                     bool ok = computeConjunctionsSelectedVsAll(
                         sgp4sys,
                         (size_t)gSelectedSat,
                         (double)gSimTime,
-                        p,
+                        ssaParams(elIndex, subset),
                         gSSA_Hits);
                     auto t1 = std::chrono::high_resolution_clock::now();
                     gSSA_LastRunMs = (float)std::chrono::duration<double, std::milli>(t1 - t0).count();
 
+                    rankSSAHits(sgp4sys, (size_t)gSelectedSat);
+
                     if (!ok || gSSA_Hits.empty())
                     {
                         gSSA_SelectedHit = -1;
@@ -909,21 +1904,922 @@ int main()
                     }
                     else
                     {
-                        gSSA_SelectedHit = 0;
+                        gSSA_SelectedHit = gSSA_Order.front();
                         gSSA_HitsForSat = gSelectedSat;
                     }
                 }
             }
 
+            if (!gSSA_Continuous)
+            {
+                ImGui::SameLine();
+                ImGui::Text("Last run: %.1f ms | hits: %d", gSSA_LastRunMs, (int)gSSA_Hits.size());
+            }
+
+            ImGui::Checkbox("Collision probability (Pc)", &gSSA_ComputePc);
+            if (gSSA_ComputePc)
+            {
+                ImGui::SliderInt("Pc quadrature nodes", &gSSA_PcParams.quadratureNodes, 8, 128);
+                ImGui::Checkbox("Monte Carlo cross-check", &gSSA_PcParams.monteCarlo);
+                if (gSSA_PcParams.monteCarlo)
+                    ImGui::SliderInt("MC samples", &gSSA_PcParams.mcSamples, 10000, 5000000, "%d", ImGuiSliderFlags_Logarithmic);
+
+                ImGui::InputText("Covariance CSV", gSSA_CovPath, sizeof(gSSA_CovPath));
+                ImGui::SameLine();
+                if (ImGui::Button("Load##cov") && loaded)
+                {
+                    gSSA_Covariance.clearSupplied();
+                    gSSA_CovLoaded = gSSA_Covariance.loadCsv(gSSA_CovPath, sgp4sys);
+                    if (gSSA_CovLoaded < 0)
+                        std::cerr << "Failed to read " << gSSA_CovPath << "\n";
+                }
+                ImGui::Text("Supplied covariances: %d (others use class defaults) | Pc: %.1f ms",
+                            (int)gSSA_Covariance.suppliedCount(), gSSA_LastPcMs);
+            }
+
+            if (gSSA_HitsForSat == gSelectedSat && !gSSA_Order.empty() &&
+                ImGui::BeginTable("conj", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Sortable | ImGuiTableFlags_SizingFixedFit,
+                                  ImVec2(0.0f, 220.0f)))
+            {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Object", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Class", ImGuiTableColumnFlags_NoSort);
+                ImGui::TableSetupColumn("TCA (s)");
+                ImGui::TableSetupColumn("Miss (km)");
+                ImGui::TableSetupColumn("Vrel (km/s)");
+                ImGui::TableSetupColumn("Pc", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+                ImGui::TableSetupColumn("Pc (MC)", ImGuiTableColumnFlags_PreferSortDescending);
+                ImGui::TableHeadersRow();
+
+                if (ImGuiTableSortSpecs *specs = ImGui::TableGetSortSpecs())
+                {
+                    if (specs->SpecsDirty && specs->SpecsCount > 0)
+                    {
+                        const int col = specs->Specs[0].ColumnIndex;
+                        const bool asc = specs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+                        auto key = [col](const ConjunctionHit &h)
+                        {
+                            switch (col)
+                            {
+                            case 2: return h.tcaSec;
+                            case 3: return h.missKm;
+                            case 4: return h.relSpeedKmS;
+                            case 6: return h.pcMonteCarlo;
+                            default: return h.pc;
+                            }
+                        };
+                        std::stable_sort(gSSA_Order.begin(), gSSA_Order.end(), [&](int a, int b)
+                        {
+                            const double ka = key(gSSA_Hits[(size_t)a]), kb = key(gSSA_Hits[(size_t)b]);
+                            return asc ? ka < kb : ka > kb;
+                        });
+                    }
+                    specs->SpecsDirty = false;
+                }
+
+                for (int hi : gSSA_Order)
+                {
+                    const ConjunctionHit &h = gSSA_Hits[(size_t)hi];
+                    if (h.otherIdx < 0 || (size_t)h.otherIdx >= satCount)
+                        continue;
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    char label[96];
+                    std::snprintf(label, sizeof(label), "%s##hit%d", sgp4sys.name((size_t)h.otherIdx).c_str(), hi);
+                    if (ImGui::Selectable(label, hi == gSSA_SelectedHit, ImGuiSelectableFlags_SpanAllColumns))
+                        gSSA_SelectedHit = hi;
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(objectClassName(classifyObject(sgp4sys.name((size_t)h.otherIdx))));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%+.0f", h.tcaSec - gSimTime);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", h.missKm);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", h.relSpeedKmS);
+                    ImGui::TableNextColumn();
+                    if (h.pc >= 0.0)
+                        ImGui::Text("%.2e", h.pc);
+                    else
+                        ImGui::TextDisabled("-");
+                    ImGui::TableNextColumn();
+                    if (h.pcMonteCarlo >= 0.0)
+                        ImGui::Text("%.2e +/- %.0e", h.pcMonteCarlo, h.pcMcStdErr);
+                    else
+                        ImGui::TextDisabled("-");
+                }
+                ImGui::EndTable();
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("SSA - Watch list"))
+        {
+            auto watch = [](int id)
+            {
+                if (std::find(gWatch_Sats.begin(), gWatch_Sats.end(), id) == gWatch_Sats.end())
+                    gWatch_Sats.push_back(id);
+            };
+            if (ImGui::Button("Watch selected") && loaded && satCount > 0)
+                watch(gSelectedSat);
+            if (!multiSel.empty())
+            {
+                ImGui::SameLine();
+                if (ImGui::Button("Watch multi-selection"))
+                {
+                    for (int id : multiSel)
+                    {
+                        if (id >= 0 && (size_t)id < satCount)
+                            watch(id);
+                    }
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear##watch"))
+                gWatch_Sats.clear();
+
+            ImGui::Checkbox("Auto refresh", &gWatch_Auto);
+            ImGui::SameLine();
+            if (ImGui::Button("Refresh now"))
+                gWatch_Dirty = true;
+            ImGui::SliderFloat("Refresh every (sim s)", &gWatch_RefreshSec, 60.0f, 7200.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+            ImGui::Text("Uses the screening parameters above | %d primaries | %.0f ms%s", (int)gWatch_Sats.size(),
+                        watchResult.ms, watchPending.valid() ? " | screening..." : "");
+
+            int removeAt = -1;
+            for (size_t wi = 0; wi < gWatch_Sats.size(); ++wi)
+            {
+                const int id = gWatch_Sats[wi];
+                if (id < 0 || (size_t)id >= satCount)
+                    continue;
+
+                const std::vector<ConjunctionHit> *hits = nullptr;
+                for (size_t k = 0; k < watchResult.primaries.size(); ++k)
+                {
+                    if (watchResult.primaries[k] == id && k < watchResult.hits.size())
+                        hits = &watchResult.hits[k];
+                }
+                int upcoming = 0;
+                double worstPc = -1.0;
+                for (size_t h = 0; hits && h < hits->size(); ++h)
+                {
+                    if ((*hits)[h].tcaSec < gSimTime)
+                        continue;
+                    upcoming++;
+                    worstPc = std::max(worstPc, (*hits)[h].pc);
+                }
+
+                ImGui::PushID(id);
+                char label[160];
+                if (worstPc >= 0.0)
+                    std::snprintf(label, sizeof(label), "%s (%d, max Pc %.1e)###w", sgp4sys.name((size_t)id).c_str(), upcoming, worstPc);
+                else
+                    std::snprintf(label, sizeof(label), "%s (%d)###w", sgp4sys.name((size_t)id).c_str(), upcoming);
+                const bool open = ImGui::TreeNode(label);
+                ImGui::SameLine();
+                if (ImGui::SmallButton("select") && id != gSelectedSat)
+                {
+                    gSelectedSat = id;
+                    clearSSA(conjLine, conjPts);
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton("remove"))
+                    removeAt = (int)wi;
+
+                if (open)
+                {
+                    if (hits && upcoming > 0 &&
+                        ImGui::BeginTable("watchconj", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+                    {
+                        ImGui::TableSetupColumn("Object", ImGuiTableColumnFlags_WidthStretch);
+                        ImGui::TableSetupColumn("TCA (s)");
+                        ImGui::TableSetupColumn("Miss (km)");
+                        ImGui::TableSetupColumn("Vrel (km/s)");
+                        ImGui::TableSetupColumn("Pc");
+                        ImGui::TableHeadersRow();
+                        for (const ConjunctionHit &h : *hits)
+                        {
+                            if (h.tcaSec < gSimTime || h.otherIdx < 0 || (size_t)h.otherIdx >= satCount)
+                                continue;
+                            ImGui::TableNextRow();
+                            ImGui::TableNextColumn();
+                            ImGui::TextUnformatted(sgp4sys.name((size_t)h.otherIdx).c_str());
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%+.0f", h.tcaSec - gSimTime);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%.3f", h.missKm);
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%.2f", h.relSpeedKmS);
+                            ImGui::TableNextColumn();
+                            if (h.pc >= 0.0)
+                                ImGui::Text("%.2e", h.pc);
+                            else
+                                ImGui::TextDisabled("-");
+                        }
+                        ImGui::EndTable();
+                    }
+                    else if (!hits)
+                    {
+                        ImGui::TextDisabled("pending");
+                    }
+                    ImGui::TreePop();
+                }
+                ImGui::PopID();
+            }
+            if (removeAt >= 0)
+                gWatch_Sats.erase(gWatch_Sats.begin() + removeAt);
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("SSA - Maneuver what-if"))
+        {
+            ImGui::SliderFloat("Altitude pad (km)", &gMan_PadKm, 0.0f, 1000.0f, "%.0f");
+            if (ImGui::Button("Cache secondaries for selected") && loaded && satCount > 0 && !manCachePending.valid())
+            {
+                const size_t primary = (size_t)gSelectedSat;
+                const double t0 = (double)gSimTime;
+                const ConjunctionParams p = ssaParams(elIndex, subset);
+                manCachePending = std::async(std::launch::async, [&sgp4sys, primary, t0, p, pad = (double)gMan_PadKm,
+                                                                  cov = gSSA_Covariance, pcp = gSSA_PcParams]()
+                {
+                    ManeuverCache c;
+                    auto eph = std::make_shared<SecondaryEphemeris>();
+                    if (eph->build(sgp4sys, primary, t0, p, pad))
+                    {
+                        Burn none;
+                        none.tSec = t0;
+                        c.base = evaluateManeuver(sgp4sys, *eph, none, cov, pcp);
+                        c.eph = eph;
+                    }
+                    return c;
+                });
+            }
+            if (manCachePending.valid())
+            {
+                ImGui::SameLine();
+                ImGui::TextUnformatted("caching...");
+            }
+
+            if (manCache.eph)
+            {
+                const SecondaryEphemeris &eph = *manCache.eph;
+                ImGui::Text("%s: %d secondaries x %d steps, cached in %.0f ms", sgp4sys.name(eph.primary()).c_str(),
+                            (int)eph.objectCount(), (int)eph.steps(), eph.buildMs());
+                if (eph.primary() != (size_t)gSelectedSat)
+                    ImGui::TextDisabled("(cache is for another object)");
+
+                bool changed = ImGui::SliderFloat("Burn at (s after cache start)", &gMan_BurnInSec, 0.0f,
+                                                  (float)(eph.t1Sec() - eph.t0Sec()), "%.0f");
+                changed |= ImGui::DragFloat3("Delta-v R/T/N (m/s)", gMan_DvRtn, 0.01f, -50.0f, 50.0f, "%.2f");
+                if (ImGui::Button("Zero delta-v"))
+                {
+                    gMan_DvRtn[0] = gMan_DvRtn[1] = gMan_DvRtn[2] = 0.0f;
+                    changed = true;
+                }
+                if (changed)
+                    manDirty = true;
+                ImGui::Text("Burn at %+.0f s from now", eph.t0Sec() + (double)gMan_BurnInSec - gSimTime);
+
+                const ManeuverResult &base = manCache.base;
+                ImGui::Text("Baseline:  %d events | min miss %.3f km | max Pc %.2e", (int)base.hits.size(), base.minMissKm, base.maxPc);
+                if (manResult.valid)
+                    ImGui::Text("With burn: %d events, %d cleared | min miss %.3f km | max Pc %.2e | %.0f ms%s", (int)manResult.hits.size(),
+                                (int)manResult.avoided.size(), manResult.minMissKm, manResult.maxPc, manResult.ms,
+                                manPending.valid() ? " ..." : "");
+
+                // the same encounter before and after: same secondary, TCA within a couple of steps
+                auto baseMatch = [&](const ConjunctionHit &h) -> const ConjunctionHit *
+                {
+                    for (const ConjunctionHit &b : base.hits)
+                        if (b.otherIdx == h.otherIdx && std::fabs(b.tcaSec - h.tcaSec) < 2.0 * eph.stepSec())
+                            return &b;
+                    return nullptr;
+                };
+                if (manResult.valid && (!manResult.hits.empty() || !manResult.avoided.empty()) &&
+                    ImGui::BeginTable("maneuver", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit,
+                                      ImVec2(0.0f, 180.0f)))
+                {
+                    ImGui::TableSetupScrollFreeze(0, 1);
+                    ImGui::TableSetupColumn("Object", ImGuiTableColumnFlags_WidthStretch);
+                    ImGui::TableSetupColumn("TCA (s)");
+                    ImGui::TableSetupColumn("Miss before");
+                    ImGui::TableSetupColumn("Miss after");
+                    ImGui::TableSetupColumn("Pc after");
+                    ImGui::TableHeadersRow();
+                    for (const ConjunctionHit &h : manResult.hits)
+                    {
+                        if (h.otherIdx < 0 || (size_t)h.otherIdx >= satCount)
+                            continue;
+                        const ConjunctionHit *b = baseMatch(h);
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(sgp4sys.name((size_t)h.otherIdx).c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%+.0f", h.tcaSec - gSimTime);
+                        ImGui::TableNextColumn();
+                        if (b)
+                            ImGui::Text("%.3f", b->missKm);
+                        else
+                            ImGui::TextDisabled("new");
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f", h.missKm);
+                        ImGui::TableNextColumn();
+                        if (h.pc >= 0.0)
+                            ImGui::Text("%.2e", h.pc);
+                        else
+                            ImGui::TextDisabled("-");
+                    }
+                    // baseline encounters the burn clears: the closest approach that is left
+                    for (const ConjunctionHit &h : manResult.avoided)
+                    {
+                        if (h.otherIdx < 0 || (size_t)h.otherIdx >= satCount)
+                            continue;
+                        const ConjunctionHit *b = nullptr;
+                        for (const ConjunctionHit &c : base.hits)
+                            if (c.otherIdx == h.otherIdx && (!b || c.missKm < b->missKm))
+                                b = &c;
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(sgp4sys.name((size_t)h.otherIdx).c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%+.0f", (b ? b->tcaSec : h.tcaSec) - gSimTime);
+                        ImGui::TableNextColumn();
+                        if (b)
+                            ImGui::Text("%.3f", b->missKm);
+                        else
+                            ImGui::TextDisabled("-");
+                        ImGui::TableNextColumn();
+                        ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.5f, 1.0f), "%.3f cleared", h.missKm);
+                        ImGui::TableNextColumn();
+                        if (h.pc >= 0.0)
+                            ImGui::Text("%.2e", h.pc);
+                        else
+                            ImGui::TextDisabled("-");
+                    }
+                    ImGui::EndTable();
+                }
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Numerical propagation"))
+        {
+            ImGui::SliderInt("Zonal degree", &gNum_Params.zonalDegree, 0, 6, gNum_Params.zonalDegree < 2 ? "two-body" : "J2..J%d");
+            ImGui::Checkbox("Atmospheric drag (B* ballistic coefficient)", &gNum_Params.drag);
+            float stepSec = (float)gNum_Params.stepSec;
+            if (ImGui::SliderFloat("Step (s)##num", &stepSec, 5.0f, 120.0f, "%.0f"))
+                gNum_Params.stepSec = (double)stepSec;
+            ImGui::SliderFloat("Horizon (h)##num", &gNum_HorizonHrs, 1.0f, 72.0f, "%.0f");
+            float outSec = (float)gNum_Params.outputSec;
+            if (ImGui::SliderFloat("Stored every (s)##num", &outSec, (float)gNum_Params.stepSec, 600.0f, "%.0f"))
+                gNum_Params.outputSec = (double)outSec;
+            ImGui::SliderFloat("History cap (MB)##num", &gNum_MaxHistoryMB, 64.0f, 16384.0f, "%.0f");
+
+            const double spanSec = (double)gNum_HorizonHrs * 3600.0;
+            const double subsetMB = NumericalPropagator::historyBytesFor(subset ? subset->size() : 0, spanSec, gNum_Params) / 1e6;
+            ImGui::Text("Subset: %d objects | ~%.0f MB of trajectory", subset ? (int)subset->size() : 0, subsetMB);
+
+            // seeds from SGP4 at the current time and integrates the whole set in one batch
+            auto build = [&](std::vector<uint32_t> objects)
+            {
+                if (!loaded || objects.empty() || numPending.valid())
+                    return;
+                std::sort(objects.begin(), objects.end());
+                objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+                const double mb = NumericalPropagator::historyBytesFor(objects.size(), spanSec, gNum_Params) / 1e6;
+                if (mb > (double)gNum_MaxHistoryMB)
+                {
+                    char msg[128];
+                    std::snprintf(msg, sizeof(msg), "Refused: ~%.0f MB of trajectory is over the cap", mb);
+                    gNum_Error = msg;
+                    return;
+                }
+                gNum_Error.clear();
+                const double t0 = (double)gSimTime;
+                const double t1 = t0 + spanSec;
+                numPending = std::async(std::launch::async, [&sgp4sys, objects = std::move(objects), t0, t1, p = gNum_Params]()
+                {
+                    auto prop = std::make_shared<NumericalPropagator>();
+                    try
+                    {
+                        prop->seedFromSgp4(sgp4sys, objects, t0, p);
+                        prop->propagateTo(t1);
+                    }
+                    catch (const std::exception &)
+                    {
+                        // bad_alloc from the history; reported on the render thread, never rethrown there
+                        prop.reset();
+                    }
+                    return prop;
+                });
+            };
+
+            if (ImGui::Button("Apply to selected + multi-selection") && satCount > 0)
+            {
+                std::vector<uint32_t> objects{(uint32_t)gSelectedSat};
+                for (int id : multiSel)
+                    if (id >= 0 && (size_t)id < satCount)
+                        objects.push_back((uint32_t)id);
+                build(std::move(objects));
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Apply to subset") && subset)
+                build(*subset);
+            ImGui::SameLine();
+            if (ImGui::Button("Revert to SGP4") && numProp)
+                attachNumerical(nullptr);
+
+            if (numPending.valid())
+                ImGui::TextUnformatted("Integrating...");
+            else if (!gNum_Error.empty())
+                ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "%s", gNum_Error.c_str());
+            if (numProp)
+            {
+                ImGui::Text("%d objects | %+.0f .. %+.0f s | %.0f ms", (int)sgp4sys.numericalCount(),
+                            numProp->t0Sec() - gSimTime, numProp->t1Sec() - gSimTime, numProp->lastPropagateMs());
+                if (loaded && (size_t)gSelectedSat < satCount && sgp4sys.usesNumerical((size_t)gSelectedSat))
+                {
+                    glm::dvec3 rn, vn, rs, vs;
+                    if (sgp4sys.sampleStateKm((size_t)gSelectedSat, gSimTime, rn, vn) &&
+                        sgp4sys.sampleSgp4StateKm((size_t)gSelectedSat, gSimTime, rs, vs))
+                        ImGui::Text("Selected: %.3f km from SGP4", glm::length(rn - rs));
+                }
+                if (gSimTime < numProp->t0Sec() || gSimTime > numProp->t1Sec())
+                    ImGui::TextDisabled("(outside the integrated span, showing SGP4)");
+            }
+            else
+            {
+                ImGui::TextDisabled("All objects on SGP4");
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Breakup drill"))
+        {
+            const char *kinds[] = {"Explosion", "Collision (catastrophic)"};
+            int kind = (int)gBrk_Params.kind;
+            if (ImGui::Combo("Event", &kind, kinds, 2))
+                gBrk_Params.kind = (BreakupKind)kind;
+            if (gBrk_Params.kind == BreakupKind::Explosion)
+            {
+                float scale = (float)gBrk_Params.explosionScale;
+                if (ImGui::SliderFloat("Scale S", &scale, 0.1f, 2.0f, "%.2f"))
+                    gBrk_Params.explosionScale = (double)scale;
+            }
+            else
+            {
+                float mass = (float)gBrk_Params.collisionMassKg;
+                if (ImGui::SliderFloat("Colliding mass (kg)", &mass, 10.0f, 10000.0f, "%.0f", ImGuiSliderFlags_Logarithmic))
+                    gBrk_Params.collisionMassKg = (double)mass;
+            }
+            float minCm = (float)(gBrk_Params.minSizeM * 100.0);
+            if (ImGui::SliderFloat("Smallest fragment (cm)", &minCm, 0.5f, 50.0f, "%.1f", ImGuiSliderFlags_Logarithmic))
+                gBrk_Params.minSizeM = (double)minCm / 100.0;
+            int maxFrag = (int)gBrk_Params.maxFragments;
+            if (ImGui::SliderInt("Max fragments", &maxFrag, 100, 100000, "%d", ImGuiSliderFlags_Logarithmic))
+                gBrk_Params.maxFragments = (size_t)maxFrag;
+            ImGui::SliderFloat("Event in (s)", &gBrk_EventInSec, 0.0f, 7200.0f, "%.0f");
+            ImGui::SliderFloat("Horizon (h)##brk", &gBrk_HorizonHrs, 0.5f, 24.0f, "%.1f");
+            ImGui::SliderInt("Zonal degree##brk", &gBrk_Num.zonalDegree, 0, 6, gBrk_Num.zonalDegree < 2 ? "two-body" : "J2..J%d");
+            ImGui::Checkbox("Drag##brk", &gBrk_Num.drag);
+
+            const double predicted = breakupFragmentCount(gBrk_Params);
+            const double made = std::min(predicted, (double)gBrk_Params.maxFragments);
+            const double records = std::ceil((double)gBrk_HorizonHrs * 3600.0 / gBrk_Num.outputSec) + 1.0;
+            ImGui::Text("Model: %.0f fragments%s | ~%.0f MB of trajectory", predicted, made < predicted ? " (capped)" : "",
+                        made * records * 6.0 * sizeof(double) / 1e6);
+
+            if (ImGui::Button("Break up selected") && loaded && (size_t)gSelectedSat < sgp4sys.catalogCount() && !cloudPending.valid())
+            {
+                const size_t parent = (size_t)gSelectedSat;
+                const double tEvent = (double)gSimTime + (double)gBrk_EventInSec;
+                const double tEnd = tEvent + (double)gBrk_HorizonHrs * 3600.0;
+                BreakupParams bp = gBrk_Params;
+                bp.rocketBody = classifyObject(sgp4sys.name(parent)) == ObjectClass::RocketBody;
+                bp.seed = (uint64_t)parent * 0x9E3779B97F4A7C15ull ^ (uint64_t)(int64_t)tEvent;
+                cloudPending = std::async(std::launch::async, [&sgp4sys, parent, tEvent, tEnd, bp, np = gBrk_Num]()
+                {
+                    auto c = std::make_shared<DebrisCloud>();
+                    if (!buildDebrisCloud(sgp4sys, parent, tEvent, tEnd, bp, np, *c))
+                        c.reset();
+                    return std::shared_ptr<const DebrisCloud>(c);
+                });
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Remove fragments") && cloud)
+                attachCloud(nullptr);
+            if (cloudPending.valid())
+                ImGui::TextUnformatted("Generating and propagating...");
+
+            if (cloud)
+            {
+                const NumericalPropagator &prop = *cloud->prop;
+                ImGui::Text("%s %s at %+.0f s: %d fragments (%s A/M)", sgp4sys.name(cloud->parent).c_str(),
+                            cloud->params.kind == BreakupKind::Explosion ? "explosion" : "collision", cloud->eventSec - gSimTime,
+                            (int)prop.count(), cloud->params.rocketBody ? "rocket body" : "spacecraft");
+                ImGui::Text("Propagated to %+.0f s in %.0f ms (+%.0f ms generate) | %.0f MB | re-entered: %d",
+                            prop.t1Sec() - gSimTime, prop.lastPropagateMs(), cloud->generateMs, prop.historyBytes() / 1e6,
+                            (int)prop.decayedCount(gSimTime));
+                if (gSimTime < prop.t0Sec() || gSimTime > prop.t1Sec())
+                    ImGui::TextDisabled("(outside the propagated span, fragments are not drawn)");
+
+                // the largest pieces are the ones worth screening first; the watch list runs them in one pass
+                ImGui::SliderInt("##watchLargest", &gBrk_WatchLargest, 1, 100);
+                ImGui::SameLine();
+                if (ImGui::Button("Watch largest fragments"))
+                {
+                    std::vector<size_t> order(cloud->fragments.size());
+                    for (size_t k = 0; k < order.size(); ++k)
+                        order[k] = k;
+                    const size_t n = std::min(order.size(), (size_t)gBrk_WatchLargest);
+                    std::partial_sort(order.begin(), order.begin() + (std::ptrdiff_t)n, order.end(), [&](size_t a, size_t b)
+                                      { return cloud->fragments[a].sizeM > cloud->fragments[b].sizeM; });
+                    for (size_t k = 0; k < n; ++k)
+                    {
+                        const int id = (int)(cloud->firstIndex + order[k]);
+                        if (std::find(gWatch_Sats.begin(), gWatch_Sats.end(), id) == gWatch_Sats.end())
+                            gWatch_Sats.push_back(id);
+                    }
+                    gWatch_Dirty = true;
+                }
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Inter-satellite links"))
+        {
+            ImGui::Checkbox("Enabled##links", &gLink_On);
+            bool members = ImGui::InputText("Name contains##links", gLink_NameFilter, sizeof(gLink_NameFilter));
+            members |= ImGui::Checkbox("Use the subset instead", &gLink_UseSubset);
+            if (members)
+                linkMembersDirty = true;
+            ImGui::SliderFloat("Max range (km)", &gLink_Params.maxRangeKm, 500.0f, 10000.0f, "%.0f");
+            ImGui::SliderFloat("Grazing altitude (km)", &gLink_Params.grazingAltKm, 0.0f, 500.0f, "%.0f");
+            ImGui::SliderInt("Terminals per sat (0 = all)", &gLink_Params.maxLinksPerSat, 0, 8);
+            ImGui::SliderFloat("Ground mask (deg)", &gLink_Params.groundMaskDeg, 0.0f, 60.0f, "%.0f");
+            ImGui::SliderFloat("Neighbour skin (km)", &gLink_Params.skinKm, 0.0f, 2000.0f, "%.0f");
+            ImGui::SliderFloat("Step (s)##links", &gLink_StepSec, 1.0f, 120.0f, "%.0f");
+            ImGui::Checkbox("Draw links", &gLink_ShowLines);
+            ImGui::SameLine();
+            ImGui::SliderFloat("Alpha##links", &gLink_Alpha, 0.05f, 1.0f, "%.2f");
+            ImGui::Text("Ground: %s (%.2f, %.2f), set under Visible passes", gVis_Station.name.c_str(), gVis_Station.latDeg, gVis_Station.lonDeg);
+
+            if (linkGraph.valid())
+            {
+                ImGui::Text("%d sats | %d links (+%d -%d) | %d in view of the ground", (int)linkGraph.members().size(),
+                            (int)linkGraph.links().size(), (int)linkGraph.linksAdded(), (int)linkGraph.linksRemoved(),
+                            (int)linkGraph.groundLinks().size());
+                ImGui::Text("Components: %d (largest %d) | routed to ground: %d", (int)linkGraph.componentCount(),
+                            (int)linkGraph.largestComponent(), (int)linkGraph.reachableCount());
+                ImGui::Text("%.2f ms | %d candidate pairs | neighbour rebuilds: %d", linkGraph.lastUpdateMs(),
+                            (int)linkGraph.candidatePairs(), (int)linkGraph.neighbourRebuilds());
+
+                const int slot = linkGraph.slotOf((uint32_t)gSelectedSat);
+                std::vector<uint32_t> route;
+                float routeKm = 0.0f;
+                if (slot < 0)
+                    ImGui::TextDisabled("Selected satellite is not in the constellation");
+                else if (linkGraph.pathToGround((size_t)slot, route, &routeKm))
+                    ImGui::Text("Selected -> ground: %d hops, %.0f km, %.1f ms light time", (int)route.size(), routeKm,
+                                routeKm / 299792.458f * 1000.0f);
+                else
+                    ImGui::TextDisabled("Selected satellite has no route to the ground");
+
+                ImGui::InputText("CSV##links", gLink_CsvPath, sizeof(gLink_CsvPath));
+                if (ImGui::Button("Export this step") && !linkGraph.exportCsv(gLink_CsvPath, sgp4sys, gVis_Station.name, false))
+                    std::cerr << "Failed to write " << gLink_CsvPath << "\n";
+                ImGui::SameLine();
+                ImGui::Checkbox("Append every step", &gLink_Record);
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Eclipse timeline"))
+        {
+            ImGui::Checkbox("Use eclipse table for brightness", &gEcl_UseTable);
+            bool changed = false;
+            changed |= ImGui::SliderFloat("Eclipse horizon (hours)", &gEcl_HorizonHrs, 1.0f, 48.0f, "%.1f");
+            changed |= ImGui::SliderFloat("Eclipse step (sec)", &gEcl_StepSec, 10.0f, 300.0f, "%.0f");
+            if (changed || ImGui::Button("Rebuild eclipse table"))
+                eclTable.clear();
+
+            ImGui::Text("Window: %.0f .. %.0f s | events: %d%s",
+                        eclTable.t0Sec(), eclTable.t1Sec(), (int)eclTable.eventCount(),
+                        eclPending.valid() ? " | building..." : "");
+
+            if (ImGui::Button("Export eclipse CSV") && eclTable.objectCount() > 0)
+            {
+                const std::string path = "eclipse_events.csv";
+                if (!eclTable.exportCsv(path, sgp4sys))
+                    std::cerr << "Failed to write " << path << "\n";
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Coverage (lat/lon grid)"))
+        {
+            ImGui::InputText("Name contains", gCov_NameFilter, sizeof(gCov_NameFilter));
+
+            float latStep = (float)gCov_Params.latStepDeg;
+            float lonStep = (float)gCov_Params.lonStepDeg;
+            float hours = (float)(gCov_Params.durationSec / 3600.0);
+            float step = (float)gCov_Params.stepSec;
+            float minEl = (float)gCov_Params.minElDeg;
+            ImGui::SliderFloat("Cell lat (deg)", &latStep, 0.5f, 10.0f, "%.1f");
+            ImGui::SliderFloat("Cell lon (deg)", &lonStep, 0.5f, 10.0f, "%.1f");
+            ImGui::SliderFloat("Duration (hours)", &hours, 1.0f, 48.0f, "%.1f");
+            ImGui::SliderFloat("Sample step (sec)", &step, 10.0f, 600.0f, "%.0f");
+            ImGui::SliderFloat("Min elevation (deg)", &minEl, 0.0f, 60.0f, "%.1f");
+            gCov_Params.latStepDeg = latStep;
+            gCov_Params.lonStepDeg = lonStep;
+            gCov_Params.durationSec = (double)hours * 3600.0;
+            gCov_Params.stepSec = step;
+            gCov_Params.minElDeg = minEl;
+
+            if (ImGui::Button("Compute coverage") && loaded && satCount > 0 && !covPending.valid())
+            {
+                std::vector<size_t> subset;
+                for (size_t i = 0; i < satCount; ++i)
+                    if (containsNoCase(sgp4sys.name(i), gCov_NameFilter))
+                        subset.push_back(i);
+
+                covPending = std::async(std::launch::async, [&sgp4sys, subset = std::move(subset), startUtcTP,
+                                                             t0 = (double)gSimTime, p = gCov_Params]()
+                {
+                    CoverageGrid g;
+                    computeCoverage(sgp4sys, subset, startUtcTP, t0, p, g);
+                    return g;
+                });
+            }
             ImGui::SameLine();
-            ImGui::Text("Last run: %.1f ms | hits: %d", gSSA_LastRunMs, (int)gSSA_Hits.size());
+            if (covPending.valid())
+                ImGui::TextUnformatted("Computing...");
+            else
+                ImGui::Text("%.0f ms | sats: %d", gCov_Grid.ms, gCov_Grid.satCount);
+
+            if (!gCov_Grid.pctCovered.empty())
+            {
+                double pct = 0.0, w = 0.0;
+                float worstGap = 0.0f;
+                for (int r = 0; r < gCov_Grid.nLat; ++r)
+                {
+                    const double cw = std::cos(glm::radians(gCov_Grid.cellLatDeg(r)));
+                    for (int c = 0; c < gCov_Grid.nLon; ++c)
+                    {
+                        const size_t i = (size_t)r * (size_t)gCov_Grid.nLon + (size_t)c;
+                        pct += cw * gCov_Grid.pctCovered[i];
+                        w += cw;
+                        worstGap = std::max(worstGap, gCov_Grid.maxGapSec[i]);
+                    }
+                }
+                ImGui::Text("Area-weighted coverage: %.1f %% | worst gap: %.0f min", w > 0.0 ? pct / w : 0.0, worstGap / 60.0f);
+
+                if (ImGui::Button("Export CSV##cov") && !gCov_Grid.exportCsv("coverage.csv"))
+                    std::cerr << "Failed to write coverage.csv\n";
+                ImGui::SameLine();
+                if (ImGui::Button("Export raster##cov") && !gCov_Grid.exportRaster("coverage.covg"))
+                    std::cerr << "Failed to write coverage.covg\n";
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Visible passes (optical)"))
+        {
+            float lat = (float)gVis_Station.latDeg;
+            float lon = (float)gVis_Station.lonDeg;
+            float mask = (float)gVis_Station.maskDeg;
+            ImGui::SliderFloat("Station lat (deg)", &lat, -90.0f, 90.0f, "%.3f");
+            ImGui::SliderFloat("Station lon (deg)", &lon, -180.0f, 180.0f, "%.3f");
+            ImGui::SliderFloat("Mask (deg)", &mask, 0.0f, 45.0f, "%.1f");
+            gVis_Station.latDeg = lat;
+            gVis_Station.lonDeg = lon;
+            gVis_Station.maskDeg = mask;
+
+            ImGui::SliderFloat("Station sun below (deg)", &gVis_SunMaxElDeg, -18.0f, 0.0f, "%.1f");
+            ImGui::SliderFloat("Pass horizon (hours)", &gVis_HorizonHrs, 1.0f, 72.0f, "%.1f");
+            ImGui::SliderFloat("Pass step (sec)", &gVis_StepSec, 5.0f, 120.0f, "%.0f");
+
+            if (ImGui::Button("Predict visible passes (catalog)") && loaded && satCount > 0 && !visPending.valid())
+            {
+                const double t0 = (double)gSimTime;
+                const double horizon = (double)gVis_HorizonHrs * 3600.0;
+                Ephemeris eph = ephem;
+                eph.ensureCovers(t0, t0 + horizon);
+
+                visPending = std::async(std::launch::async, [&sgp4sys, eph = std::move(eph), t0, horizon, step = (double)gVis_StepSec,
+                                                             st = gVis_Station, sunMax = (double)gVis_SunMaxElDeg]()
+                {
+                    std::pair<std::vector<VisiblePass>, float> r;
+                    auto c0 = std::chrono::high_resolution_clock::now();
+                    PassPredictor().predictVisibleCatalog(sgp4sys, eph, (float)EARTH_RADIUS_KM, t0, horizon, step, st, sunMax, r.first);
+                    auto c1 = std::chrono::high_resolution_clock::now();
+                    r.second = (float)std::chrono::duration<double, std::milli>(c1 - c0).count();
+                    return r;
+                });
+            }
+            ImGui::SameLine();
+            if (visPending.valid())
+                ImGui::TextUnformatted("Predicting...");
+            else
+                ImGui::Text("%.1f ms | windows: %d", gVis_LastRunMs, (int)gVis_Passes.size());
+
+            const int shown = std::min(50, (int)gVis_Passes.size());
+            for (int i = 0; i < shown; ++i)
+            {
+                const VisiblePass &vp = gVis_Passes[(size_t)i];
+                if (vp.satIndex < 0 || (size_t)vp.satIndex >= satCount)
+                    continue;
+
+                char label[160];
+                std::snprintf(label, sizeof(label), "%s  +%.0fs..%.0fs  max %.0f deg%s##vis%d",
+                              sgp4sys.name((size_t)vp.satIndex).c_str(),
+                              vp.startSec - gSimTime, vp.endSec - gSimTime, vp.maxElDeg,
+                              vp.umbraEntrySec >= 0.0 ? "  (enters umbra)" : "", i);
+                if (ImGui::Selectable(label, vp.satIndex == gSelectedSat) && vp.satIndex != gSelectedSat)
+                {
+                    gSelectedSat = vp.satIndex;
+                    clearSSA(conjLine, conjPts);
+                }
+            }
+        }
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Sensor tasking (field of view)"))
+        {
+            // presets start at the pass station; each sensor is edited on its own afterwards
+            const bool addRadar = ImGui::Button("Add radar");
+            ImGui::SameLine();
+            const bool addScope = ImGui::Button("Add telescope");
+            if (addRadar || addScope)
+            {
+                Sensor sn;
+                sn.site = gVis_Station;
+                sn.site.name = std::string(addRadar ? "Radar " : "Telescope ") + std::to_string(gSen_Sensors.size() + 1);
+                if (addRadar)
+                {
+                    sn.shape = FovShape::Pyramid;
+                    sn.boresightAzDeg = 180.0;
+                    sn.boresightElDeg = 45.0;
+                    sn.halfWidthDeg = 60.0;
+                    sn.halfHeightDeg = 40.0;
+                    sn.site.maskDeg = 3.0;
+                    sn.minRangeKm = 100.0;
+                    sn.maxRangeKm = 3000.0;
+                }
+                else
+                {
+                    sn.halfAngleDeg = 70.0;
+                    sn.site.maskDeg = 20.0;
+                }
+                gSen_Sensors.push_back(sn);
+            }
+
+            int removed = -1;
+            for (size_t k = 0; k < gSen_Sensors.size(); ++k)
+            {
+                Sensor &sn = gSen_Sensors[k];
+                ImGui::PushID((int)k);
+                if (ImGui::TreeNode("##sensor", "%s (%s)", sn.site.name.c_str(), sn.shape == FovShape::Cone ? "cone" : "pyramid"))
+                {
+                    float lat = (float)sn.site.latDeg;
+                    float lon = (float)sn.site.lonDeg;
+                    float alt = (float)sn.site.altKm;
+                    float mask = (float)sn.site.maskDeg;
+                    ImGui::SliderFloat("Lat (deg)", &lat, -90.0f, 90.0f, "%.3f");
+                    ImGui::SliderFloat("Lon (deg)", &lon, -180.0f, 180.0f, "%.3f");
+                    ImGui::SliderFloat("Alt (km)", &alt, 0.0f, 5.0f, "%.2f");
+                    ImGui::SliderFloat("Horizon mask (deg)", &mask, 0.0f, 45.0f, "%.1f");
+                    sn.site.latDeg = lat;
+                    sn.site.lonDeg = lon;
+                    sn.site.altKm = alt;
+                    sn.site.maskDeg = mask;
+
+                    int shape = (int)sn.shape;
+                    const char *shapes[] = {"Cone", "Pyramid"};
+                    ImGui::Combo("Field of view", &shape, shapes, 2);
+                    sn.shape = (FovShape)shape;
+
+                    float az = (float)sn.boresightAzDeg;
+                    float el = (float)sn.boresightElDeg;
+                    ImGui::SliderFloat("Boresight az (deg)", &az, 0.0f, 360.0f, "%.1f");
+                    ImGui::SliderFloat("Boresight el (deg)", &el, 0.0f, 90.0f, "%.1f");
+                    sn.boresightAzDeg = az;
+                    sn.boresightElDeg = el;
+                    if (sn.shape == FovShape::Cone)
+                    {
+                        float half = (float)sn.halfAngleDeg;
+                        ImGui::SliderFloat("Half angle (deg)", &half, 0.1f, 90.0f, "%.1f");
+                        sn.halfAngleDeg = half;
+                    }
+                    else
+                    {
+                        float hw = (float)sn.halfWidthDeg;
+                        float hh = (float)sn.halfHeightDeg;
+                        ImGui::SliderFloat("Half width (deg)", &hw, 0.1f, 85.0f, "%.1f");
+                        ImGui::SliderFloat("Half height (deg)", &hh, 0.1f, 85.0f, "%.1f");
+                        sn.halfWidthDeg = hw;
+                        sn.halfHeightDeg = hh;
+                    }
+
+                    float azRange[2] = {(float)sn.minAzDeg, (float)sn.maxAzDeg};
+                    ImGui::SliderFloat2("Azimuth from/to (deg)", azRange, 0.0f, 360.0f, "%.0f");
+                    sn.minAzDeg = azRange[0];
+                    sn.maxAzDeg = azRange[1] > azRange[0] ? azRange[1] : azRange[1] + 360.0f;
+                    float rangeKm[2] = {(float)sn.minRangeKm, (float)sn.maxRangeKm};
+                    ImGui::DragFloat2("Range min/max (km)", rangeKm, 10.0f, 0.0f, 100000.0f, "%.0f");
+                    sn.minRangeKm = rangeKm[0];
+                    sn.maxRangeKm = std::max(rangeKm[0], rangeKm[1]);
+
+                    if (ImGui::Button("Remove"))
+                        removed = (int)k;
+                    ImGui::TreePop();
+                }
+                ImGui::PopID();
+            }
+            if (removed >= 0 && !senPending.valid())
+            {
+                // windows are stored per sensor slot
+                gSen_Sensors.erase(gSen_Sensors.begin() + removed);
+                senResult = SensorAccessResult();
+            }
+
+            float hours = (float)(gSen_Params.durationSec / 3600.0);
+            float step = (float)gSen_Params.stepSec;
+            ImGui::SliderFloat("Horizon (hours)##sen", &hours, 0.5f, 72.0f, "%.1f");
+            ImGui::SliderFloat("Step (sec)##sen", &step, 5.0f, 120.0f, "%.0f");
+            gSen_Params.durationSec = (double)hours * 3600.0;
+            gSen_Params.stepSec = step;
+            ImGui::Checkbox("Prune by orbit geometry", &gSen_Params.geometryPrune);
+            ImGui::Checkbox("Only the subset##sen", &gSen_UseSubset);
+
+            if (ImGui::Button("Compute access windows") && loaded && satCount > 0 && !gSen_Sensors.empty() && !senPending.valid())
+            {
+                std::shared_ptr<const std::vector<uint32_t>> only = gSen_UseSubset ? subset : nullptr;
+                senPending = std::async(std::launch::async, [&sgp4sys, &elIndex, sensors = gSen_Sensors, only, startUtcTP,
+                                                             t0 = (double)gSimTime, p = gSen_Params]()
+                {
+                    SensorAccessResult r;
+                    computeSensorAccess(sgp4sys, sensors, only.get(), &elIndex, startUtcTP, t0, p, r);
+                    return r;
+                });
+            }
+            ImGui::SameLine();
+            if (senPending.valid())
+                ImGui::TextUnformatted("Searching...");
+            else
+                ImGui::Text("%.0f ms | objects: %d (%d pruned) | samples: %d", senResult.ms, (int)senResult.objects,
+                            (int)senResult.pruned, (int)senResult.samples);
+
+            if (!senResult.windows.empty() && senResult.windows.size() <= gSen_Sensors.size())
+            {
+                gSen_Listed = std::clamp(gSen_Listed, 0, (int)senResult.windows.size() - 1);
+                for (size_t k = 0; k < senResult.windows.size(); ++k)
+                {
+                    char label[96];
+                    std::snprintf(label, sizeof(label), "%s: %d##senList%d", gSen_Sensors[k].site.name.c_str(),
+                                  (int)senResult.windows[k].size(), (int)k);
+                    if (k > 0)
+                        ImGui::SameLine();
+                    if (ImGui::RadioButton(label, gSen_Listed == (int)k))
+                        gSen_Listed = (int)k;
+                }
+
+                const std::vector<AccessWindow> &wins = senResult.windows[(size_t)gSen_Listed];
+                const int shown = std::min(50, (int)wins.size());
+                for (int i = 0; i < shown; ++i)
+                {
+                    const AccessWindow &w = wins[(size_t)i];
+                    if ((size_t)w.object >= satCount)
+                        continue;
+
+                    char label[160];
+                    std::snprintf(label, sizeof(label), "%s  +%.0fs..%.0fs  max %.0f deg  %.0f km##sen%d",
+                                  sgp4sys.name(w.object).c_str(), w.startSec - gSimTime, w.endSec - gSimTime,
+                                  w.maxElDeg, w.minRangeKm, i);
+                    if (ImGui::Selectable(label, (int)w.object == gSelectedSat) && (int)w.object != gSelectedSat)
+                    {
+                        gSelectedSat = (int)w.object;
+                        clearSSA(conjLine, conjPts);
+                    }
+                }
+
+                ImGui::InputText("CSV##sen", gSen_CsvPath, sizeof(gSen_CsvPath));
+                ImGui::SameLine();
+                if (ImGui::Button("Export##sen") && !senResult.exportCsv(gSen_CsvPath, sgp4sys, gSen_Sensors))
+                    std::cerr << "Failed to write " << gSen_CsvPath << "\n";
+            }
         }
 
         ImGui::Separator();
         ImGui::Text("TAB mouse capture | N/P cycle | SPACE pause");
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
+        ImGui::Checkbox("Profiler", &showProfiler);
         ImGui::End();
 
+        if (showProfiler)
+            prof.drawUi(&showProfiler);
+        prof.end(stUi);
+
         // ssa conjuction line adjust this is tmp for now
         if (gSSA_ShowConjLine &&
             loaded && satCount > 0 &&
@@ -953,22 +2849,34 @@ int main()
             conjLine.update(conjPts);
         }
 
+        if (capOpt.headless)
+            capture.bindTarget();
+
         glClearColor(0.005f, 0.007f, 0.015f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        {
+            FrameUniforms fu{};
+            fu.view = view;
+            fu.proj = proj;
+            fu.sunDir = sunDir;
+            fu.time = gSimTime;
+            fu.camPos = gCam.pos;
+            glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &fu);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+
         glm::mat4 earthM = glm::mat4(1.0f);
         if (useRealSun && rotateEarthGMST)
             earthM = glm::rotate(glm::mat4(1.0f), theta, glm::vec3(0, 1, 0));
         earthM = earthM * glm::scale(glm::mat4(1.0f), glm::vec3(earthScale));
 
+        prof.begin(stGltf);
         if (hasEarthGltf)
         {
             earthSh.use();
             earthSh.setMat4("uModel", earthM);
-            earthSh.setMat4("uView", view);
-            earthSh.setMat4("uProj", proj);
-            earthSh.setVec3("uSunDir", sunDir);
-            earthSh.setVec3("uCamPos", gCam.pos);
             earthGltf.drawEarthStyle(earthSh, 0);
         }
 
@@ -980,10 +2888,6 @@ int main()
 
             earthSh.use();
             earthSh.setMat4("uModel", moonM);
-            earthSh.setMat4("uView", view);
-            earthSh.setMat4("uProj", proj);
-            earthSh.setVec3("uSunDir", sunDir);
-            earthSh.setVec3("uCamPos", gCam.pos);
             moonGltf.drawEarthStyle(earthSh, 0);
         }
 
@@ -1001,10 +2905,6 @@ int main()
 
             sunSh.use();
             sunSh.setMat4("uModel", sunM);
-            sunSh.setMat4("uView", view);
-            sunSh.setMat4("uProj", proj);
-            sunSh.setVec3("uCamPos", gCam.pos);
-            sunSh.setFloat("uTime", gSimTime);
 
             // adjust bc it yellow later
             sunSh.setVec3("uBaseColor", glm::vec3(1.0f, 0.65f, 0.20f));
@@ -1016,12 +2916,24 @@ int main()
             glDepthMask(GL_TRUE);
         }
 
+        prof.end(stGltf);
+
         glDepthMask(GL_FALSE);
+
+        prof.begin(stLines);
+        if (showOrbitBatch && orbitBatch.orbitCount() > 0)
+        {
+            glLineWidth(1.0f);
+            glDepthFunc(GL_LESS);
+            orbitBatchSh.use();
+            orbitBatchSh.setFloat("uAlpha", orbitBatchAlpha);
+            orbitBatch.draw(orbitBatchSh, gSimTime);
+        }
+
         glLineWidth(2.0f);
 
         orbitSh.use();
-        orbitSh.setMat4("uView", view);
-        orbitSh.setMat4("uProj", proj);
+        orbitSh.setMat4("uModel", glm::mat4(1.0f));
 
         glDepthFunc(GL_LESS);
         orbitSh.setFloat("uAlpha", 0.75f);
@@ -1037,6 +2949,8 @@ int main()
 
         if (showGroundTrack)
         {
+            // track vertices are Earth-fixed
+            orbitSh.setMat4("uModel", glm::rotate(glm::mat4(1.0f), theta, glm::vec3(0, 1, 0)));
             orbitSh.setFloat("uAlpha", 0.90f);
             groundLine.draw();
 
@@ -1047,6 +2961,7 @@ int main()
                 groundLine.draw();
                 glDepthFunc(GL_LESS);
             }
+            orbitSh.setMat4("uModel", glm::mat4(1.0f));
         }
 
         if (showNadirLine)
@@ -1063,6 +2978,18 @@ int main()
             moonOrbitLine.draw();
         }
 
+        if (gLink_On && gLink_ShowLines)
+        {
+            glDepthFunc(GL_LESS);
+            orbitSh.setFloat("uAlpha", gLink_Alpha);
+            linkLine.draw();
+            if (!linkPathPts.empty())
+            {
+                orbitSh.setFloat("uAlpha", 1.0f);
+                linkPathLine.draw();
+            }
+        }
+
         if (gSSA_ShowConjLine && !conjPts.empty() && gSSA_HitsForSat == gSelectedSat)
         {
             glDepthFunc(GL_LESS);
@@ -1071,38 +2998,71 @@ int main()
         }
 
         glDepthFunc(GL_LESS);
+        prof.end(stLines);
 
+        prof.begin(stSats);
         if (loaded && satCount > 0)
         {
-            const GLsizei drawN = (GLsizei)std::clamp(drawLimit, 0, (int)satCount);
-
             satSh.use();
-            satSh.setMat4("uView", view);
-            satSh.setMat4("uProj", proj);
 
             satSh.setInt("uIsHighlight", 0);
             satSh.setFloat("uBaseSize", basePointSize);
             satSh.setFloat("uHighlightSize", highlightPointSize);
 
             glBindVertexArray(satVAO);
-            glDrawArrays(GL_POINTS, 0, drawN);
+            glDrawArrays(GL_POINTS, 0, satDrawCount);
             glBindVertexArray(0);
 
             satSh.setInt("uIsHighlight", 1);
             glBindVertexArray(hiVAO);
             glDrawArrays(GL_POINTS, 0, 1);
+            if (hiData.size() > 1)
+            {
+                satSh.setFloat("uHighlightSize", highlightPointSize * 0.5f);
+                glDrawArrays(GL_POINTS, 1, (GLsizei)(hiData.size() - 1));
+            }
             glBindVertexArray(0);
         }
 
+        prof.end(stSats);
+
         glDepthMask(GL_TRUE);
 
+        prof.begin(stImGui);
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        if (!capOpt.headless || capOpt.withUi)
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        prof.end(stImGui);
+
+        prof.begin(stPresent);
 
-        glfwSwapBuffers(window);
+        if (capOpt.headless)
+        {
+            capture.capture();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            if (++capturedFrames >= capOpt.frames)
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        else
+        {
+            glfwSwapBuffers(window);
+        }
+        prof.end(stPresent);
+        prof.endFrame();
         glfwPollEvents();
     }
 
+    if (capOpt.headless && exitCode == 0)
+    {
+        capture.finish();
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - captureStart).count();
+        std::cout << "Wrote " << capture.framesWritten() << " frames in " << wall << " s ("
+                  << (wall > 0.0 ? capture.framesWritten() / wall : 0.0) << " fps)\n";
+    }
+    capture.destroy();
+    prof.destroy();
+    simThread.stop();
+
     earthGltf.destroy();
     moonGltf.destroy();
     sunGltf.destroy();
@@ -1113,12 +3073,16 @@ int main()
     glDeleteBuffers(1, &hiVBO);
     glDeleteVertexArrays(1, &hiVAO);
 
+    glDeleteBuffers(1, &elVBO);
+    glDeleteBuffers(1, &frameUBO);
+    glDeleteVertexArrays(1, &propVAO);
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     glfwDestroyWindow(window);
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
 